@@ -14,7 +14,6 @@
 #include <doca_mmap.h>
 #include <doca_pe.h>
 
-#include "doca_consumer.hpp"
 #include "simple_barrier.hpp"
 #include "zpipe.hpp"
 #include "lz4_pipe.hpp"
@@ -1,5 +1,7 @@
 #include <chrono>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
 #include <fstream>
 #include <string>
 #include <sys/syscall.h>
@@ -16,50 +18,42 @@
 #include <doca_mmap.h>
 #include <doca_pe.h>
 
-#include "doca_consumer.hpp"
+#include "adaptive_codec.hpp"
+#include "cpu_codec_engine.hpp"
+#include "cpu_codec_worker.hpp"
+#include "cpu_dispatch.hpp"
+#include "libdeflate_pipe.hpp"
 #include "simple_barrier.hpp"
 #include "zpipe.hpp"
+#include "zstd_pipe.hpp"
 #include "doca_compress.hpp"
+#include "doca_coro_engine.hpp"
+#include "offload_consumer.hpp"
+#include "offload_router.hpp"
+#include "param_sweep.hpp"
+#include "trial_stats.hpp"
 
 #include <nlohmann/json.hpp>
 
-void pin_and_expose(const char* name, int core) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(core, &mask);
-    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+// Result keys of the offloaded share, in the order of their values
+const std::vector<std::string> DOCA_RESULT_KEYS = {"overall_submission_elapsed", "task_submission_elapsed",
+												   "busy_wait_elapsed", "cb_elapsed", "cb_end_elapsed", 
+												   "ctx_stop_elapsed", "cpu_time_elapsed", 
+												   "joined_submission_elapsed", "worker_cpu_time_elapsed",
+												   RETRY_COUNTER_KEYS, CHECKSUM_KEYS, INIT_TIMING_KEYS};
 
-    pid_t tid = syscall(SYS_gettid);
-    printf("%s TID=%d (core %d)\n", name, tid, core);
-    fflush(stdout);
-}
-
-double thread_cpu_seconds() {
-    timespec ts;
-    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
-    return ts.tv_sec + ts.tv_nsec * 1e-9;
-}
-
-std::string calculateSeconds(const std::chrono::steady_clock::time_point end,
-											   const std::chrono::steady_clock::time_point start) {
-	auto elapsed = end - start;
-	auto seconds = std::chrono::duration<double>(elapsed).count();
-	// Convert the float to a string with fixed formatting and desired precision
-	std::ostringstream oss;
-	oss << std::fixed << std::setprecision(8) << seconds;
-	std::string formattedValue = oss.str();
-	return formattedValue;
-}
-
-void docaWriteJson(const std::vector<std::string> times, const std::string filename) {
+void docaWriteJson(const std::vector<std::string> times, const std::string filename,
+				   const TrialRecorder& trials = TrialRecorder()) {
 	nlohmann::json j;
-	std::vector<std::string> keys = {"overall_submission_elapsed", "task_submission_elapsed",
-									 "busy_wait_elapsed", "cb_elapsed", "cb_end_elapsed", 
-									 "ctx_stop_elapsed", "cpu_time_elapsed", 
-									 "joined_submission_elapsed"};
+	const std::vector<std::string>& keys = DOCA_RESULT_KEYS;
 	for (uint16_t idx = 0; idx < times.size(); ++idx) {
 		j[keys[idx]] = times[idx];
 	}
+	// summaries of the repeated trials, if any
+	auto summary = trials.toJson(keys);
+	if (!summary.is_null()) {
+		j["trials"] = summary;
+	}
 
 	// Pretty print the JSON with an indent of 4 spaces
     std::string prettyJson = j.dump(4);
@@ -71,42 +65,284 @@ void docaWriteJson(const std::vector<std::string> times, const std::string filen
     }
 }
 
-void cpuWriteJson(const std::vector<std::string> times, const std::string filename) {
-	nlohmann::json j;
-	std::vector<std::string> keys = {"overall_submission_elapsed", "cpu_time_elapsed",
-									 "joined_submission_elapsed"};
-	for (uint16_t idx = 0; idx < times.size(); ++idx) {
-		j[keys[idx]] = times[idx];
+void doca_compress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, OffloadOptions offload,
+						  TrialOptions trials) {
+	// pin thread to specific core
+	pin_and_expose("DPU", 4);  // pick any isolated core
+
+	// DOCA init, or the software executor without a device
+	runOffloadConsumer<CompressConsumer, SwCompressConsumer>(offload, [&](auto& consumer_compress_deflate) {
+		TrialRecorder recorder(trials);
+		size_t trial = 0;
+		auto result_times = runTrials(trials, recorder, [&] {
+			// tasks of the previous trial were freed (not measured)
+			consumer_compress_deflate.rearm();
+			// the context stays up for the next trial
+			consumer_compress_deflate.keepAlive(++trial < trials.runs());
+
+			// wait for sync
+			start_barrier.arrive_and_wait();
+
+			// log processing state
+			std::cout << "DOCA Compress start processing..." << std::endl;
+
+			// entered processing
+			auto processing_start = std::chrono::steady_clock::now();
+
+			// execute task
+			consumer_compress_deflate.executeDocaTask();
+
+			// wait for sync
+			end_barrier.arrive_and_wait();
+
+			// both HW finished processing
+			auto processing_end = std::chrono::steady_clock::now();
+			return offloadResults(consumer_compress_deflate, calculateSeconds(processing_end, processing_start));
+		});
+
+		// log writing state
+		std::cout << "DOCA Compress results..." << std::endl;
+
+		// write results and output
+		auto name = "results-" + consumer_compress_deflate.getName() + ".json";
+		docaWriteJson(result_times, name, recorder);
+		printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
+	}, CompressConsumer::DEVICE_TYPE::BF2, 1);
+}
+
+// Short-lived jobs, DPU side: the pool opens its contexts once, before the
+// first run, and each run is a job that borrows one, loads the input into
+// its registered buffers and compresses it (the load is measured, the
+// device open, mmap registration and ctx start are not). Without a device
+// it runs as doca_compress_worker, a job that finds no idle context or does
+// not fit in one opens its own.
+void doca_pool_compress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, OffloadOptions offload,
+							   TrialOptions trials, size_t contexts) {
+	// the input of the jobs, as the consumer would read it
+	std::ifstream inFile(CompressDeflateTask::input_path, std::ios::binary);
+	std::vector<uint8_t> input((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+	CompressPool pool(offload.force_sw || input.empty() ? 0 : contexts, input.size(),
+					  CompressConsumer::DEVICE_TYPE::BF2, 1);
+	if (pool.size() == 0) {
+		std::cerr << "No warm DOCA context, running without the pool" << std::endl;
+		doca_compress_worker(start_barrier, end_barrier, offload, trials);
+		return;
 	}
+	std::cout << "DOCA pool: " << pool.size() << " contexts warm in " << pool.warmSeconds() << " s" << std::endl;
 
-	// Pretty print the JSON with an indent of 4 spaces
-    std::string prettyJson = j.dump(4);
+	// pin thread to specific core
+	pin_and_expose("DPU", 4);  // pick any isolated core
 
-	// Optionally, write the pretty printed JSON to a file
-    std::ofstream outFile(filename);
-    if (outFile) {
-        outFile << prettyJson;
-    }
+	TrialRecorder recorder(trials);
+	std::string name;
+	auto result_times = runTrials(trials, recorder, [&] {
+		// wait for sync
+		start_barrier.arrive_and_wait();
+
+		// log processing state
+		std::cout << "DOCA Compress job start processing..." << std::endl;
+
+		// entered processing
+		auto processing_start = std::chrono::steady_clock::now();
+
+		// execute task, then wait for sync
+		auto run_job = [&](auto& job) {
+			job.executeDocaTask();
+			end_barrier.arrive_and_wait();
+
+			// both HW finished processing
+			auto processing_end = std::chrono::steady_clock::now();
+			name = job.getName();
+			return offloadResults(job, calculateSeconds(processing_end, processing_start));
+		};
+
+		// borrow a context and load the job into it
+		auto consumer = pool.acquire();
+		if (!consumer) {
+			std::cerr << "No idle DOCA context, the job opens its own" << std::endl;
+		} else if (!consumer->load(input.data(), input.size())) {
+			std::cerr << "DOCA Compress job could not be loaded, the job opens its own context" << std::endl;
+			consumer.release();
+		}
+		if (consumer) {
+			consumer->setRetryPolicy(offload.retry);
+			consumer->setBypass(offload.bypass);
+			consumer->setVerify(offload.verify);
+			return run_job(*consumer);
+		}
+
+		// cold job, as without the pool (init measured)
+		std::vector<std::string> results;
+		runOffloadConsumer<CompressConsumer, SwCompressConsumer>(offload, [&](auto& job) {
+			results = run_job(job);
+		}, CompressConsumer::DEVICE_TYPE::BF2, 1);
+		return results;
+	});
+
+	// log writing state
+	std::cout << "DOCA Compress results..." << std::endl;
+
+	// write results and output
+	docaWriteJson(result_times, "results-" + name + ".json", recorder);
+	printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
+}
+
+// Plaintext per request of the coroutine front-end, below the BF3 task limit
+static const size_t CORO_REQUEST_SIZE = 1 << 20;
+// Output slot per request: the deflate bound, an incompressible request still fits
+static const size_t CORO_OUTPUT_SLOT = compressBound(CORO_REQUEST_SIZE);
+
+using CompressCoroEngine = DocaCoroEngine<CompressDeflateTraits>;
+
+// One request: compress a slice of the registered input into its output slot
+DocaCoroutine compress_request(CompressCoroEngine& engine, size_t request, size_t input_size,
+							   std::vector<size_t>& compressed_sizes) {
+	size_t offset = request * CORO_REQUEST_SIZE;
+	size_t size = std::min(CORO_REQUEST_SIZE, input_size - offset);
+	auto result = co_await engine.compress(engine.input().subspan(offset, size),
+										   engine.output().subspan(request * CORO_OUTPUT_SLOT, CORO_OUTPUT_SLOT));
+	if (result.status != DOCA_SUCCESS) {
+		std::cerr << "Request " << request << " failed: " << doca_error_get_descr(result.status) << std::endl;
+		co_return;
+	}
+	compressed_sizes[request] = result.size;
 }
 
-void doca_compress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier) {
+// DPU side through the coroutine front-end: one coroutine per request, in_flight tasks on the device
+void doca_coro_compress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, uint32_t in_flight) {
 	// pin thread to specific core
 	pin_and_expose("DPU", 4);  // pick any isolated core
 
-	// DOCA init
-	auto consumer_compress_deflate = CompressConsumer(CompressConsumer::DEVICE_TYPE::BF2, 1, true);
+	// DOCA init: register the whole input once (not measured)
+	std::ifstream input_file(CompressDeflateTraits::input_path, std::ios::binary | std::ios::ate);
+	size_t input_size = input_file.is_open() ? static_cast<size_t>(input_file.tellg()) : 0;
+	size_t num_requests = (input_size + CORO_REQUEST_SIZE - 1) / CORO_REQUEST_SIZE;
+	CompressCoroEngine engine(CompressCoroEngine::DEVICE_TYPE::BF2, std::max<size_t>(input_size, 1),
+							  std::max<size_t>(num_requests, 1) * CORO_OUTPUT_SLOT, in_flight);
+	if (input_size > 0 && engine.ready()) {
+		input_file.seekg(0);
+		input_file.read(reinterpret_cast<char*>(engine.input().data()), input_size);
+	} else {
+		std::cerr << "DOCA coroutine compress could not be set up, no requests" << std::endl;
+		num_requests = 0;
+	}
+	std::vector<size_t> compressed_sizes(num_requests, 0);
 
 	// wait for sync
 	start_barrier.arrive_and_wait();
 
-	// log processing state
-	std::cout << "DOCA Compress start processing..." << std::endl;
+	std::cout << "DOCA Compress (coroutines) start processing..." << std::endl;
+	double cpu_time_start = thread_cpu_seconds();
+	auto processing_start = std::chrono::steady_clock::now();
 
-	// entered processing
+	// spawn every request, then tick the progress engine until all returned
+	for (size_t request = 0; request < num_requests; ++request) {
+		engine.spawn(compress_request(engine, request, input_size, compressed_sizes));
+	}
+	engine.run();
+
+	auto task_end = std::chrono::steady_clock::now();
+	double cpu_time_end = thread_cpu_seconds();
+
+	// wait for sync
+	end_barrier.arrive_and_wait();
+
+	// both HW finished processing
+	auto processing_end = std::chrono::steady_clock::now();
+
+	std::cout << "DOCA Compress (coroutines) results..." << std::endl;
+	auto ctx_stop_start = std::chrono::steady_clock::now();
+	engine.cleanup();
+	auto ctx_stop_end = std::chrono::steady_clock::now();
+
+	size_t compressed_bytes = 0;
+	for (auto size : compressed_sizes) {
+		compressed_bytes += size;
+	}
+
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(8) << cpu_time_end - cpu_time_start;
+	nlohmann::json j;
+	j["overall_submission_elapsed"] = calculateSeconds(task_end, processing_start);
+	j["ctx_stop_elapsed"] = calculateSeconds(ctx_stop_end, ctx_stop_start);
+	j["cpu_time_elapsed"] = oss.str();
+	j["joined_submission_elapsed"] = calculateSeconds(processing_end, processing_start);
+	j["requests"] = num_requests;
+	j["in_flight"] = in_flight;
+	j["completed"] = engine.completed();
+	j["failed"] = engine.failed();
+	j["peak_waiting"] = engine.peakWaiting();
+	j["compressed_bytes"] = compressed_bytes;
+	std::ofstream outFile("results-doca-compress-coro.json");
+	if (outFile) {
+		outFile << j.dump(4);
+	}
+	printf("[DOCA] user+sys = %s s\n", oss.str().c_str());
+}
+
+using CompressRouter = OffloadRouter<CompressDeflateTraits>;
+
+// Device slots of the router when --coroutines does not set them
+static const uint32_t ROUTE_DEFAULT_IN_FLIGHT = 16;
+
+// One lane: route the next unclaimed request until none is left, so every
+// routing decision sees the completions before it
+DocaCoroutine route_lane(CompressRouter& router, size_t& next_request, size_t num_requests, size_t input_size,
+						 std::vector<size_t>& compressed_sizes) {
+	while (next_request < num_requests) {
+		size_t request = next_request++;
+		size_t offset = request * CORO_REQUEST_SIZE;
+		size_t size = std::min(CORO_REQUEST_SIZE, input_size - offset);
+		auto result = co_await router.route(router.input().subspan(offset, size),
+											router.output().subspan(request * CORO_OUTPUT_SLOT, CORO_OUTPUT_SLOT));
+		if (result.status != DOCA_SUCCESS) {
+			std::cerr << "Request " << request << " failed: " << doca_error_get_descr(result.status) << std::endl;
+			continue;
+		}
+		compressed_sizes[request] = result.size;
+	}
+}
+
+// DPU side behind the router: each request goes to the device or to one of
+// the host workers, whichever is predicted to finish it first
+void doca_route_compress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, uint32_t in_flight,
+								OffloadOptions offload) {
+	// pin thread to specific core
+	pin_and_expose("DPU", 4);  // pick any isolated core
+
+	// DOCA init: register the whole input once (not measured)
+	std::ifstream input_file(CompressDeflateTraits::input_path, std::ios::binary | std::ios::ate);
+	size_t input_size = input_file.is_open() ? static_cast<size_t>(input_file.tellg()) : 0;
+	size_t num_requests = (input_size + CORO_REQUEST_SIZE - 1) / CORO_REQUEST_SIZE;
+	CompressRouter router(CompressRouter::DEVICE_TYPE::BF2, std::max<size_t>(input_size, 1),
+						  std::max<size_t>(num_requests, 1) * CORO_OUTPUT_SLOT, in_flight, offload.sw.threads);
+	if (input_size > 0 && router.ready()) {
+		input_file.seekg(0);
+		input_file.read(reinterpret_cast<char*>(router.input().data()), input_size);
+	} else {
+		std::cerr << "Routed compress could not be set up, no requests" << std::endl;
+		num_requests = 0;
+	}
+	std::vector<size_t> compressed_sizes(num_requests, 0);
+
+	// wait for sync
+	start_barrier.arrive_and_wait();
+
+	std::cout << "DOCA Compress (routed) start processing..." << std::endl;
+	double cpu_time_start = thread_cpu_seconds();
 	auto processing_start = std::chrono::steady_clock::now();
 
-	// execute task
-	consumer_compress_deflate.executeDocaTask();
+	// as many lanes as device slots plus host workers
+	size_t next_request = 0;
+	size_t lanes = std::min<size_t>(num_requests, in_flight + offload.sw.threads);
+	for (size_t lane = 0; lane < lanes; ++lane) {
+		router.spawn(route_lane(router, next_request, num_requests, input_size, compressed_sizes));
+	}
+	router.run();
+
+	auto task_end = std::chrono::steady_clock::now();
+	double cpu_time_end = thread_cpu_seconds();
 
 	// wait for sync
 	end_barrier.arrive_and_wait();
@@ -114,27 +350,48 @@ void doca_compress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barri
 	// both HW finished processing
 	auto processing_end = std::chrono::steady_clock::now();
 
-	// log writing state
-	std::cout << "DOCA Compress results..." << std::endl;
+	std::cout << "DOCA Compress (routed) results..." << std::endl;
+	auto ctx_stop_start = std::chrono::steady_clock::now();
+	router.cleanup();
+	auto ctx_stop_end = std::chrono::steady_clock::now();
 
-	// write results and output
-	auto result_times = consumer_compress_deflate.getDocaResults();
-	result_times.emplace_back(calculateSeconds(processing_end, processing_start));
-	auto name = "results-" + consumer_compress_deflate.getName() + ".json";
-	docaWriteJson(result_times, name);
-	printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
+	size_t compressed_bytes = 0;
+	for (auto size : compressed_sizes) {
+		compressed_bytes += size;
+	}
+
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(8) << cpu_time_end - cpu_time_start;
+	nlohmann::json j;
+	j["overall_submission_elapsed"] = calculateSeconds(task_end, processing_start);
+	j["ctx_stop_elapsed"] = calculateSeconds(ctx_stop_end, ctx_stop_start);
+	j["cpu_time_elapsed"] = oss.str();
+	j["joined_submission_elapsed"] = calculateSeconds(processing_end, processing_start);
+	j["requests"] = num_requests;
+	j["in_flight"] = in_flight;
+	j["cpu_threads"] = offload.sw.threads;
+	j["routed_hw"] = router.routedHw();
+	j["routed_cpu"] = router.routedCpu();
+	j["failed"] = router.failed();
+	j["latency_p50"] = router.latencyQuantile(0.5);
+	j["latency_p99"] = router.latencyQuantile(0.99);
+	j["latency_max"] = router.latencyQuantile(1.0);
+	j["compressed_bytes"] = compressed_bytes;
+	std::ofstream outFile("results-doca-compress-route.json");
+	if (outFile) {
+		outFile << j.dump(4);
+	}
+	printf("[DOCA] user+sys = %s s\n", oss.str().c_str());
 }
 
-void cpu_deflate_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier) {
+void cpu_adaptive_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, CodecSelector selector,
+						 bool verify) {
 	// pin thread to specific core
 	pin_and_expose("CPU", 3);  // pick any isolated core
 
-	// CPU init
-	Zpipe zpipe;
-	auto ret = zpipe.deflate_init("/dev/shm/deflt-input", "/dev/shm/deflt-out");
-	if (ret != Z_OK){
-		zpipe.zerr(ret);
-	}
+	// CPU init, chunks a BF3 task can take
+	AdaptiveCompressEngine adaptive("/dev/shm/deflt-input", "/dev/shm/adaptive-out.kcc", BUFFER_SIZE_BF3, selector);
+	adaptive.init();
 
 	// wait for sync
 	start_barrier.arrive_and_wait();
@@ -146,13 +403,10 @@ void cpu_deflate_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier
 	auto processing_start = std::chrono::steady_clock::now();
 
 	// log processing state
-    std::cout << "CPU dflt start processing..." << std::endl;
+	std::cout << "CPU adaptive start processing..." << std::endl;
 
 	// process data
-	ret = zpipe.deflate_execute_single_buffer();
-	if (ret != Z_OK){
-		zpipe.zerr(ret);
-	}
+	adaptive.execute();
 
 	// cpu finished its task
 	auto cpu_task_end = std::chrono::steady_clock::now();
@@ -161,7 +415,7 @@ void cpu_deflate_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier
 	double cpu_time_end = thread_cpu_seconds();
 
 	// log processing state
-	std::cout << "CPU dflt end processing!" << std::endl;
+	std::cout << "CPU adaptive end processing!" << std::endl;
 
 	// wait for sync
 	end_barrier.arrive_and_wait();
@@ -169,29 +423,255 @@ void cpu_deflate_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier
 	// both HW finished processing
 	auto processing_end = std::chrono::steady_clock::now();
 
-	// log processing state
-	std::cout << "CPU dflt get results..." << std::endl;
+	adaptive.cleanup();
 
-	zpipe.deflate_cleanup();
+	std::ostringstream oss;
+	oss << std::fixed << std::setprecision(8) << cpu_time_end - cpu_time_start;
+	nlohmann::json j;
+	j["overall_submission_elapsed"] = calculateSeconds(cpu_task_end, processing_start);
+	j["cpu_time_elapsed"] = oss.str();
+	j["joined_submission_elapsed"] = calculateSeconds(processing_end, processing_start);
+	j["chunks_lz4"] = adaptive.chunks(ChunkCodec::LZ4);
+	j["chunks_deflate"] = adaptive.chunks(ChunkCodec::DEFLATE);
+	j["chunks_stored"] = adaptive.chunks(ChunkCodec::STORED);
+	j["input_bytes"] = adaptive.inputBytes();
+	j["output_bytes"] = adaptive.outputBytes();
+	// round trip of the container, not measured
+	if (verify) {
+		j["container_verified"] = adaptive.verify();
+	}
+	std::ofstream outFile("results-cpu-compress-adaptive.json");
+	if (outFile) {
+		outFile << j.dump(4);
+	}
+	printf("[CPU] user+sys = %s s\n", oss.str().c_str());
+}
 
-	auto cpu_time_elapsed = cpu_time_end - cpu_time_start;
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(8) << cpu_time_elapsed;
-    std::string thread_time_elapsed = oss.str();
+// Values of a sweep point's last run as prefix + key columns, and with
+// repeated trials the median, p5/p95 and bootstrap interval of each timing
+void recordSweep(SweepTable& table, size_t row, const std::string& prefix, const std::vector<std::string>& keys,
+				 const std::vector<std::string>& values, const TrialRecorder& recorder, const TrialOptions& trials) {
+	table.set(row, prefix, keys, values);
+	if (!trials.repeated()) {
+		return;
+	}
+	auto format = [](double value) {
+		std::ostringstream oss;
+		oss << std::fixed << std::setprecision(8) << value;
+		return oss.str();
+	};
+	for (const auto& [key, summary] : recorder.summaries(keys)) {
+		table.set(row, prefix + key + "_median", format(summary.median));
+		table.set(row, prefix + key + "_p5", format(summary.p5));
+		table.set(row, prefix + key + "_p95", format(summary.p95));
+		table.set(row, prefix + key + "_ci_low", format(summary.ci_low));
+		table.set(row, prefix + key + "_ci_high", format(summary.ci_high));
+	}
+}
 
-	std::vector<std::string> results{calculateSeconds(cpu_task_end, processing_start), 
-						thread_time_elapsed, calculateSeconds(processing_end, processing_start)};
-	cpuWriteJson(results, "results-cpu-compress.json");
-	printf("[CPU] user+sys = %s s\n", thread_time_elapsed.c_str());
+// Sweep, DPU side: one context and one registration of the whole input for
+// all points, each point lays out its share as tasks on them (not measured).
+// A point without a share, or one that does not fit, only passes the barriers.
+void doca_sweep_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, OffloadOptions offload,
+					   TrialOptions trials, std::vector<SweepPoint> points, size_t file_size, SweepTable& table) {
+	// pin thread to specific core
+	pin_and_expose("DPU", 4);  // pick any isolated core
+
+	// context and inventory for the point with the most tasks
+	offload.task_slots = 1;
+	for (const auto& point : points) {
+		auto layout = prefixLayout(shareBytes(file_size, point.split_dpu), point.buffer_size, point.buffer_count,
+								   BUFFER_SIZE_BF2);
+		offload.task_slots = std::max(offload.task_slots, layout.tasks);
+	}
+
+	// DOCA init once, or the software executor without a device
+	runOffloadConsumer<CompressConsumer, SwCompressConsumer>(offload, [&](auto& consumer_compress_deflate) {
+		consumer_compress_deflate.keepAlive(true);
+		for (size_t row = 0; row < points.size(); ++row) {
+			const SweepPoint& point = points[row];
+			size_t bytes = shareBytes(file_size, point.split_dpu);
+			bool active = bytes > 0 && consumer_compress_deflate.reshape(bytes, point.buffer_size, point.buffer_count);
+			if (bytes > 0 && !active) {
+				std::cerr << "Sweep point " << row << " does not fit the context, skipped" << std::endl;
+			}
+
+			TrialRecorder recorder(trials);
+			auto result_times = runTrials(trials, recorder, [&] {
+				// tasks of the previous trial were freed (not measured)
+				if (active) {
+					consumer_compress_deflate.rearm();
+				}
+
+				// wait for sync
+				start_barrier.arrive_and_wait();
+
+				// entered processing
+				auto processing_start = std::chrono::steady_clock::now();
+
+				// execute task
+				if (active) {
+					consumer_compress_deflate.executeDocaTask();
+				}
+
+				// wait for sync
+				end_barrier.arrive_and_wait();
+
+				// both HW finished processing
+				auto processing_end = std::chrono::steady_clock::now();
+				if (!active) {
+					return std::vector<std::string>{};
+				}
+				return offloadResults(consumer_compress_deflate, calculateSeconds(processing_end, processing_start));
+			});
+
+			if (active) {
+				table.set(row, "dpu_tasks", std::to_string(consumer_compress_deflate.numTasks()));
+				table.set(row, "dpu_buffer_size", std::to_string(consumer_compress_deflate.bufferSize()));
+				recordSweep(table, row, "doca_", DOCA_RESULT_KEYS, result_times, recorder, trials);
+			}
+			std::cout << "Sweep point " << row + 1 << "/" << points.size() << " done" << std::endl;
+		}
+		consumer_compress_deflate.cleanup();
+	}, CompressConsumer::DEVICE_TYPE::BF2, 0);
+}
+
+// Sweep, CPU side: the input is read once, each point deflates its share
+// from the front of it, as measure-compress.sh truncates the file.
+void cpu_sweep_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, bool bypass, TrialOptions trials,
+					  std::vector<SweepPoint> points, size_t file_size, SweepTable& table) {
+	// pin thread to specific core
+	pin_and_expose("CPU", 3);  // pick any isolated core
+
+	// CPU init
+	Zpipe zpipe;
+	zpipe.set_incompressible_bypass(bypass);
+	auto ret = zpipe.deflate_init("/dev/shm/deflt-input", "/dev/shm/deflt-out");
+	if (ret != Z_OK){
+		zpipe.zerr(ret);
+	}
+
+	for (size_t row = 0; row < points.size(); ++row) {
+		size_t bytes = shareBytes(file_size, 100 - points[row].split_dpu);
+		zpipe.set_input_limit(bytes);
+
+		TrialRecorder recorder(trials);
+		auto results = runTrials(trials, recorder, [&] {
+			// wait for sync
+			start_barrier.arrive_and_wait();
+
+			// log cpu-time start
+			double cpu_time_start = thread_cpu_seconds();
+
+			// entered processing
+			auto processing_start = std::chrono::steady_clock::now();
+
+			// process data
+			if (bytes > 0) {
+				ret = zpipe.deflate_execute_single_buffer();
+				if (ret != Z_OK){
+					zpipe.zerr(ret);
+				}
+			}
+
+			// cpu finished its task
+			auto cpu_task_end = std::chrono::steady_clock::now();
+
+			// log cpu-time end
+			double cpu_time_end = thread_cpu_seconds();
+
+			// wait for sync
+			end_barrier.arrive_and_wait();
+
+			// both HW finished processing
+			auto processing_end = std::chrono::steady_clock::now();
+			return cpuResults(processing_start, cpu_task_end, processing_end, cpu_time_end - cpu_time_start);
+		});
+
+		if (bytes > 0) {
+			recordSweep(table, row, "cpu_", CPU_RESULT_KEYS, results, recorder, trials);
+		}
+	}
+
+	zpipe.deflate_cleanup();
 }
 
 int main(int argc, char **argv) {
-	// Ensure we receive exactly two arguments
-    if (argc != 3) {
-        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2>\n";
+	// Ensure we receive the two positional arguments
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> [--coroutines IN_FLIGHT] [--route] "
+                  << "[--adaptive host|bf2|bf3] [--max-ratio-loss F] [--target-mibs F] "
+                  << "[--libdeflate] [--libdeflate-level N] [--pool N] " << ZstdOptions::usage << " "
+                  << OffloadOptions::usage << " " << TrialOptions::usage << " " << SweepOptions::usage << "\n";
         return 1;
     }
 
+	// Optional flags after the positional arguments
+	uint32_t coro_in_flight = 0;
+	bool route = false;
+	bool adaptive = false;
+	CodecSelector selector;
+	ZstdOptions zstd;
+	bool libdeflate = false;
+	int libdeflate_level = 6;
+	OffloadOptions offload;
+	TrialOptions trials;
+	SweepOptions sweep;
+	size_t pool_contexts = 0;
+	for (int idx = 3; idx < argc; ++idx) {
+		std::string flag = argv[idx];
+		if (offload.parseFlag(argc, argv, idx) || zstd.parseFlag(argc, argv, idx) || trials.parseFlag(argc, argv, idx) ||
+			sweep.parseFlag(argc, argv, idx)) {
+			continue;
+		} else if (flag == "--coroutines" && idx + 1 < argc) {
+			// DPU side as one coroutine per request, IN_FLIGHT tasks on the device
+			coro_in_flight = static_cast<uint32_t>(std::stoul(argv[++idx]));
+		} else if (flag == "--route") {
+			// route each request to the device or a host worker (--sw-threads), IN_FLIGHT from --coroutines
+			route = true;
+		} else if (flag == "--adaptive" && idx + 1 < argc) {
+			// CPU side picks LZ4 or deflate per chunk for the device that will decompress
+			adaptive = true;
+			if (!parseDecodeTarget(argv[++idx], selector.budget.target)) {
+				std::cerr << "Error: --adaptive takes host, bf2 or bf3" << std::endl;
+				return 1;
+			}
+		} else if (flag == "--pool" && idx + 1 < argc) {
+			// DPU side as jobs on N contexts opened before the first run
+			pool_contexts = std::stoul(argv[++idx]);
+		} else if (flag == "--libdeflate") {
+			// CPU share as one whole-buffer libdeflate call instead of streaming zlib
+			libdeflate = true;
+		} else if (flag == "--libdeflate-level" && idx + 1 < argc) {
+			libdeflate_level = std::stoi(argv[++idx]);
+		} else if (flag == "--max-ratio-loss" && idx + 1 < argc) {
+			selector.budget.max_ratio_loss = std::stod(argv[++idx]);
+		} else if (flag == "--target-mibs" && idx + 1 < argc) {
+			selector.budget.target_mib_s = std::stod(argv[++idx]);
+		} else {
+			std::cerr << "Error: unknown option " << flag << std::endl;
+			return 1;
+		}
+	}
+	// the coroutine, routed and adaptive workers run once
+	if (trials.repeated() && (coro_in_flight > 0 || route || adaptive)) {
+		std::cerr << "Error: --warmup/--repeat do not support --coroutines, --route or --adaptive" << std::endl;
+		return 1;
+	}
+
+	// the pooled jobs run on the task consumer
+	if (pool_contexts > 0 && (coro_in_flight > 0 || route || sweep.enabled)) {
+		std::cerr << "Error: --pool does not support --coroutines, --route or the --sweep-* options" << std::endl;
+		return 1;
+	}
+
+	// the sweep runs the default engines of both shares
+	if (sweep.enabled && (coro_in_flight > 0 || route || adaptive || libdeflate || zstd.enabled)) {
+		std::cerr << "Error: the --sweep-* options do not support --coroutines, --route, --adaptive, --libdeflate or --zstd"
+				  << std::endl;
+		return 1;
+	}
+
 	// Convert arguments to integers
     int percentage_cpu = std::stoi(argv[1]);
     int percentage_dpu = std::stoi(argv[2]);
@@ -203,6 +683,48 @@ int main(int argc, char **argv) {
     }
 
 
+	// ISA variants the hot kernels picked on this CPU
+	std::cout << "CPU: " << cpuFeaturesString() << " (" << checksumKernels() << ")" << std::endl;
+
+	// Sweep: the whole grid in this process, the percentages are ignored
+	if (sweep.enabled) {
+		std::error_code size_error;
+		size_t file_size = std::filesystem::file_size(CompressDeflateTask::input_path, size_error);
+		if (size_error) {
+			std::cerr << "Error: cannot stat " << CompressDeflateTask::input_path << std::endl;
+			return 1;
+		}
+		auto points = sweep.points();
+		SweepTable table(points.size());
+		for (size_t row = 0; row < points.size(); ++row) {
+			table.set(row, "split_cpu", std::to_string(100 - points[row].split_dpu));
+			table.set(row, "split_dpu", std::to_string(points[row].split_dpu));
+			table.set(row, "buffer_size", std::to_string(points[row].buffer_size));
+			table.set(row, "buffer_count", std::to_string(points[row].buffer_count));
+			table.set(row, "cpu_bytes", std::to_string(shareBytes(file_size, 100 - points[row].split_dpu)));
+			table.set(row, "dpu_bytes", std::to_string(shareBytes(file_size, points[row].split_dpu)));
+		}
+
+		SimpleBarrier start_barrier(2);
+		SimpleBarrier end_barrier(2);
+		SweepTable cpu_table(points.size());
+		SweepTable doca_table(points.size());
+		std::thread cpu_thread(cpu_sweep_worker, std::ref(start_barrier), std::ref(end_barrier), offload.bypass.enabled,
+							   trials, points, file_size, std::ref(cpu_table));
+		std::thread doca_thread(doca_sweep_worker, std::ref(start_barrier), std::ref(end_barrier), offload, trials,
+								points, file_size, std::ref(doca_table));
+		cpu_thread.join();
+		doca_thread.join();
+
+		table.merge(cpu_table);
+		table.merge(doca_table);
+		if (!table.write(sweep.output)) {
+			return 1;
+		}
+		std::cout << "Sweep of " << points.size() << " points written to " << sweep.output << std::endl;
+		return EXIT_SUCCESS;
+	}
+
 	// how many threads to use
 	int THREAD_COUNT = 2;
 	if (percentage_cpu == 0 || percentage_dpu == 0) {
@@ -218,12 +740,37 @@ int main(int argc, char **argv) {
 	threads.reserve(THREAD_COUNT);
 	
 	// Compress co-processing
-	if (percentage_cpu > 0) {
-		threads.emplace_back(cpu_deflate_worker, std::ref(start_barrier), std::ref(end_barrier));
+	if (percentage_cpu > 0 && libdeflate) {
+		// raw deflate as the DPU share writes it
+		threads.emplace_back(cpu_codec_worker<LibdeflateEngine, std::string, std::string, int>, std::ref(start_barrier),
+							 std::ref(end_barrier), CpuWorkerConfig{"CPU dflt", "results-cpu-compress-libdeflate.json"},
+							 trials, "/dev/shm/deflt-input", "/dev/shm/libdeflate-out", libdeflate_level);
+	} else if (percentage_cpu > 0 && zstd.enabled) {
+		// zstd's own workers are other threads: process time then, run without a DPU share to isolate them
+		threads.emplace_back(cpu_codec_worker<ZstdCompressEngine, std::string, std::string, ZstdOptions>,
+							 std::ref(start_barrier), std::ref(end_barrier),
+							 CpuWorkerConfig{"CPU zstd", "results-cpu-compress-zstd.json", zstd.workers > 0}, trials,
+							 "/dev/shm/deflt-input", "/dev/shm/zstd-out", zstd);
+	} else if (percentage_cpu > 0 && adaptive) {
+		selector.estimator.enabled = offload.bypass.enabled;
+		threads.emplace_back(cpu_adaptive_worker, std::ref(start_barrier), std::ref(end_barrier), selector,
+							 offload.verify);
+	} else if (percentage_cpu > 0) {
+		threads.emplace_back(cpu_codec_worker<DeflateEngine, std::string, std::string, bool>, std::ref(start_barrier),
+							 std::ref(end_barrier), CpuWorkerConfig{"CPU dflt", "results-cpu-compress.json"}, trials,
+							 "/dev/shm/deflt-input", "/dev/shm/deflt-out", offload.bypass.enabled);
 	}
 	
-	if (percentage_dpu > 0) {
-		threads.emplace_back(doca_compress_worker, std::ref(start_barrier), std::ref(end_barrier));
+	if (percentage_dpu > 0 && route) {
+		threads.emplace_back(doca_route_compress_worker, std::ref(start_barrier), std::ref(end_barrier),
+							 coro_in_flight > 0 ? coro_in_flight : ROUTE_DEFAULT_IN_FLIGHT, offload);
+	} else if (percentage_dpu > 0 && coro_in_flight > 0) {
+		threads.emplace_back(doca_coro_compress_worker, std::ref(start_barrier), std::ref(end_barrier), coro_in_flight);
+	} else if (percentage_dpu > 0 && pool_contexts > 0) {
+		threads.emplace_back(doca_pool_compress_worker, std::ref(start_barrier), std::ref(end_barrier), offload, trials,
+							 pool_contexts);
+	} else if (percentage_dpu > 0) {
+		threads.emplace_back(doca_compress_worker, std::ref(start_barrier), std::ref(end_barrier), offload, trials);
 	}
 
 	// Join threads
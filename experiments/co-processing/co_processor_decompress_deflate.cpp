@@ -16,67 +16,34 @@
 #include <doca_mmap.h>
 #include <doca_pe.h>
 
-#include "doca_consumer.hpp"
 #include "simple_barrier.hpp"
+#include "cpu_codec_engine.hpp"
+#include "cpu_codec_worker.hpp"
+#include "cpu_dispatch.hpp"
+#include "libdeflate_pipe.hpp"
 #include "zpipe.hpp"
+#include "zstd_pipe.hpp"
 #include "doca_decompress_deflate.hpp"
+#include "offload_consumer.hpp"
+#include "trial_stats.hpp"
 
 #include <nlohmann/json.hpp>
 
-void pin_and_expose(const char* name, int core) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(core, &mask);
-    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
-
-    pid_t tid = syscall(SYS_gettid);
-    printf("%s TID=%d (core %d)\n", name, tid, core);
-    fflush(stdout);
-}
-
-double thread_cpu_seconds() {
-    timespec ts;
-    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
-    return ts.tv_sec + ts.tv_nsec * 1e-9;
-}
-
-std::string calculateSeconds(const std::chrono::steady_clock::time_point end,
-											   const std::chrono::steady_clock::time_point start) {
-	auto elapsed = end - start;
-	auto seconds = std::chrono::duration<double>(elapsed).count();
-	// Convert the float to a string with fixed formatting and desired precision
-	std::ostringstream oss;
-	oss << std::fixed << std::setprecision(8) << seconds;
-	std::string formattedValue = oss.str();
-	return formattedValue;
-}
-
-void docaWriteJson(const std::vector<std::string> times, const std::string filename) {
+void docaWriteJson(const std::vector<std::string> times, const std::string filename,
+				   const TrialRecorder& trials = TrialRecorder()) {
 	nlohmann::json j;
 	std::vector<std::string> keys = {"overall_submission_elapsed", "task_submission_elapsed",
 									 "busy_wait_elapsed", "cb_elapsed", "cb_end_elapsed", 
 									 "ctx_stop_elapsed", "cpu_time_elapsed", 
-									 "joined_submission_elapsed"};
+									 "joined_submission_elapsed", "worker_cpu_time_elapsed",
+									 RETRY_COUNTER_KEYS, CHECKSUM_KEYS, INIT_TIMING_KEYS};
 	for (uint16_t idx = 0; idx < times.size(); ++idx) {
 		j[keys[idx]] = times[idx];
 	}
-
-	// Pretty print the JSON with an indent of 4 spaces
-    std::string prettyJson = j.dump(4);
-
-	// Optionally, write the pretty printed JSON to a file
-    std::ofstream outFile(filename);
-    if (outFile) {
-        outFile << prettyJson;
-    }
-}
-
-void cpuWriteJson(const std::vector<std::string> times, const std::string filename) {
-	nlohmann::json j;
-	std::vector<std::string> keys = {"overall_submission_elapsed", "cpu_time_elapsed",
-									 "joined_submission_elapsed"};
-	for (uint16_t idx = 0; idx < times.size(); ++idx) {
-		j[keys[idx]] = times[idx];
+	// summaries of the repeated trials, if any
+	auto summary = trials.toJson(keys);
+	if (!summary.is_null()) {
+		j["trials"] = summary;
 	}
 
 	// Pretty print the JSON with an indent of 4 spaces
@@ -90,7 +57,8 @@ void cpuWriteJson(const std::vector<std::string> times, const std::string filena
 }
 
 void doca_decompress_deflate_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, 
-		uint64_t asked_buffer_size, uint64_t asked_num_buffers, size_t original_filesize, int bf_version) {
+		uint64_t asked_buffer_size, uint64_t asked_num_buffers, size_t original_filesize, int bf_version,
+		OffloadOptions offload, TrialOptions trials) {
 	// pin thread to specific core
 	pin_and_expose("DPU", 4);  // pick any isolated core
 	
@@ -100,119 +68,76 @@ void doca_decompress_deflate_worker(SimpleBarrier& start_barrier, SimpleBarrier&
 		device = DecompressDeflateConsumer::DEVICE_TYPE::BF3;
 	}
 
-	// DOCA init
-	auto consumer_decompress_deflate = DecompressDeflateConsumer(device, asked_buffer_size, asked_num_buffers, original_filesize, true);
+	// DOCA init, or the software executor without a device
+	runOffloadConsumer<DecompressDeflateConsumer, SwDecompressDeflateConsumer>(offload, [&](auto& consumer_decompress_deflate) {
+		// log waiting state
+		std::cout << "DOCA Decompress ready, waiting..." << std::endl;
 
-	// log waiting state
-	std::cout << "DOCA Decompress ready, waiting..." << std::endl;
+		TrialRecorder recorder(trials);
+		size_t trial = 0;
+		auto result_times = runTrials(trials, recorder, [&] {
+			// tasks of the previous trial were freed (not measured)
+			consumer_decompress_deflate.rearm();
+			// the context stays up for the next trial
+			consumer_decompress_deflate.keepAlive(++trial < trials.runs());
 
-	// wait for sync
-	start_barrier.arrive_and_wait();
+			// wait for sync
+			start_barrier.arrive_and_wait();
 
-	// log processing state
-	std::cout << "DOCA Decompress start processing..." << std::endl;
+			// log processing state
+			std::cout << "DOCA Decompress start processing..." << std::endl;
 
-	// entered processing
-	auto processing_start = std::chrono::steady_clock::now();
+			// entered processing
+			auto processing_start = std::chrono::steady_clock::now();
 
-	// TODO: send task
-	consumer_decompress_deflate.executeDocaTask();
+			// TODO: send task
+			consumer_decompress_deflate.executeDocaTask();
 
-	// wait for sync
-	end_barrier.arrive_and_wait();
+			// wait for sync
+			end_barrier.arrive_and_wait();
 
-	// both HW finished processing
-	auto processing_end = std::chrono::steady_clock::now();
+			// both HW finished processing
+			auto processing_end = std::chrono::steady_clock::now();
+			return offloadResults(consumer_decompress_deflate, calculateSeconds(processing_end, processing_start));
+		});
 
-	// log writing state
-	std::cout << "DOCA Decompress results..." << std::endl;
+		// log writing state
+		std::cout << "DOCA Decompress results..." << std::endl;
 
-	// write results and output
-	auto result_times = consumer_decompress_deflate.getDocaResults();
-	result_times.emplace_back(calculateSeconds(processing_end, processing_start));
-	auto name = "results-" + consumer_decompress_deflate.getName() + ".json";
-	docaWriteJson(result_times, name);
-	printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
-}
-
-void cpu_inflate_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier) {
-	// pin thread to specific core
-	pin_and_expose("CPU", 3);  // pick any isolated core
-	
-	// CPU init
-	Zpipe zpipe;
-	// bool singleBufferExecution = true;
-	auto ret = zpipe.deflate_init("/dev/shm/infl", "/dev/shm/infl-input");
-	if (ret != Z_OK){
-		zpipe.zerr(ret);
-	}
-	ret = zpipe.deflate_execute_single_buffer();
-	if (ret != Z_OK){
-		zpipe.zerr(ret);
-	}
-	zpipe.deflate_cleanup();
-
-	ret = zpipe.inflate_init("/dev/shm/infl-input", "/dev/shm/infl-out");
-	if (ret != Z_OK){
-		zpipe.zerr(ret);
-	}
-
-	// log waiting state
-    std::cout << "CPU ready, waiting..." << std::endl;
-
-	// wait for sync
-	start_barrier.arrive_and_wait();
-
-	// log cpu-time start
-	double cpu_time_start = thread_cpu_seconds();
-
-	// entered processing
-	auto processing_start = std::chrono::steady_clock::now();
-
-	// log processing state
-    std::cout << "CPU start processing..." << std::endl;
-
-	// process data
-	ret = zpipe.inflate_execute_single_buffer();
-	if (ret != Z_OK){
-		zpipe.zerr(ret);
-	}
-
-	// cpu finished its task
-	auto cpu_task_end = std::chrono::steady_clock::now();
-
-	// log cpu-time end
-	double cpu_time_end = thread_cpu_seconds();
-
-	// wait for sync
-	end_barrier.arrive_and_wait();
-
-	// both HW finished processing
-	auto processing_end = std::chrono::steady_clock::now();
-
-	// log processing state
-	std::cout << "CPU get results..." << std::endl;
-
-	zpipe.inflate_cleanup();
-
-	auto cpu_time_elapsed = cpu_time_end - cpu_time_start;
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(8) << cpu_time_elapsed;
-    std::string thread_time_elapsed = oss.str();
-
-	std::vector<std::string> results{calculateSeconds(cpu_task_end, processing_start),
-						thread_time_elapsed, calculateSeconds(processing_end, processing_start)};
-	cpuWriteJson(results, "results-cpu-decompress-deflate.json");
-	printf("[CPU] user+sys = %s s\n", thread_time_elapsed.c_str());
+		// write results and output
+		auto name = "results-" + consumer_decompress_deflate.getName() + ".json";
+		docaWriteJson(result_times, name, recorder);
+		printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
+	}, device, asked_buffer_size, asked_num_buffers, original_filesize);
 }
 
 int main(int argc, char **argv) {
 	// Ensure we receive exactly two arguments
-    if (argc != 7) {
-        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> <original_filesize> <bf_version> <asked_buffer_size> <asked_num_buffers>" << std::endl;
+    if (argc < 7) {
+        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> <original_filesize> <bf_version> <asked_buffer_size> <asked_num_buffers> [--libdeflate] [--libdeflate-level N] " << ZstdOptions::usage << " " << OffloadOptions::usage << " " << TrialOptions::usage << std::endl;
         return 1;
     }
 
+	// Optional flags after the positional arguments
+	OffloadOptions offload;
+	ZstdOptions zstd;
+	TrialOptions trials;
+	bool libdeflate = false;
+	int libdeflate_level = 6;
+	for (int idx = 7; idx < argc; ++idx) {
+		std::string flag = argv[idx];
+		if (flag == "--libdeflate") {
+			// CPU share as one whole-buffer libdeflate call instead of streaming zlib
+			libdeflate = true;
+		} else if (flag == "--libdeflate-level" && idx + 1 < argc) {
+			libdeflate_level = std::stoi(argv[++idx]);
+		} else if (!offload.parseFlag(argc, argv, idx) && !zstd.parseFlag(argc, argv, idx) &&
+				   !trials.parseFlag(argc, argv, idx)) {
+			std::cerr << "Error: unknown option " << argv[idx] << std::endl;
+			return 1;
+		}
+	}
+
 	// Convert arguments to integers
     int percentage_cpu = std::stoi(argv[1]);
     int percentage_dpu = std::stoi(argv[2]);
@@ -238,6 +163,9 @@ int main(int argc, char **argv) {
 	}
 
 
+	// ISA variants the hot kernels picked on this CPU
+	std::cout << "CPU: " << cpuFeaturesString() << " (" << checksumKernels() << ")" << std::endl;
+
 	// how many threads to use
 	int THREAD_COUNT = 2;
 	if (percentage_cpu == 0 || percentage_dpu == 0) {
@@ -253,8 +181,19 @@ int main(int argc, char **argv) {
 	threads.reserve(THREAD_COUNT);
 	
 	// Decompress DEFLATE co-processing
-	if (percentage_cpu > 0) {
-		threads.emplace_back(cpu_inflate_worker, std::ref(start_barrier), std::ref(end_barrier));
+	if (percentage_cpu > 0 && libdeflate) {
+		threads.emplace_back(cpu_codec_worker<LibinflateEngine, std::string, std::string, int>, std::ref(start_barrier),
+							 std::ref(end_barrier), CpuWorkerConfig{"CPU", "results-cpu-decompress-libdeflate.json"},
+							 trials, "/dev/shm/infl", "/dev/shm/infl-out", libdeflate_level);
+	} else if (percentage_cpu > 0 && zstd.enabled) {
+		threads.emplace_back(cpu_codec_worker<ZstdDecompressEngine, std::string, std::string, ZstdOptions>,
+							 std::ref(start_barrier), std::ref(end_barrier),
+							 CpuWorkerConfig{"CPU zstd", "results-cpu-decompress-zstd.json"}, trials,
+							 "/dev/shm/infl", "/dev/shm/zstd-infl-out", zstd);
+	} else if (percentage_cpu > 0) {
+		threads.emplace_back(cpu_codec_worker<InflateEngine, std::string, std::string>, std::ref(start_barrier),
+							 std::ref(end_barrier), CpuWorkerConfig{"CPU", "results-cpu-decompress-deflate.json"}, trials,
+							 "/dev/shm/infl", "/dev/shm/infl-out");
 	}
 	
 	if (percentage_dpu > 0) {
@@ -263,7 +202,8 @@ int main(int argc, char **argv) {
 							 std::ref(asked_buffer_size),
 							 std::ref(asked_num_buffers),
 							 std::ref(original_filesize), 
-							 std::ref(bf_version));
+							 std::ref(bf_version),
+							 offload, trials);
 	}
 
 	// Join threads
@@ -16,67 +16,32 @@
 #include <doca_mmap.h>
 #include <doca_pe.h>
 
-#include "doca_consumer.hpp"
 #include "simple_barrier.hpp"
+#include "cpu_codec_engine.hpp"
+#include "cpu_codec_worker.hpp"
+#include "cpu_dispatch.hpp"
 #include "lz4_pipe.hpp"
 #include "doca_decompress_lz4.hpp"
+#include "offload_consumer.hpp"
+#include "trial_stats.hpp"
 
 #include <nlohmann/json.hpp>
 
-void pin_and_expose(const char* name, int core) {
-    cpu_set_t mask;
-    CPU_ZERO(&mask);
-    CPU_SET(core, &mask);
-    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
-
-    pid_t tid = syscall(SYS_gettid);
-    printf("%s TID=%d (core %d)\n", name, tid, core);
-    fflush(stdout);
-}
-
-double thread_cpu_seconds() {
-    timespec ts;
-    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
-    return ts.tv_sec + ts.tv_nsec * 1e-9;
-}
-
-std::string calculateSeconds(const std::chrono::steady_clock::time_point end,
-							 const std::chrono::steady_clock::time_point start) {
-	auto elapsed = end - start;
-	auto seconds = std::chrono::duration<double>(elapsed).count();
-	// Convert the float to a string with fixed formatting and desired precision
-	std::ostringstream oss;
-	oss << std::fixed << std::setprecision(8) << seconds;
-	std::string formattedValue = oss.str();
-	return formattedValue;
-}
-
-void docaWriteJson(const std::vector<std::string> times, const std::string filename) {
+void docaWriteJson(const std::vector<std::string> times, const std::string filename,
+				   const TrialRecorder& trials = TrialRecorder()) {
 	nlohmann::json j;
 	std::vector<std::string> keys = {"overall_submission_elapsed", "task_submission_elapsed",
 									 "busy_wait_elapsed", "cb_elapsed", "cb_end_elapsed", 
 									 "ctx_stop_elapsed", "cpu_time_elapsed", 
-									 "joined_submission_elapsed"};
+									 "joined_submission_elapsed", "worker_cpu_time_elapsed",
+									 RETRY_COUNTER_KEYS, CHECKSUM_KEYS, INIT_TIMING_KEYS};
 	for (uint16_t idx = 0; idx < times.size(); ++idx) {
 		j[keys[idx]] = times[idx];
 	}
-
-	// Pretty print the JSON with an indent of 4 spaces
-    std::string prettyJson = j.dump(4);
-
-	// Optionally, write the pretty printed JSON to a file
-    std::ofstream outFile(filename);
-    if (outFile) {
-        outFile << prettyJson;
-    }
-}
-
-void cpuWriteJson(const std::vector<std::string> times, const std::string filename) {
-	nlohmann::json j;
-	std::vector<std::string> keys = {"overall_submission_elapsed", "cpu_time_elapsed",
-									 "joined_submission_elapsed"};
-	for (uint16_t idx = 0; idx < times.size(); ++idx) {
-		j[keys[idx]] = times[idx];
+	// summaries of the repeated trials, if any
+	auto summary = trials.toJson(keys);
+	if (!summary.is_null()) {
+		j["trials"] = summary;
 	}
 
 	// Pretty print the JSON with an indent of 4 spaces
@@ -90,121 +55,70 @@ void cpuWriteJson(const std::vector<std::string> times, const std::string filena
 }
 
 void doca_decompress_lz4_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, 
-			uint64_t asked_buffer_size, uint64_t asked_num_buffers, size_t original_filesize) {
+			uint64_t asked_buffer_size, uint64_t asked_num_buffers, size_t original_filesize, OffloadOptions offload, TrialOptions trials) {
 	// pin thread to specific core
 	pin_and_expose("DPU", 4);  // pick any isolated core
 
-	// DOCA init
-	auto consumer_decompress_lz4 = DecompressLz4Consumer(DecompressLz4Consumer::DEVICE_TYPE::BF3, asked_buffer_size, asked_num_buffers, original_filesize, true);
-
-	// log waiting state
-	std::cout << "DOCA Decompress ready, waiting..." << std::endl;
-
-	// wait for sync
-	start_barrier.arrive_and_wait();
-
-	// log processing state
-	std::cout << "DOCA Decompress start processing..." << std::endl;
+	// DOCA init, or the software executor without a device
+	runOffloadConsumer<DecompressLz4Consumer, SwDecompressLz4Consumer>(offload, [&](auto& consumer_decompress_lz4) {
+		// log waiting state
+		std::cout << "DOCA Decompress ready, waiting..." << std::endl;
 
-	// entered processing
-	auto processing_start = std::chrono::steady_clock::now();
+		TrialRecorder recorder(trials);
+		size_t trial = 0;
+		auto result_times = runTrials(trials, recorder, [&] {
+			// tasks of the previous trial were freed (not measured)
+			consumer_decompress_lz4.rearm();
+			// the context stays up for the next trial
+			consumer_decompress_lz4.keepAlive(++trial < trials.runs());
 
-	// TODO: send task
-	consumer_decompress_lz4.executeDocaTask();
+			// wait for sync
+			start_barrier.arrive_and_wait();
 
-	// wait for sync
-	end_barrier.arrive_and_wait();
+			// log processing state
+			std::cout << "DOCA Decompress start processing..." << std::endl;
 
-	// both HW finished processing
-	auto processing_end = std::chrono::steady_clock::now();
+			// entered processing
+			auto processing_start = std::chrono::steady_clock::now();
 
-	// log writing state
-	std::cout << "DOCA Decompress results..." << std::endl;
+			// TODO: send task
+			consumer_decompress_lz4.executeDocaTask();
 
-	// write results and output
-	auto result_times = consumer_decompress_lz4.getDocaResults();
-	result_times.emplace_back(calculateSeconds(processing_end, processing_start));
-	auto name = "results-" + consumer_decompress_lz4.getName() + ".json";
-	docaWriteJson(result_times, name);
-	printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
-}
-
-void cpu_lz4_decompress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier) {
-	// pin thread to specific core
-	pin_and_expose("CPU", 3);  // pick any isolated core
-	
-	// CPU init
-	LZ4Pipe lz4_pipe;
-	auto ret = lz4_pipe.compress_init("/dev/shm/lz4", "/dev/shm/lz4-input");
-	if (ret != 0) {
-		std::cerr << "Failed init compress CPU LZ4" << std::endl;
-	}
-
-	ret = lz4_pipe.compress_execute();
-	if (ret != 0) {
-		std::cerr << "Failed exec compress CPU LZ4" << std::endl;
-	}
-
-	lz4_pipe.compress_cleanup();
-	
-	ret = lz4_pipe.decompress_init("/dev/shm/lz4-input", "/dev/shm/lz4-output");
-
-	// log waiting state
-    std::cout << "CPU ready, waiting..." << std::endl;
-
-	// wait for sync
-	start_barrier.arrive_and_wait();
-
-	// log cpu-time start
-	double cpu_time_start = thread_cpu_seconds();
+			// wait for sync
+			end_barrier.arrive_and_wait();
 
-	// entered processing
-	auto processing_start = std::chrono::steady_clock::now();
+			// both HW finished processing
+			auto processing_end = std::chrono::steady_clock::now();
+			return offloadResults(consumer_decompress_lz4, calculateSeconds(processing_end, processing_start));
+		});
 
-	// log processing state
-    std::cout << "CPU LZ4 start processing..." << std::endl;
+		// log writing state
+		std::cout << "DOCA Decompress results..." << std::endl;
 
-	// process data
-	ret = lz4_pipe.decompress_execute();
-
-	// cpu finished its task
-	auto cpu_task_end = std::chrono::steady_clock::now();
-
-	// log cpu-time end
-	double cpu_time_end = thread_cpu_seconds();
-
-	// log processing state
-	std::cout << "CPU LZ4 end processing!" << std::endl;
-
-	// wait for sync
-	end_barrier.arrive_and_wait();
-
-	// both HW finished processing
-	auto processing_end = std::chrono::steady_clock::now();
-
-	// log processing state
-	std::cout << "CPU LZ4 get results..." << std::endl;
-
-	lz4_pipe.decompress_cleanup();
-
-	auto cpu_time_elapsed = cpu_time_end - cpu_time_start;
-    std::ostringstream oss;
-    oss << std::fixed << std::setprecision(8) << cpu_time_elapsed;
-    std::string thread_time_elapsed = oss.str();
-
-	std::vector<std::string> results{calculateSeconds(cpu_task_end, processing_start), 
-					thread_time_elapsed, calculateSeconds(processing_end, processing_start)};
-	cpuWriteJson(results, "results-cpu-decompress-lz4.json");
-	printf("[CPU] user+sys = %s s\n", thread_time_elapsed.c_str());
+		// write results and output
+		auto name = "results-" + consumer_decompress_lz4.getName() + ".json";
+		docaWriteJson(result_times, name, recorder);
+		printf("[DOCA] user+sys = %s s\n", result_times[6].c_str());
+	}, DecompressLz4Consumer::DEVICE_TYPE::BF3, asked_buffer_size, asked_num_buffers, original_filesize);
 }
 
 int main(int argc, char **argv) {
 	// Ensure we receive exactly two arguments
-    if (argc != 7) {
-        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> <original_filesize> <bf_version> <asked_buffer_size> <asked_num_buffers>" << std::endl;
+    if (argc < 7) {
+        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> <original_filesize> <bf_version> <asked_buffer_size> <asked_num_buffers> " << OffloadOptions::usage << " " << TrialOptions::usage << std::endl;
         return 1;
     }
 
+	// Optional flags after the positional arguments
+	OffloadOptions offload;
+	TrialOptions trials;
+	for (int idx = 7; idx < argc; ++idx) {
+		if (!offload.parseFlag(argc, argv, idx) && !trials.parseFlag(argc, argv, idx)) {
+			std::cerr << "Error: unknown option " << argv[idx] << std::endl;
+			return 1;
+		}
+	}
+
 	// Convert arguments to integers
     int percentage_cpu = std::stoi(argv[1]);
     int percentage_dpu = std::stoi(argv[2]);
@@ -224,6 +138,9 @@ int main(int argc, char **argv) {
         return 1;
 	}
 
+	// ISA variants the hot kernels picked on this CPU
+	std::cout << "CPU: " << cpuFeaturesString() << " (" << checksumKernels() << ")" << std::endl;
+
 	// how many threads to use
 	int THREAD_COUNT = 2;
 	if (percentage_cpu == 0 || percentage_dpu == 0) {
@@ -240,7 +157,9 @@ int main(int argc, char **argv) {
 	
 	// Decompress LZ4 co-processing
 	if (percentage_cpu > 0) {
-		threads.emplace_back(cpu_lz4_decompress_worker, std::ref(start_barrier), std::ref(end_barrier));
+		threads.emplace_back(cpu_codec_worker<Lz4DecompressEngine, std::string, std::string>, std::ref(start_barrier),
+							 std::ref(end_barrier), CpuWorkerConfig{"CPU LZ4", "results-cpu-decompress-lz4.json"}, trials,
+							 "/dev/shm/lz4", "/dev/shm/lz4-output");
 	}
 	
 	if (percentage_dpu > 0) {
@@ -248,7 +167,8 @@ int main(int argc, char **argv) {
 							 std::ref(end_barrier),
 							 std::ref(asked_buffer_size),
 							 std::ref(asked_num_buffers),
-							 std::ref(original_filesize));
+							 std::ref(original_filesize),
+							 offload, trials);
 	}
 
 	// Join threads
@@ -14,9 +14,15 @@
 #include <doca_mmap.h>
 #include <doca_pe.h>
 
-#include "doca_consumer.hpp"
+#include "cpu_dispatch.hpp"
+#include "engine.hpp"
 #include "simple_barrier.hpp"
 #include "re2_pipe.hpp"
+#include "lz4_regex_pipe.hpp"
+#include "inflate_regex_pipe.hpp"
+#ifdef KAYON_WITH_VECTORSCAN
+#include "vectorscan_pipe.hpp"
+#endif
 
 #include <nlohmann/json.hpp>
 
@@ -104,13 +110,21 @@ void cpuWriteJson(const std::vector<std::string> times, const std::string filena
 // 	docaWriteJson(result_times, name);
 // }
 
-void cpu_regex_decompress_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier) {
-	// CPU init
-	Re2Pipe re2_pipe{"/dev/shm/cpu-regex"};
-	re2_pipe.init();
+// Input of all regex workers, each keeps only its share of the rows
+static const char* REGEX_INPUT = "/dev/shm/regex-input";
+
+// Runs one regex pipe over options.rows. Without regex hardware the
+// accelerator share runs through the same worker on its own thread
+// (device "dpu_sw"), so the split and the merge can be measured end to end.
+template <Engine Pipe, typename... PipeArgs>
+void regex_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, RegexScanOptions options,
+				  std::string json_name, std::vector<RegexQueryResult>& worker_results, PipeArgs... pipe_args) {
+	// init
+	Pipe regex_pipe{REGEX_INPUT, options, pipe_args...};
+	regex_pipe.init();
 
 	// log waiting state
-    std::cout << "CPU ready, waiting..." << std::endl;
+    std::cout << options.device << " ready, waiting..." << std::endl;
 
 	// wait for sync
 	start_barrier.arrive_and_wait();
@@ -119,56 +133,139 @@ void cpu_regex_decompress_worker(SimpleBarrier& start_barrier, SimpleBarrier& en
 	auto processing_start = std::chrono::steady_clock::now();
 
 	// log processing state
-    std::cerr << "CPU regex start processing..." << std::endl;
+    std::cerr << options.device << " regex start processing..." << std::endl;
 
 	// process data
-	re2_pipe.execute();
+	regex_pipe.execute();
 
-	// cpu finished its task
-	auto cpu_task_end = std::chrono::steady_clock::now();
+	// worker finished its task
+	auto task_end = std::chrono::steady_clock::now();
 
 	// log processing state
-	std::cerr << "CPU regex end processing!" << std::endl;
+	std::cerr << options.device << " regex end processing!" << std::endl;
 
 	// wait for sync
 	end_barrier.arrive_and_wait();
 
-	// both HW finished processing
+	// all workers finished processing
 	auto processing_end = std::chrono::steady_clock::now();
 
 	// log processing state
-	std::cerr << "CPU regex get results..." << std::endl;
+	std::cerr << options.device << " regex get results..." << std::endl;
 
-	re2_pipe.cleanup();
+	regex_pipe.cleanup();
+	worker_results = regex_pipe.results();
 
-	std::vector<std::string> results{calculateSeconds(cpu_task_end, processing_start), calculateSeconds(processing_end, processing_start)};
-	cpuWriteJson(results, "results-cpu-regex.json");
+	std::vector<std::string> results{calculateSeconds(task_end, processing_start), calculateSeconds(processing_end, processing_start)};
+	cpuWriteJson(results, json_name);
 }
 
 int main(int argc, char **argv) {
-	// Ensure we receive exactly two arguments
-    if (argc != 4) {
-        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> <original_filesize>" << std::endl;
+	// Ensure we receive the three positional arguments
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <percentage1> <percentage2> <original_filesize> [--engine re2|vectorscan] [--vectored] [--dict] [--prefilter] [--queries FILE] [--extract] [--cpu-threads N] [--re2-max-mem MIB] [--shared-re2] [--lz4-block KIB] [--inflate-chunk KIB]" << std::endl;
         return 1;
     }
 
+	// Optional flags after the positional arguments
+	RegexScanOptions options;
+	std::string engine = "re2";
+	int cpu_threads = 1;
+	bool shared_re2 = false;
+	size_t lz4_block = 0;
+	size_t inflate_chunk = 0;
+	for (int idx = 4; idx < argc; ++idx) {
+		std::string flag = argv[idx];
+		if (flag == "--engine" && idx + 1 < argc) {
+			engine = argv[++idx];
+		} else if (flag == "--cpu-threads" && idx + 1 < argc) {
+			cpu_threads = std::stoi(argv[++idx]);
+		} else if (flag == "--re2-max-mem" && idx + 1 < argc) {
+			options.re2_max_mem = std::stoll(argv[++idx]) << 20;
+		} else if (flag == "--lz4-block" && idx + 1 < argc) {
+			// fused LZ4 decompression and scan, block size in KiB
+			lz4_block = std::stoull(argv[++idx]) << 10;
+		} else if (flag == "--inflate-chunk" && idx + 1 < argc) {
+			// streaming inflate into the scan, chunk size in KiB
+			inflate_chunk = std::stoull(argv[++idx]) << 10;
+		} else if (flag == "--shared-re2") {
+			shared_re2 = true;
+		} else if (flag == "--queries" && idx + 1 < argc) {
+			options.query_file = argv[++idx];
+		} else if (flag == "--extract") {
+			options.extract = true;
+		} else if (flag == "--vectored") {
+			options.vectored = true;
+		} else if (flag == "--dict") {
+			options.dictionary_encode = true;
+		} else if (flag == "--prefilter") {
+			options.prefilter = true;
+		} else {
+			std::cerr << "Error: unknown option " << flag << std::endl;
+			return 1;
+		}
+	}
+
+	if (engine != "re2" && engine != "vectorscan") {
+		std::cerr << "Error: unknown engine " << engine << std::endl;
+		return 1;
+	}
+#ifndef KAYON_WITH_VECTORSCAN
+	if (engine == "vectorscan") {
+		std::cerr << "Error: built without vectorscan support" << std::endl;
+		return 1;
+	}
+#endif
+	if (options.extract && engine != "re2") {
+		std::cerr << "Error: --extract requires --engine re2 (vectorscan has no captures)" << std::endl;
+		return 1;
+	}
+	bool compressed_input = lz4_block > 0 || inflate_chunk > 0;
+	if (lz4_block > 0 && inflate_chunk > 0) {
+		std::cerr << "Error: --lz4-block and --inflate-chunk are exclusive" << std::endl;
+		return 1;
+	}
+	if (compressed_input && (engine != "re2" || options.dictionary_encode || options.extract)) {
+		std::cerr << "Error: --lz4-block and --inflate-chunk run RE2 on the decompressed lines, without --dict or --extract" << std::endl;
+		return 1;
+	}
+	if (options.vectored && engine != "vectorscan") {
+		std::cerr << "Error: --vectored requires --engine vectorscan" << std::endl;
+		return 1;
+	}
+
 	// Convert arguments to integers
     int percentage_cpu = std::stoi(argv[1]);
     int percentage_dpu = std::stoi(argv[2]);
-	int original_filesize = std::stoi(argv[3]);
+	// argv[3] (original_filesize) stays for the scripts, the pipes size the input themselves
 
     // Validate percentage range
     if (percentage_cpu < 0 || percentage_cpu > 100 || percentage_dpu < 0 || percentage_dpu > 100) {
         std::cerr << "Error: Percentages must be between 0 and 100." << std::endl;
         return 1;
     }
+	// The shares split the rows of one input, together they cover all of it
+	if (percentage_cpu + percentage_dpu != 100) {
+		std::cerr << "Error: Percentages must add up to 100." << std::endl;
+		return 1;
+	}
+	if (cpu_threads < 1) {
+		std::cerr << "Error: --cpu-threads must be at least 1." << std::endl;
+		return 1;
+	}
 
-	// how many threads to use
-	int THREAD_COUNT = 1;
-	if (percentage_cpu == 0 || percentage_dpu == 0) {
-		THREAD_COUNT = 1;
+	// A gzip/zlib input is one stream, it can not be split between workers
+	if (inflate_chunk > 0 && (percentage_cpu != 100 || cpu_threads > 1) && InflateRegexPipe::isCompressedFile(REGEX_INPUT)) {
+		std::cerr << "Error: a compressed input can not be split, use 100 0 and one CPU thread" << std::endl;
+		return 1;
 	}
 
+	// ISA variants the hot kernels picked on this CPU
+	std::cout << "CPU: " << cpuFeaturesString() << " (prefilter " << LiteralPrefilter::kernelName() << ")" << std::endl;
+
+	// how many threads to use
+	int THREAD_COUNT = (percentage_cpu > 0 ? cpu_threads : 0) + (percentage_dpu > 0 ? 1 : 0);
+
 	// create sync barriers
 	SimpleBarrier start_barrier(THREAD_COUNT);
 	SimpleBarrier end_barrier(THREAD_COUNT);
@@ -177,19 +274,69 @@ int main(int argc, char **argv) {
 	std::vector<std::thread> threads;
 	threads.reserve(THREAD_COUNT);
 	
-	// Decompress LZ4 co-processing
-	// if (percentage_cpu > 0) {
-	// 	threads.emplace_back(cpu_regex_decompress_worker, std::ref(start_barrier), std::ref(end_barrier));
-	// }
-	threads.emplace_back(cpu_regex_decompress_worker, std::ref(start_barrier), std::ref(end_barrier));
-	
-	// if (percentage_dpu > 0) {
-	// 	threads.emplace_back(doca_regex_worker, std::ref(start_barrier), 
-	// 						 std::ref(end_barrier),
-	// 						 std::ref(asked_buffer_size),
-	// 						 std::ref(asked_num_buffers),
-	// 						 std::ref(original_filesize));
-	// }
+	auto queries = options.query_file.empty() ? defaultRegexQueries() : loadRegexQueries(options.query_file);
+
+	// Parse the CSV once, each worker copies its share of the rows (the
+	// compressed inputs of --lz4-block and --inflate-chunk are read per pipe)
+	if (lz4_block == 0 && inflate_chunk == 0) {
+		options.shared_columns = std::make_shared<const std::vector<CsvColumn>>(loadCsvColumns(REGEX_INPUT, queries));
+	}
+
+	// One compiled set for all workers instead of per-thread copies (contention baseline)
+	if (shared_re2 && engine == "re2") {
+		std::vector<std::string> patterns;
+		for (const auto& query : queries) {
+			patterns.push_back(query.pattern);
+		}
+		options.shared_re2 = Re2Pipe::compile(patterns, options);
+	}
+
+	// per-worker results, merged after the join
+	std::vector<std::vector<RegexQueryResult>> worker_results(THREAD_COUNT);
+	auto spawn = [&](const RegexScanOptions& worker_options, const std::string& json_name) {
+		auto& results = worker_results[threads.size()];
+#ifdef KAYON_WITH_VECTORSCAN
+		if (engine == "vectorscan") {
+			threads.emplace_back(regex_worker<VectorscanPipe>, std::ref(start_barrier), std::ref(end_barrier),
+								 worker_options, json_name, std::ref(results));
+			return;
+		}
+#endif
+		if (lz4_block > 0) {
+			threads.emplace_back(regex_worker<Lz4RegexPipe, size_t>, std::ref(start_barrier), std::ref(end_barrier),
+								 worker_options, json_name, std::ref(results), lz4_block);
+			return;
+		}
+		if (inflate_chunk > 0) {
+			threads.emplace_back(regex_worker<InflateRegexPipe, size_t>, std::ref(start_barrier), std::ref(end_barrier),
+								 worker_options, json_name, std::ref(results), inflate_chunk);
+			return;
+		}
+		threads.emplace_back(regex_worker<Re2Pipe>, std::ref(start_barrier), std::ref(end_barrier),
+							 worker_options, json_name, std::ref(results));
+	};
+
+	// CPU share: the first rows, split evenly between the CPU workers
+	double cpu_end = percentage_cpu / 100.0;
+	if (percentage_cpu > 0) {
+		for (int worker = 0; worker < cpu_threads; ++worker) {
+			RegexScanOptions worker_options = options;
+			worker_options.rows.begin = cpu_end * worker / cpu_threads;
+			worker_options.rows.end = worker + 1 == cpu_threads ? cpu_end : cpu_end * (worker + 1) / cpu_threads;
+			worker_options.device = "cpu";
+			spawn(worker_options, cpu_threads == 1 ? "results-cpu-regex.json"
+												   : "results-cpu-regex-" + std::to_string(worker) + ".json");
+		}
+	}
+
+	// Accelerator share: the remaining rows (no regex engine on BF3, software stand-in)
+	if (percentage_dpu > 0) {
+		RegexScanOptions worker_options = options;
+		worker_options.rows.begin = cpu_end;
+		worker_options.rows.end = 1.0;
+		worker_options.device = "dpu_sw";
+		spawn(worker_options, "results-doca-regex.json");
+	}
 
 	// Join threads
     for (auto& t : threads) {
@@ -198,5 +345,8 @@ int main(int argc, char **argv) {
 
 	std::cout << "Both threads done" << std::endl;
 
+	// Disjoint row ranges: the merged matches equal a single-worker run
+	printRegexReport("merged", mergeRegexResults(worker_results));
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#ifndef KAYON_ADAPTIVE_CODEC_HPP
+#define KAYON_ADAPTIVE_CODEC_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "chunk_container.hpp"
+#include "compressibility.hpp"
+#include "engine.hpp"
+
+// Device that will decompress the container. BF3 decompresses LZ4 blocks and
+// deflate, BF2 only deflate, the host both in software.
+enum class DecodeTarget { HOST, BF2, BF3 };
+
+bool parseDecodeTarget(const std::string &name, DecodeTarget &target);
+
+// Trade-off of the per-chunk choice
+struct CodecBudget {
+    // take LZ4 unless deflate output is smaller by more than this fraction
+    double max_ratio_loss = 0.10;
+    // host compress MiB/s a codec must reach on the sample, 0 for no limit
+    double target_mib_s = 0.0;
+    DecodeTarget target = DecodeTarget::HOST;
+};
+
+// Choice for one chunk and the sample trials behind it (ratios are output / input)
+struct CodecChoice {
+    ChunkCodec codec;
+    double lz4_ratio;
+    double deflate_ratio;
+    double lz4_mib_s;
+    double deflate_mib_s;
+};
+
+// Picks LZ4 (fast) or deflate (dense) per chunk: both codecs run on the
+// windows the estimator samples, which gives their ratio and host speed on
+// this data. Incompressible chunks are stored. A BF2 target only gets
+// deflate or stored chunks, it has no LZ4 decompression in hardware.
+struct CodecSelector {
+    CompressibilityEstimator estimator;
+    CodecBudget budget;
+
+    CodecChoice choose(const uint8_t *data, size_t len) const;
+};
+
+// Engine (engine.hpp) that compresses a file into a chunk container (chunk_container.hpp),
+// each chunk with the codec the selector picks for it
+class AdaptiveCompressEngine {
+    public:
+        AdaptiveCompressEngine(const std::string &input_file, const std::string &output_file,
+                               size_t chunk_size, CodecSelector selector = {});
+
+        void init();
+        void execute();
+        void cleanup();
+
+        std::string getName() { return "cpu-compress-adaptive"; }
+
+        // after execute
+        size_t chunks(ChunkCodec codec) const { return chunk_counts_[static_cast<size_t>(codec)]; }
+        size_t inputBytes() const { return input_.size(); }
+        size_t outputBytes() const { return output_.size(); }
+        // decode the container on the host and compare it with the input, after execute
+        bool verify() const;
+
+    private:
+        std::string input_file_;
+        std::string output_file_;
+        size_t chunk_size_;
+        CodecSelector selector_;
+
+        std::vector<uint8_t> input_;
+        std::vector<uint8_t> output_;
+        std::vector<uint8_t> scratch_;
+        std::array<size_t, 3> chunk_counts_{};
+};
+
+static_assert(NamedEngine<AdaptiveCompressEngine>);
+
+#endif // KAYON_ADAPTIVE_CODEC_HPP
@@ -0,0 +1,43 @@
+#ifndef KAYON_CAPTURE_COLUMNS_HPP
+#define KAYON_CAPTURE_COLUMNS_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Columnar output of the capture groups of one query. Every group is an
+// offsets + bytes pair (Arrow string layout): value i of a group is
+// bytes[offsets[i], offsets[i + 1]). Rows are staged as views into the
+// scanned lines and copied one group at a time per batch.
+class CaptureColumns {
+public:
+    explicit CaptureColumns(size_t num_groups = 0, size_t batch_rows = 4096);
+
+    // Stage the groups of one matching row, the views must stay valid until
+    // the next flush. Flushes when the batch is full.
+    void append(const std::string_view* groups);
+
+    // Copy the staged rows into the columns.
+    void flush();
+
+    // Drop all rows, keeps the allocations.
+    void clear();
+
+    size_t numGroups() const { return offsets_.size(); }
+    size_t numRows() const { return rows_; }
+    // bytes of all groups, flushed rows only
+    size_t bytes() const;
+
+    const std::vector<uint64_t>& offsets(size_t group) const { return offsets_[group]; }
+    const std::string& data(size_t group) const { return bytes_[group]; }
+
+private:
+    size_t batch_rows_;
+    size_t rows_ = 0;
+    std::vector<std::vector<uint64_t>> offsets_;
+    std::vector<std::string> bytes_;
+    std::vector<std::string_view> staged_; // row-major, num_groups per row
+};
+
+#endif // KAYON_CAPTURE_COLUMNS_HPP
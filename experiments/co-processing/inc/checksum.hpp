@@ -0,0 +1,88 @@
+#ifndef KAYON_CHECKSUM_HPP
+#define KAYON_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "codec_task.hpp"
+
+// Checksums of the uncompressed data, as the DOCA compress tasks report them.
+// Each kernel picks its fastest variant for the CPU at first use: CRC32 folds
+// with PCLMULQDQ (x86) or uses the ARMv8 CRC instructions, Adler32 uses SSSE3,
+// all of them fall back to portable code. Values match zlib's crc32/adler32
+// and the reference xxHash32, seeds continue a running checksum.
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len);
+uint32_t adler32Update(uint32_t adler, const uint8_t *data, size_t len);
+uint32_t xxhash32(const uint8_t *data, size_t len, uint32_t seed = 0);
+
+// Variants picked on this CPU, e.g. "crc32=pclmul adler32=ssse3"
+std::string checksumKernels();
+
+// Checksum of A then B from the checksums of A and B and the length of B
+uint32_t crc32Combine(uint32_t crc_a, uint32_t crc_b, size_t len_b);
+uint32_t adler32Combine(uint32_t adler_a, uint32_t adler_b, size_t len_b);
+
+// 64-bit checksum in the layout of the DOCA samples and decompressor-preparer.py:
+// Adler32 in the upper 32 bits, CRC32 in the lower ones
+inline uint64_t docaChecksum(uint32_t crc, uint32_t adler) {
+    return (static_cast<uint64_t>(adler) << 32) | crc;
+}
+
+// Second checksum next to the CRC: Adler32 for the deflate tasks, xxHash32 for LZ4
+enum class ChecksumKind : uint8_t { ADLER32, XXHASH32 };
+
+constexpr ChecksumKind checksumKind(TaskCodec codec) {
+    return codec == TaskCodec::LZ4_BLOCK_DECOMPRESS ? ChecksumKind::XXHASH32 : ChecksumKind::ADLER32;
+}
+
+// Host checksums of one chunk, crc32 and the codec's second checksum
+struct ChunkChecksum {
+    uint32_t crc;
+    uint32_t second;
+};
+
+ChunkChecksum chunkChecksum(ChecksumKind kind, const uint8_t *plain, size_t len);
+
+#define CHECKSUM_KEYS "checksum_verified", "checksum_mismatched", "stream_checksum"
+
+// Checks the checksums a device reports per chunk against the uncompressed
+// data the host holds anyway (the input of a compress, the output of a
+// decompress), so nothing is decompressed twice. The chunk checksums are
+// combined into the checksum of the whole stream, comparable with the one
+// of the file. Chunks done on the host are only combined.
+class ChecksumVerifier {
+    public:
+        void setEnabled(bool enabled) { enabled_ = enabled; }
+        bool enabled() const { return enabled_; }
+
+        // before a run of num_chunks chunks
+        void reset(size_t num_chunks, ChecksumKind kind);
+
+        // a device chunk, false if its checksums do not match the data
+        bool verify(size_t chunk, ChunkChecksum device, const uint8_t *plain, size_t len);
+        // a chunk done on the host, no device checksums to check
+        void record(size_t chunk, const uint8_t *plain, size_t len);
+
+        size_t verified() const { return verified_; }
+        size_t mismatched() const { return mismatched_; }
+
+        // stream checksum of all chunks in order (docaChecksum for Adler32, the
+        // CRC alone for xxHash32, which does not combine), 0 if a chunk is missing
+        uint64_t streamChecksum() const;
+
+        // results JSON values, in the order of CHECKSUM_KEYS
+        std::vector<std::string> toStrings() const;
+
+    private:
+        bool enabled_ = false;
+        ChecksumKind kind_ = ChecksumKind::ADLER32;
+        std::vector<ChunkChecksum> chunks_;
+        std::vector<size_t> lengths_;
+        std::vector<bool> seen_;
+        size_t verified_ = 0;
+        size_t mismatched_ = 0;
+};
+
+#endif // KAYON_CHECKSUM_HPP
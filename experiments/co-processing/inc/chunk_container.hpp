@@ -0,0 +1,47 @@
+#ifndef KAYON_CHUNK_CONTAINER_HPP
+#define KAYON_CHUNK_CONTAINER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Codec of one chunk in a container, the payload is what the matching DOCA
+// decompress task reads (raw deflate, LZ4 block), or the plain bytes
+enum class ChunkCodec : uint8_t { STORED = 0, DEFLATE = 1, LZ4 = 2 };
+
+const char *chunkCodecName(ChunkCodec codec);
+
+// Container of independently compressed chunks, little endian:
+//
+//   file header  "KCC1", u32 chunk size, u64 chunk count
+//   per chunk    u8 codec, 3 reserved bytes, u32 plain length, u32 payload length, payload
+//
+// Every chunk names its own codec, so a reader dispatches each one to the
+// engine that supports it.
+static const char CHUNK_CONTAINER_MAGIC[4] = {'K', 'C', 'C', '1'};
+static const size_t CHUNK_CONTAINER_HEADER_SIZE = 16;
+static const size_t CHUNK_HEADER_SIZE = 12;
+
+// One chunk of a parsed container, payload points into the container bytes
+struct ChunkView {
+    ChunkCodec codec;
+    uint32_t plain_len;
+    const uint8_t *payload;
+    uint32_t payload_len;
+};
+
+// Header of a container of chunk_count chunks of up to chunk_size bytes
+void writeContainerHeader(std::vector<uint8_t> &out, uint32_t chunk_size, uint64_t chunk_count);
+
+// Append one chunk (header and payload)
+void appendChunk(std::vector<uint8_t> &out, ChunkCodec codec, uint32_t plain_len, const uint8_t *payload,
+                 uint32_t payload_len);
+
+// Split a container into its chunks, false if it is truncated or not a container
+bool parseContainer(const uint8_t *data, size_t len, std::vector<ChunkView> &chunks);
+
+// Decode every chunk on the host, false on a corrupt chunk
+bool decodeContainer(const uint8_t *data, size_t len, std::vector<uint8_t> &plain);
+
+#endif // KAYON_CHUNK_CONTAINER_HPP
@@ -0,0 +1,106 @@
+#ifndef KAYON_CHUNK_RETRY_HPP
+#define KAYON_CHUNK_RETRY_HPP
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "codec_task.hpp"
+#include "sw_task_executor.hpp"
+
+// Engine that produced a chunk of the output, NONE if it is missing
+enum class ChunkEngine : uint8_t { NONE, OFFLOAD, CPU_RETRY, STORED };
+
+// What happens to chunks the offload engine fails or does not finish
+struct RetryPolicy {
+    bool enabled = true;
+    size_t threads = 1;
+    // give up on the offload engine after this long without a completion, 0 waits forever
+    double task_timeout_ms = 0.0;
+};
+
+struct RetryCounters {
+    size_t offload_failed = 0;
+    size_t offload_timed_out = 0;
+    size_t cpu_retried = 0;
+    size_t cpu_retry_failed = 0;
+    // incompressible chunks written as stored blocks, never offloaded
+    size_t stored_bypass = 0;
+
+    // results JSON values, in the order of RETRY_COUNTER_KEYS
+    std::vector<std::string> toStrings() const;
+};
+
+#define RETRY_COUNTER_KEYS "offload_failed", "offload_timed_out", "cpu_retried", "cpu_retry_failed", "stored_bypass"
+
+// Called with the chunk id, output data and length of a chunk the host redid
+using retry_done_handler = std::function<void(size_t, const uint8_t*, size_t)>;
+
+// Host retry of the chunks of one batch: a failed or timed-out chunk is
+// requeued to a small SwTaskExecutor pool and rerun into its own buffer,
+// sized for the worst case, so a device limit on one chunk (output larger
+// than the destination on incompressible data) does not leave a hole in the
+// output. Runs on the polling thread of the consumer, as its callbacks.
+class ChunkRetrier {
+    public:
+        explicit ChunkRetrier(TaskCodec codec);
+        ~ChunkRetrier();
+
+        void setPolicy(RetryPolicy policy) { policy_ = policy; }
+        const RetryPolicy &policy() const { return policy_; }
+
+        // new batch of num_chunks chunks, all missing
+        void reset(size_t num_chunks);
+
+        // the offload engine finished chunk id, false if it was given up on already
+        bool offloaded(size_t id);
+
+        // the offload engine failed chunk id (or timed out), rerun it on the host
+        void retry(size_t id, const uint8_t *src, size_t src_len, size_t dst_cap, bool timed_out);
+
+        // write chunk id as deflate stored blocks right away, for chunks not worth compressing
+        void store(size_t id, const uint8_t *src, size_t src_len);
+
+        // chunks neither finished nor requeued yet
+        std::vector<size_t> missing() const;
+
+        // submit requeued chunks and run the callbacks of finished ones
+        void progress();
+
+        // nothing waiting or running on the host
+        bool idle() const { return queued_.empty() && running_ == 0; }
+
+        void setDoneHandler(retry_done_handler handler) { done_handler_ = std::move(handler); }
+
+        // finish running retries (their callbacks run) and join the pool
+        void stop();
+
+        const std::vector<ChunkEngine> &engines() const { return engines_; }
+        const RetryCounters &counters() const { return counters_; }
+        double workerCpuSeconds() const;
+
+    private:
+        static void retryCompleted(SwTask *task, void *ctx_user_data);
+        static void retryFailed(SwTask *task, void *ctx_user_data);
+
+        TaskCodec codec_;
+        RetryPolicy policy_;
+        std::unique_ptr<SwTaskExecutor> executor_;
+        double worker_cpu_seconds_ = 0.0;
+
+        std::vector<ChunkEngine> engines_;
+        std::vector<bool> requeued_;
+        // host buffers (retries and stored chunks) and tasks, by chunk id
+        std::vector<std::vector<uint8_t>> buffers_;
+        std::vector<SwTask> tasks_;
+        std::deque<size_t> queued_;
+        size_t running_ = 0;
+
+        retry_done_handler done_handler_;
+        RetryCounters counters_;
+};
+
+#endif // KAYON_CHUNK_RETRY_HPP
@@ -0,0 +1,47 @@
+#ifndef KAYON_CODEC_TASK_HPP
+#define KAYON_CODEC_TASK_HPP
+
+// Codec an offloaded task runs, on the accelerator or in SwTaskExecutor
+enum class TaskCodec { DEFLATE, INFLATE, LZ4_BLOCK_DECOMPRESS };
+
+// Offloaded task types, independent of DOCA: result names, /dev/shm files,
+// codec and buffer layout.
+// split_input: the input file is cut into max-sized buffers and the output
+// buffers mirror them (compress), else the caller gives the number and size
+// of the input buffers of an already blocked file (decompress).
+// skip_dpu0: leave the first DPU of the test machine to other experiments.
+// log_init_steps: print each init step of the DOCA context (step 1 always).
+struct CompressDeflateTask {
+    static constexpr const char *name = "doca-compress";
+    static constexpr const char *sw_name = "sw-compress";
+    static constexpr const char *input_path = "/dev/shm/input.deflate";
+    static constexpr const char *output_path = "/dev/shm/out-comp.deflate";
+    static constexpr TaskCodec codec = TaskCodec::DEFLATE;
+    static constexpr bool split_input = true;
+    static constexpr bool skip_dpu0 = false;
+    static constexpr bool log_init_steps = false;
+};
+
+struct DecompressDeflateTask {
+    static constexpr const char *name = "doca-decompress-deflate";
+    static constexpr const char *sw_name = "sw-decompress-deflate";
+    static constexpr const char *input_path = "/dev/shm/input-comp.deflate";
+    static constexpr const char *output_path = "/dev/shm/out-decomp.deflate";
+    static constexpr TaskCodec codec = TaskCodec::INFLATE;
+    static constexpr bool split_input = false;
+    static constexpr bool skip_dpu0 = true;
+    static constexpr bool log_init_steps = true;
+};
+
+struct DecompressLz4Task {
+    static constexpr const char *name = "doca-decompress-lz4";
+    static constexpr const char *sw_name = "sw-decompress-lz4";
+    static constexpr const char *input_path = "/dev/shm/input-comp.lz4";
+    static constexpr const char *output_path = "/dev/shm/out-decomp.lz4";
+    static constexpr TaskCodec codec = TaskCodec::LZ4_BLOCK_DECOMPRESS;
+    static constexpr bool split_input = false;
+    static constexpr bool skip_dpu0 = true;
+    static constexpr bool log_init_steps = true;
+};
+
+#endif // KAYON_CODEC_TASK_HPP
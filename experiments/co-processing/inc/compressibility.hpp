@@ -0,0 +1,47 @@
+#ifndef KAYON_COMPRESSIBILITY_HPP
+#define KAYON_COMPRESSIBILITY_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Sampled compressibility of one chunk
+struct CompressibilityEstimate {
+    // Shannon entropy of the sampled bytes, bits per byte (8 is random)
+    double entropy_bits;
+    // LZ4 output / input of the sampled windows, 1 if the trial was skipped
+    double lz4_ratio;
+    bool incompressible;
+};
+
+// Cheap pre-check of a chunk before it goes to a compression engine: a byte
+// histogram over sampled windows and, if that looks random, an LZ4 trial on
+// the same windows. Entropy near 8 bits leaves Huffman nothing to save and a
+// failed LZ4 trial means no matches, both together mark the chunk as not
+// worth compressing. Deflate would only expand it (and overflow a device
+// destination sized like the input).
+struct CompressibilityEstimator {
+    bool enabled = true;
+    // bytes looked at per chunk, in windows spread over it
+    size_t sample_bytes = 64 * 1024;
+    size_t window_bytes = 4096;
+    // incompressible if entropy is at least this and LZ4 saves less than min_lz4_saving
+    double max_entropy_bits = 7.8;
+    double min_lz4_saving = 0.03;
+
+    CompressibilityEstimate estimate(const uint8_t *data, size_t len) const;
+    bool incompressible(const uint8_t *data, size_t len) const { return enabled && estimate(data, len).incompressible; }
+};
+
+// Raw deflate of stored blocks (RFC 1951 BTYPE 00), written without
+// compressing. Bytes needed for len input bytes
+size_t storedDeflateSize(size_t len);
+// Write the stored stream of src into dst, bytes written, 0 if dst is too small
+size_t writeStoredDeflate(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_cap);
+
+// LZ4 block of one literal run and no match, LZ4_decompress_safe reads it back.
+// Bytes needed for len input bytes
+size_t lz4LiteralsSize(size_t len);
+// Write the literal block of src into dst, bytes written, 0 if dst is too small
+size_t writeLz4Literals(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_cap);
+
+#endif // KAYON_COMPRESSIBILITY_HPP
@@ -0,0 +1,156 @@
+#ifndef KAYON_CPU_CODEC_ENGINE_HPP
+#define KAYON_CPU_CODEC_ENGINE_HPP
+
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+
+#include "engine.hpp"
+#include "libdeflate_pipe.hpp"
+#include "lz4_pipe.hpp"
+#include "zpipe.hpp"
+#include "zstd_pipe.hpp"
+
+// Codec traits: which Zpipe/LZ4Pipe calls make up one direction. All of them
+// return 0 (Z_OK) on success. Every direction starts from the plain input, the
+// decompress ones prepare their compressed input in init.
+struct ZlibDeflateTraits {
+    using codec_type = Zpipe;
+    static constexpr const char* name = "cpu-deflate";
+    static int init(Zpipe& codec, const std::string& in, const std::string& out) { return codec.deflate_init(in, out); }
+    static int execute(Zpipe& codec) { return codec.deflate_execute_single_buffer(); }
+    static void cleanup(Zpipe& codec) { codec.deflate_cleanup(); }
+};
+
+struct ZlibInflateTraits {
+    using codec_type = Zpipe;
+    static constexpr const char* name = "cpu-inflate";
+    // deflate the plain input next to it first (not measured)
+    static int init(Zpipe& codec, const std::string& in, const std::string& out) {
+        const std::string compressed = in + "-input";
+        int ret = codec.deflate_init(in, compressed);
+        if (ret == 0) {
+            ret = codec.deflate_execute_single_buffer();
+            codec.deflate_cleanup();
+        }
+        return ret != 0 ? ret : codec.inflate_init(compressed, out);
+    }
+    static int execute(Zpipe& codec) { return codec.inflate_execute_single_buffer(); }
+    static void cleanup(Zpipe& codec) { codec.inflate_cleanup(); }
+};
+
+// Whole-buffer raw deflate, the level is the LibdeflatePipe constructor argument
+struct LibdeflateDeflateTraits {
+    using codec_type = LibdeflatePipe;
+    static constexpr const char* name = "cpu-libdeflate";
+    static int init(LibdeflatePipe& codec, const std::string& in, const std::string& out) { return codec.deflate_init(in, out); }
+    static int execute(LibdeflatePipe& codec) { return codec.deflate_execute(); }
+    static void cleanup(LibdeflatePipe& codec) { codec.deflate_cleanup(); }
+};
+
+struct LibdeflateInflateTraits {
+    using codec_type = LibdeflatePipe;
+    static constexpr const char* name = "cpu-libinflate";
+    // raw deflate the plain input next to it first (not measured); the
+    // decompressed size is known, as for the DOCA tasks
+    static int init(LibdeflatePipe& codec, const std::string& in, const std::string& out) {
+        const std::string compressed = in + "-input-raw";
+        int ret = codec.deflate_init(in, compressed);
+        if (ret == 0) {
+            ret = codec.deflate_execute();
+            codec.deflate_cleanup();
+        }
+        if (ret != 0) {
+            return ret;
+        }
+        std::error_code size_error;
+        size_t original_size = std::filesystem::file_size(in, size_error);
+        return codec.inflate_init(compressed, out, size_error ? 0 : original_size);
+    }
+    static int execute(LibdeflatePipe& codec) { return codec.inflate_execute(); }
+    static void cleanup(LibdeflatePipe& codec) { codec.inflate_cleanup(); }
+};
+
+struct Lz4CompressTraits {
+    using codec_type = LZ4Pipe;
+    static constexpr const char* name = "cpu-compress-lz4";
+    static int init(LZ4Pipe& codec, const std::string& in, const std::string& out) { return codec.compress_init(in, out); }
+    static int execute(LZ4Pipe& codec) { return codec.compress_execute(); }
+    static void cleanup(LZ4Pipe& codec) { codec.compress_cleanup(); }
+};
+
+// LZ4Pipe compresses the input in memory in init, execute only decompresses
+struct Lz4DecompressTraits {
+    using codec_type = LZ4Pipe;
+    static constexpr const char* name = "cpu-decompress-lz4";
+    static int init(LZ4Pipe& codec, const std::string& in, const std::string& out) { return codec.decompress_init(in, out); }
+    static int execute(LZ4Pipe& codec) { return codec.decompress_execute(); }
+    static void cleanup(LZ4Pipe& codec) { codec.decompress_cleanup(); }
+};
+
+struct ZstdCompressTraits {
+    using codec_type = ZstdPipe;
+    static constexpr const char* name = "cpu-compress-zstd";
+    static int init(ZstdPipe& codec, const std::string& in, const std::string& out) { return codec.compress_init(in, out); }
+    static int execute(ZstdPipe& codec) { return codec.compress_execute(); }
+    static void cleanup(ZstdPipe& codec) { codec.compress_cleanup(); }
+};
+
+// ZstdPipe compresses the input in memory in init, execute only decompresses
+struct ZstdDecompressTraits {
+    using codec_type = ZstdPipe;
+    static constexpr const char* name = "cpu-decompress-zstd";
+    static int init(ZstdPipe& codec, const std::string& in, const std::string& out) { return codec.decompress_init(in, out); }
+    static int execute(ZstdPipe& codec) { return codec.decompress_execute(); }
+    static void cleanup(ZstdPipe& codec) { codec.decompress_cleanup(); }
+};
+
+// Engine over one direction of a CPU codec, file to file.
+template <typename Traits>
+class CpuCodecEngine {
+public:
+    // codec_args are passed on to the codec's constructor
+    template <typename... CodecArgs>
+    CpuCodecEngine(const std::string& input_file, const std::string& output_file, CodecArgs... codec_args)
+        : codec_(codec_args...), input_file_(input_file), output_file_(output_file) {}
+
+    void init() {
+        if (int ret = Traits::init(codec_, input_file_, output_file_); ret != 0) {
+            throw std::runtime_error(std::string("Failed init ") + Traits::name + " of " + input_file_ + " (" +
+                                     std::to_string(ret) + ")");
+        }
+    }
+
+    void execute() {
+        if (int ret = Traits::execute(codec_); ret != 0) {
+            throw std::runtime_error(std::string("Failed exec ") + Traits::name + " (" + std::to_string(ret) + ")");
+        }
+    }
+
+    void cleanup() { Traits::cleanup(codec_); }
+
+    std::string getName() { return Traits::name; }
+
+    typename Traits::codec_type& codec() { return codec_; }
+
+private:
+    typename Traits::codec_type codec_;
+    std::string input_file_;
+    std::string output_file_;
+};
+
+using DeflateEngine = CpuCodecEngine<ZlibDeflateTraits>;
+using InflateEngine = CpuCodecEngine<ZlibInflateTraits>;
+using LibdeflateEngine = CpuCodecEngine<LibdeflateDeflateTraits>;
+using LibinflateEngine = CpuCodecEngine<LibdeflateInflateTraits>;
+using Lz4CompressEngine = CpuCodecEngine<Lz4CompressTraits>;
+using Lz4DecompressEngine = CpuCodecEngine<Lz4DecompressTraits>;
+using ZstdCompressEngine = CpuCodecEngine<ZstdCompressTraits>;
+using ZstdDecompressEngine = CpuCodecEngine<ZstdDecompressTraits>;
+
+static_assert(NamedEngine<DeflateEngine> && NamedEngine<InflateEngine>);
+static_assert(NamedEngine<LibdeflateEngine> && NamedEngine<LibinflateEngine>);
+static_assert(NamedEngine<Lz4CompressEngine> && NamedEngine<Lz4DecompressEngine>);
+static_assert(NamedEngine<ZstdCompressEngine> && NamedEngine<ZstdDecompressEngine>);
+
+#endif // KAYON_CPU_CODEC_ENGINE_HPP
@@ -0,0 +1,116 @@
+#ifndef KAYON_CPU_CODEC_WORKER_HPP
+#define KAYON_CPU_CODEC_WORKER_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "engine.hpp"
+#include "simple_barrier.hpp"
+#include "trial_stats.hpp"
+
+// Pin the calling thread to core and print its TID under name
+void pin_and_expose(const char* name, int core);
+
+// CPU time of the calling thread, of the whole process
+double thread_cpu_seconds();
+double process_cpu_seconds();
+
+// end - start in seconds, fixed with 8 decimals
+std::string calculateSeconds(const std::chrono::steady_clock::time_point end,
+                             const std::chrono::steady_clock::time_point start);
+
+// Result keys of the CPU share, in the order of their values
+extern const std::vector<std::string> CPU_RESULT_KEYS;
+
+void cpuWriteJson(const std::vector<std::string> times, const std::string filename,
+                  const TrialRecorder& trials = TrialRecorder());
+
+// Values of one CPU run, in the order of the cpuWriteJson keys
+std::vector<std::string> cpuResults(std::chrono::steady_clock::time_point start,
+                                    std::chrono::steady_clock::time_point task_end,
+                                    std::chrono::steady_clock::time_point end, double cpu_seconds);
+
+// How a CPU codec worker logs and reports its run
+struct CpuWorkerConfig {
+    std::string label;          // log prefix, e.g. "CPU dflt"
+    std::string json_name;      // results file
+    bool process_time = false;  // the codec runs its own threads, count the CPU time of the process
+};
+
+// CPU share of the codec drivers, written once for every engine: E is built
+// from args on the pinned core and initialized (not measured), each trial
+// runs one execute() between the barriers, then cleanup and the results JSON.
+template <NamedEngine E, typename... Args>
+void cpu_codec_worker(SimpleBarrier& start_barrier, SimpleBarrier& end_barrier, CpuWorkerConfig config,
+                      TrialOptions trials, Args... args) {
+    // pin thread to specific core
+    pin_and_expose("CPU", 3);  // pick any isolated core
+
+    // CPU init
+    E engine(args...);
+    bool ready = true;
+    try {
+        engine.init();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        ready = false;
+    }
+
+    // log waiting state
+    std::cout << config.label << " ready, waiting..." << std::endl;
+
+    auto cpu_seconds = [&config] { return config.process_time ? process_cpu_seconds() : thread_cpu_seconds(); };
+    TrialRecorder recorder(trials);
+    auto results = runTrials(trials, recorder, [&] {
+        // wait for sync
+        start_barrier.arrive_and_wait();
+
+        // log cpu-time start
+        double cpu_time_start = cpu_seconds();
+
+        // entered processing
+        auto processing_start = std::chrono::steady_clock::now();
+
+        // log processing state
+        std::cout << config.label << " start processing..." << std::endl;
+
+        // process data
+        if (ready) {
+            try {
+                engine.execute();
+            } catch (const std::exception& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+            }
+        }
+
+        // cpu finished its task
+        auto cpu_task_end = std::chrono::steady_clock::now();
+
+        // log cpu-time end
+        double cpu_time_end = cpu_seconds();
+
+        // log processing state
+        std::cout << config.label << " end processing!" << std::endl;
+
+        // wait for sync
+        end_barrier.arrive_and_wait();
+
+        // both HW finished processing
+        auto processing_end = std::chrono::steady_clock::now();
+        return cpuResults(processing_start, cpu_task_end, processing_end, cpu_time_end - cpu_time_start);
+    });
+
+    // log processing state
+    std::cout << config.label << " get results..." << std::endl;
+
+    engine.cleanup();
+
+    cpuWriteJson(results, config.json_name, recorder);
+    printf("[CPU] user+sys = %s s\n", results[1].c_str());
+}
+
+#endif // KAYON_CPU_CODEC_WORKER_HPP
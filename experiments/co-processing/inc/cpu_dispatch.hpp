@@ -0,0 +1,26 @@
+#ifndef KAYON_CPU_DISPATCH_HPP
+#define KAYON_CPU_DISPATCH_HPP
+
+#include <string>
+
+// ISA extensions of the running CPU, detected once. The build targets a
+// portable baseline (see CMakeLists.txt), hot kernels carry variants for
+// these extensions (target attributes) and pick one at first use, so one
+// binary runs on BF2 (A72) and BF3 (A78) cores or any x86-64-v2 host.
+struct CpuFeatures {
+    // x86
+    bool ssse3 = false;
+    bool sse41 = false;
+    bool pclmul = false;
+    bool avx2 = false;
+    // aarch64
+    bool arm_crc32 = false;
+    bool arm_pmull = false;
+};
+
+const CpuFeatures &cpuFeatures();
+
+// Detected extensions for the logs, e.g. "x86-64 ssse3 sse4.1 pclmul avx2"
+std::string cpuFeaturesString();
+
+#endif // KAYON_CPU_DISPATCH_HPP
@@ -0,0 +1,39 @@
+#ifndef KAYON_DICT_COLUMN_HPP
+#define KAYON_DICT_COLUMN_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Dictionary-encoded string column: every distinct value is kept once and
+// each row refers to it through an integer code.
+class DictColumn {
+public:
+    // Encode the given rows; the input strings are moved into the dictionary.
+    static DictColumn encode(std::vector<std::string>& rows);
+
+    // Expand a per-distinct-value result to a per-row result through the codes.
+    void expand(const std::vector<uint8_t>& per_value, std::vector<uint8_t>& per_row) const;
+
+    // Count rows whose distinct value is set in per_value.
+    size_t countRows(const std::vector<uint8_t>& per_value) const;
+
+    // rows / distinct values, 1.0 means no repetition
+    double dedupRatio() const;
+
+    size_t numRows() const { return codes_.size(); }
+    size_t numValues() const { return values_.size(); }
+    size_t rowBytes() const { return row_bytes_; }
+    size_t valueBytes() const { return value_bytes_; }
+
+    const std::vector<std::string>& values() const { return values_; }
+    const std::vector<uint32_t>& codes() const { return codes_; }
+
+private:
+    std::vector<std::string> values_; // distinct values, in first-seen order
+    std::vector<uint32_t> codes_;     // one code per row, index into values_
+    size_t row_bytes_ = 0;            // bytes of the expanded column
+    size_t value_bytes_ = 0;          // bytes of the distinct values only
+};
+
+#endif // KAYON_DICT_COLUMN_HPP
@@ -0,0 +1,97 @@
+#ifndef KAYON_DOCA_CONTEXT_POOL_HPP
+#define KAYON_DOCA_CONTEXT_POOL_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "doca_task_consumer.hpp"
+
+// Process-level pool of warm consumers: each has its device open, its
+// progress engine and started context, and its buffers registered for up to
+// capacity input bytes (DocaTaskConsumer::warmUp). Short-lived jobs borrow
+// one, load() their input and run on it instead of paying the init steps,
+// then give it back. A consumer serves one job at a time.
+template <typename Traits>
+class DocaContextPool {
+    public:
+        using Consumer = DocaTaskConsumer<Traits>;
+
+        // A consumer lent to one job, back to the pool when the lease ends
+        class Lease {
+            public:
+                Lease() = default;
+                Lease(Lease &&other) noexcept;
+                Lease &operator=(Lease &&other) noexcept;
+                Lease(const Lease &) = delete;
+                Lease &operator=(const Lease &) = delete;
+                ~Lease() { this->release(); }
+
+                explicit operator bool() const { return consumer_ != nullptr; }
+                Consumer &operator*() const { return *consumer_; }
+                Consumer *operator->() const { return consumer_; }
+
+                // give the consumer back before the lease ends
+                void release();
+
+            private:
+                friend class DocaContextPool;
+                Lease(DocaContextPool *pool, Consumer *consumer) : pool_(pool), consumer_(consumer) {}
+
+                DocaContextPool *pool_ = nullptr;
+                Consumer *consumer_ = nullptr;
+        };
+
+        // contexts consumers constructed with args (without their init
+        // flag), warmed for capacity input bytes. Those that cannot be opened
+        // are left out, size() tells how many are.
+        template <typename... Args>
+        DocaContextPool(size_t contexts, size_t capacity, Args... args) {
+            auto start = std::chrono::steady_clock::now();
+            for (size_t idx = 0; idx < contexts; ++idx) {
+                auto consumer = std::make_unique<Consumer>(args..., false);
+                if (!consumer->warmUp(capacity)) {
+                    consumer->cleanup();
+                    std::cerr << consumer->getName() << " context " << idx << " could not be opened" << std::endl;
+                    continue;
+                }
+                // jobs do not release what the pool owns
+                consumer->keepAlive(true);
+                this->idle_.push_back(consumer.get());
+                this->consumers_.push_back(std::move(consumer));
+            }
+            this->warm_seconds_ = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        // closes every context, all leases must have ended
+        ~DocaContextPool();
+
+        DocaContextPool(const DocaContextPool &) = delete;
+        DocaContextPool &operator=(const DocaContextPool &) = delete;
+
+        // an idle consumer, an empty lease if all are lent
+        Lease acquire();
+
+        size_t size() const { return consumers_.size(); }
+        size_t idle() const;
+        // seconds it took to open all of them
+        double warmSeconds() const { return warm_seconds_; }
+
+    private:
+        void giveBack(Consumer *consumer);
+
+        std::vector<std::unique_ptr<Consumer>> consumers_;
+        std::vector<Consumer*> idle_;
+        mutable std::mutex mutex_;
+        double warm_seconds_ = 0.0;
+};
+
+// Instantiated in doca_context_pool.cpp
+extern template class DocaContextPool<CompressDeflateTraits>;
+extern template class DocaContextPool<DecompressDeflateTraits>;
+extern template class DocaContextPool<DecompressLz4Traits>;
+
+#endif // KAYON_DOCA_CONTEXT_POOL_HPP
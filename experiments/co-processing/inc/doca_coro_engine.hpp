@@ -0,0 +1,186 @@
+#ifndef KAYON_DOCA_CORO_ENGINE_HPP
+#define KAYON_DOCA_CORO_ENGINE_HPP
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <doca_error.h>
+
+#include "doca_task_consumer.hpp"
+
+// Outcome of one awaited DOCA task: status and bytes written to dst
+struct DocaTaskResult {
+    doca_error_t status;
+    size_t size;
+    // checksums of the uncompressed side the device reports (CRC32, and Adler32 or xxHash32)
+    uint32_t crc = 0;
+    uint32_t second = 0;
+};
+
+// Request coroutine run by DocaCoroEngine::spawn. Lazy, the engine starts it
+// and owns the frame until run() sees it finish.
+class DocaCoroutine {
+public:
+    struct promise_type {
+        std::exception_ptr error;
+        size_t *finished = nullptr;
+
+        // Count the coroutine as done on the engine, the frame stays until reaped
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                if (handle.promise().finished) {
+                    ++*handle.promise().finished;
+                }
+            }
+            void await_resume() noexcept {}
+        };
+
+        DocaCoroutine get_return_object() {
+            return DocaCoroutine{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    explicit DocaCoroutine(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    DocaCoroutine(DocaCoroutine &&other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    DocaCoroutine &operator=(DocaCoroutine &&other) noexcept {
+        if (this != &other) {
+            if (handle_) {
+                handle_.destroy();
+            }
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    DocaCoroutine(const DocaCoroutine &) = delete;
+    DocaCoroutine &operator=(const DocaCoroutine &) = delete;
+    ~DocaCoroutine() {
+        if (handle_) {
+            handle_.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> handle() const { return handle_; }
+
+private:
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// Awaitable task front-end over one doca_pe. Instead of a fixed batch of
+// tasks (DocaTaskConsumer), request coroutines co_await single tasks on
+// spans of the engine's registered buffers:
+//
+//     DocaTaskResult res = co_await engine.compress(src, dst);
+//
+// The completion callback resumes the awaiting coroutine. At most
+// max_in_flight tasks are on the device, further awaiters queue up and are
+// submitted as slots free, so any number of coroutines share one context and
+// one polling thread.
+template <typename Traits>
+class DocaCoroEngine : protected DocaTaskConsumer<Traits> {
+    using Base = DocaTaskConsumer<Traits>;
+
+public:
+    using DEVICE_TYPE = typename Base::DEVICE_TYPE;
+    using task_type = typename Base::task_type;
+
+    class TaskAwaiter {
+    public:
+        TaskAwaiter(DocaCoroEngine *engine, std::span<const uint8_t> src, std::span<uint8_t> dst)
+            : engine_(engine), src_(src), dst_(dst) {}
+
+        bool await_ready() const noexcept { return false; }
+        // false resumes right away, the task could not be submitted
+        bool await_suspend(std::coroutine_handle<> handle);
+        DocaTaskResult await_resume() const noexcept { return result_; }
+
+    private:
+        friend class DocaCoroEngine;
+
+        DocaCoroEngine *engine_;
+        std::span<const uint8_t> src_;
+        std::span<uint8_t> dst_;
+        std::coroutine_handle<> handle_;
+        DocaTaskResult result_{DOCA_SUCCESS, 0};
+    };
+
+    // input_capacity/output_capacity bytes are registered with the device once
+    DocaCoroEngine(DEVICE_TYPE dev_type, size_t input_capacity, size_t output_capacity, uint32_t max_in_flight);
+    ~DocaCoroEngine();
+
+    // Registered memory, task src/dst must lie inside these
+    std::span<uint8_t> input() { return {this->indata, input_capacity_}; }
+    std::span<uint8_t> output() { return {this->outdata, output_capacity_}; }
+
+    // Task of the Traits type (compress or decompress) from src into dst
+    TaskAwaiter compress(std::span<const uint8_t> src, std::span<uint8_t> dst) { return {this, src, dst}; }
+
+    // Start a request coroutine, it runs until its first co_await
+    void spawn(DocaCoroutine coroutine);
+
+    // Tick the progress engine until every spawned coroutine returned,
+    // rethrows the first exception a coroutine let escape
+    void run();
+
+    // One tick of the progress engine, for loops that also poll something
+    // else (OffloadRouter), 1 if a task completed
+    uint8_t progress();
+
+    // Spawned coroutines that did not return yet
+    bool pending() const { return finished_ - reaped_ < coroutines_.size(); }
+
+    // Stop the context and release device, mmaps and buffers
+    void cleanup();
+
+    bool ready() const { return ready_; }
+    size_t completed() const { return completed_; }
+    size_t failed() const { return failed_; }
+    // Most awaiters queued behind a full device at once
+    size_t peakWaiting() const { return peak_waiting_; }
+    uint32_t inFlight() const { return in_flight_; }
+    size_t waiting() const { return waiting_.size(); }
+    uint32_t maxInFlight() const { return max_in_flight_; }
+
+private:
+    doca_error_t submit(TaskAwaiter *awaiter);
+    // Submit queued awaiters while slots are free
+    void drainWaiting();
+    void reap();
+
+    static void taskCompleted(task_type *task, union doca_data task_user_data, union doca_data ctx_user_data);
+    static void taskFailed(task_type *task, union doca_data task_user_data, union doca_data ctx_user_data);
+    // Shared tail of both callbacks: release the task, refill, resume
+    static void finishTask(task_type *task, TaskAwaiter *awaiter);
+
+    size_t input_capacity_;
+    size_t output_capacity_;
+    uint32_t max_in_flight_;
+    bool ready_ = false;
+
+    uint32_t in_flight_ = 0;
+    std::deque<TaskAwaiter*> waiting_;
+    size_t completed_ = 0;
+    size_t failed_ = 0;
+    size_t peak_waiting_ = 0;
+
+    std::vector<DocaCoroutine> coroutines_;
+    size_t finished_ = 0;
+    size_t reaped_ = 0;
+    std::exception_ptr error_;
+};
+
+// Instantiated in doca_coro_engine.cpp
+extern template class DocaCoroEngine<CompressDeflateTraits>;
+extern template class DocaCoroEngine<DecompressDeflateTraits>;
+extern template class DocaCoroEngine<DecompressLz4Traits>;
+
+#endif // KAYON_DOCA_CORO_ENGINE_HPP
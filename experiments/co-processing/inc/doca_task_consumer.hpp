@@ -0,0 +1,291 @@
+#ifndef KAYON_DOCA_TASK_CONSUMER_HPP
+#define KAYON_DOCA_TASK_CONSUMER_HPP
+
+#include <chrono>
+#include <cstdint> // preferred in C++
+#include <cstdio>  // if using printf, fopen, etc
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <doca_compress.h>
+#include <doca_dev.h>
+#include <doca_log.h>
+#include <doca_pe.h>
+
+#include "checksum.hpp"
+#include "chunk_retry.hpp"
+#include "codec_task.hpp"
+#include "compressibility.hpp"
+#include "init_timings.hpp"
+#include "task_buffers.hpp"
+
+#define SLEEP_IN_NANOS (10 * 1000)             /* Sample the task every 10 microseconds */
+
+// Called with the task id (block index), output data and length of every completed block
+using doca_block_handler = std::function<void(size_t, const uint8_t*, size_t)>;
+
+template <typename Task>
+struct compression_state {
+    void *in;
+    void *out;
+    size_t num_buffers;
+    size_t input_buffer_size;
+    size_t output_buffer_size;
+    size_t offloaded;
+    size_t completed;
+
+    struct doca_compress *compress;
+    struct doca_mmap *mmap_in;
+    struct doca_mmap *mmap_out;
+    struct doca_buf_inventory *buf_inv;
+    struct region *out_regions;
+    Task **tasks;
+
+    std::chrono::steady_clock::time_point start;
+    std::chrono::steady_clock::time_point end;
+    struct timespec back_to_idle;
+
+    doca_block_handler *on_block;
+    // host retry of failed tasks, the callbacks requeue to it
+    ChunkRetrier *retrier;
+    // checks the device checksums of completed tasks, if enabled
+    ChecksumVerifier *checksums;
+};
+
+// Task traits: the DOCA calls of one compress task type on top of its
+// DOCA-free description (codec_task.hpp).
+#define KAYON_DOCA_TASK_TRAITS(TASK)                                                                          \
+    using task_type = doca_compress_task_##TASK;                                                             \
+    using callback_type = doca_compress_task_##TASK##_completion_cb_t;                                       \
+    static doca_error_t isSupported(const doca_devinfo *devinfo) {                                           \
+        return doca_compress_cap_task_##TASK##_is_supported(devinfo);                                        \
+    }                                                                                                        \
+    static doca_error_t setConf(doca_compress *compress, callback_type completed, callback_type failed,      \
+                                uint32_t num_tasks) {                                                        \
+        return doca_compress_task_##TASK##_set_conf(compress, completed, failed, num_tasks);                 \
+    }                                                                                                        \
+    static doca_error_t allocInit(doca_compress *compress, doca_buf const *src, doca_buf *dst,               \
+                                  doca_data user_data, task_type **task) {                                   \
+        return doca_compress_task_##TASK##_alloc_init(compress, src, dst, user_data, task);                  \
+    }                                                                                                        \
+    static doca_task *asTask(task_type *task) { return doca_compress_task_##TASK##_as_task(task); }          \
+    static doca_buf const *getSrc(task_type *task) { return doca_compress_task_##TASK##_get_src(task); }     \
+    static doca_buf *getDst(task_type *task) { return doca_compress_task_##TASK##_get_dst(task); }          \
+    static uint32_t getCrc(task_type *task) { return doca_compress_task_##TASK##_get_crc_cs(task); }
+
+struct CompressDeflateTraits : CompressDeflateTask {
+    using task = CompressDeflateTask;
+    KAYON_DOCA_TASK_TRAITS(compress_deflate)
+    static uint32_t getSecondChecksum(task_type *task) { return doca_compress_task_compress_deflate_get_adler_cs(task); }
+};
+
+struct DecompressDeflateTraits : DecompressDeflateTask {
+    using task = DecompressDeflateTask;
+    KAYON_DOCA_TASK_TRAITS(decompress_deflate)
+    static uint32_t getSecondChecksum(task_type *task) { return doca_compress_task_decompress_deflate_get_adler_cs(task); }
+};
+
+struct DecompressLz4Traits : DecompressLz4Task {
+    using task = DecompressLz4Task;
+    KAYON_DOCA_TASK_TRAITS(decompress_lz4_block)
+    static uint32_t getSecondChecksum(task_type *task) { return doca_compress_task_decompress_lz4_block_get_xxh_cs(task); }
+};
+
+#undef KAYON_DOCA_TASK_TRAITS
+
+// One DOCA compress context that offloads a whole file as a batch of tasks of
+// one type. The task type is fixed at compile time, the callbacks and the
+// submission loop call the DOCA functions of the traits directly.
+template <typename Traits>
+class DocaTaskConsumer : protected TaskBuffers<typename Traits::task> {
+        using Buffers = TaskBuffers<typename Traits::task>;
+
+    public:
+        using DEVICE_TYPE = typename Buffers::DEVICE_TYPE;
+
+        using task_type = typename Traits::task_type;
+
+        // split_input: buffers are sized from the file
+        explicit DocaTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, bool init = true)
+            requires (Traits::split_input);
+
+        // asked_num_buffers input buffers of asked_buffer_size bytes, original_file_size bytes of output
+        explicit DocaTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size,
+            uint64_t asked_num_buffers, size_t original_file_size, bool init = true)
+            requires (!Traits::split_input);
+
+        ~DocaTaskConsumer();
+
+        std::string getName();
+
+        // 1. init doca logic here (resources, buffers, and context)
+        void initDocaContext();
+
+        // 2. submit all tasks and busy-wait for their completion
+        void executeDocaTask();
+
+        // 3. release the DOCA resources and return the timings
+        std::vector<std::string> getDocaResults();
+
+        // keep the context for another run after getDocaResults (repeated
+        // trials, ctx_stop_elapsed is then 0 until the last run)
+        void keepAlive(bool keep) { this->keep_alive_ = keep; }
+
+        // false if the device, context or tasks could not be set up (fall back to SwTaskConsumer)
+        bool ready() const { return ready_; }
+
+        // consume each block as it completes (e.g. Lz4RegexPipe::scanDecompressedBlock), set before executeDocaTask
+        void setBlockHandler(doca_block_handler handler);
+
+        // host retry of failed or timed-out tasks, set before executeDocaTask
+        void setRetryPolicy(RetryPolicy policy) { retrier.setPolicy(policy); }
+        // deflate: skip the device for chunks the estimator finds incompressible, set before executeDocaTask
+        void setBypass(CompressibilityEstimator estimator) { this->estimator = estimator; }
+        // check the CRC and Adler32/xxHash32 the device reports per task, set before executeDocaTask
+        void setVerify(bool verify) { checksums.setEnabled(verify); }
+        const ChecksumVerifier &checksumVerifier() const { return checksums; }
+        // engine that produced each block, after executeDocaTask
+        const std::vector<ChunkEngine> &chunkEngines() const { return retrier.engines(); }
+        const RetryCounters &retryCounters() const { return retrier.counters(); }
+        // seconds of each initDocaContext step and to the first submitted task
+        const InitTimings &initTimings() const { return init_timings; }
+        // user+sys seconds of the retry pool
+        double workerCpuSeconds() const { return retrier.workerCpuSeconds(); }
+
+        // Engine lifecycle (engine.hpp), init is skipped if the constructor did it
+        void init();
+        void execute();
+        void cleanup();
+
+        // a run frees its tasks as they complete: allocate them again before
+        // the next executeDocaTask (repeated trials, not measured)
+        void rearm();
+
+        // size the context for slots tasks instead of those of the input, before init
+        void reserveTasks(uint32_t slots) { this->task_slots = slots; }
+
+        // offload the first bytes of the loaded input as tasks of buffer_size,
+        // at most max_buffers (prefixLayout), on the open context and the
+        // registered memory (in-process sweeps, not measured)
+        bool reshape(size_t bytes, uint64_t buffer_size, uint64_t max_buffers)
+            requires (Traits::split_input);
+        uint32_t numTasks() const { return this->num_buffers; }
+        uint64_t bufferSize() const { return this->input_buff_size; }
+
+        // init without an input: device, engine, context and registered
+        // buffers for up to capacity input bytes, kept for the jobs that
+        // load() into them (DocaContextPool), false if not ready
+        bool warmUp(size_t capacity);
+
+        // a job on the warm context: copy its input into the registered
+        // buffers and allocate its tasks, the init timings then cover only
+        // this (copy as the file read, tasks), false if it does not fit
+        bool load(const uint8_t *data, size_t bytes);
+
+    protected:
+        // device limits only, for front-ends that bring their own buffers (DocaCoroEngine)
+        explicit DocaTaskConsumer(DEVICE_TYPE dev_type);
+
+        // SDK log backend to stderr, warnings and up (set at init)
+        doca_log_backend* sdkLog = nullptr;
+
+        // compression state obj
+        compression_state<task_type> state_obj = {};
+        doca_block_handler block_handler;
+        ChunkRetrier retrier{Traits::codec};
+        CompressibilityEstimator estimator;
+        ChecksumVerifier checksums;
+        InitTimings init_timings;
+
+        // doca mmaps
+        doca_mmap *mmap_in = nullptr;
+        doca_mmap *mmap_out = nullptr;
+
+        // progress engine
+        doca_pe *engine = nullptr;
+
+        // device
+        doca_dev *device = nullptr;
+
+        // DOCA buffer inventory
+        doca_buf_inventory *inventory = nullptr;
+
+        // DOCA compression context (1 per thread)
+        struct doca_ctx *ctx = nullptr;
+
+        bool initialized = false;
+        bool ready_ = false;
+        bool released = false;
+        // tasks allocated and not yet submitted
+        bool armed_ = false;
+        bool keep_alive_ = false;
+        // stopped after a timeout, rearm starts it again
+        bool ctx_stopped_ = false;
+        // warmUp: input bytes reserved instead of reading the file
+        size_t warm_capacity_ = 0;
+
+        // time counters
+        std::chrono::steady_clock::time_point submit_start, submit_end, busy_wait_end, ctx_stop_start, ctx_stop_end;
+        double thread_time_start, thread_time_end;
+
+        // logic from open_doca_device_with_capabilities
+        doca_error_t openDocaDevice();
+
+        // print an init step after the first, for the task types that log them
+        static void logInitStep(const char *step);
+
+        // prepare engine
+        doca_error_t prepareEngine();
+
+        // prepare mmaps
+        doca_error_t prepareMmaps(uint32_t in_permissions, uint32_t out_permissions);
+
+        // prepare and init context (with callbacks)
+        doca_error_t openCompressContext();
+        doca_error_t openCompressContext(typename Traits::callback_type completed,
+                                         typename Traits::callback_type failed, uint32_t num_tasks);
+
+        // prepare compress tasks
+        doca_error_t allocateCompressTasks();
+
+        // fire compress tasks, incompressible chunks are stored instead
+        doca_error_t submitCompressTasks();
+
+        // give the buffers of the armed tasks back to the inventory, before a new layout
+        void disarm();
+        // allocate the tasks of the new layout
+        bool armLayout();
+
+        // release a prepared task that is not submitted, it counts as completed
+        void dropTask(uint32_t task_id);
+
+        // poll until we drain all tasks and their host retries
+        doca_error_t pollTillCompletion();
+
+        // stop the context and progress until it is idle: tasks still on the
+        // device are flushed through errorCallback, whose late result is ignored
+        doca_error_t stopContext();
+
+        // DOCA task completed callback
+        static void completedCallback(task_type *compress_task, union doca_data task_user_data,
+                                      union doca_data ctx_user_data);
+
+        // DOCA task error callback
+        static void errorCallback(task_type *compress_task, union doca_data task_user_data,
+                                  union doca_data ctx_user_data);
+
+        // DOCA task state changed callback
+        static void stateChangedCallback(union doca_data user_data, struct doca_ctx *ctx,
+                                         enum doca_ctx_states prev_state, enum doca_ctx_states next_state);
+
+        // cleanup resources in reverse init order
+        doca_error_t releaseResources();
+};
+
+// Instantiated in doca_task_consumer.cpp
+extern template class DocaTaskConsumer<CompressDeflateTraits>;
+extern template class DocaTaskConsumer<DecompressDeflateTraits>;
+extern template class DocaTaskConsumer<DecompressLz4Traits>;
+
+#endif // KAYON_DOCA_TASK_CONSUMER_HPP
@@ -0,0 +1,24 @@
+#ifndef KAYON_ENGINE_HPP
+#define KAYON_ENGINE_HPP
+
+#include <concepts>
+#include <string>
+
+// Common lifecycle of every CPU pipe and DOCA consumer the co-processing
+// drivers run: init (not measured), execute (measured), cleanup (output and
+// release). Workers are templates over the engine, so there are no virtual
+// calls and the batching/pooling/pipelining code is written once.
+template <typename E>
+concept Engine = requires(E& engine) {
+    engine.init();
+    engine.execute();
+    engine.cleanup();
+};
+
+// Engines that also report a name for their result files.
+template <typename E>
+concept NamedEngine = Engine<E> && requires(E& engine) {
+    { engine.getName() } -> std::convertible_to<std::string>;
+};
+
+#endif // KAYON_ENGINE_HPP
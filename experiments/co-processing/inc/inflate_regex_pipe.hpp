@@ -0,0 +1,72 @@
+#ifndef KAYON_INFLATE_REGEX_PIPE_HPP
+#define KAYON_INFLATE_REGEX_PIPE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <re2/re2.h>
+
+#include "line_scanner.hpp"
+#include "literal_prefilter.hpp"
+#include "regex_common.hpp"
+
+// Streaming inflate into the RE2 scan: one thread inflates the deflate/gzip
+// stream Zpipe::inf-style into a ring of chunk buffers, the executing thread
+// splits the chunks into lines and matches them as they fill up. The input is
+// one continuous stream, it cannot be cut into independent device blocks, so
+// inflate stays on the host.
+class InflateRegexPipe {
+public:
+    // Default inflated bytes per chunk and chunks in flight between the threads
+    static const size_t DEFAULT_CHUNK_SIZE = 256 * 1024;
+    static const size_t NUM_CHUNKS = 4;
+
+    explicit InflateRegexPipe(const std::string& file_location, RegexScanOptions options = {},
+                              size_t chunk_size = DEFAULT_CHUNK_SIZE);
+
+    // Initialization: compile the regexes and hold the compressed input in memory.
+    // A gzip/zlib input is used as is, plain CSV is deflated here (not timed).
+    void init();
+
+    // Execute processing: inflate and scan on two threads.
+    void execute();
+
+    // Cleanup: output the results.
+    void cleanup();
+
+    // Per-query results, available after cleanup.
+    const std::vector<RegexQueryResult>& results() const { return results_; }
+
+    // True if the file starts with a gzip or zlib header (else it is deflated in init).
+    static bool isCompressedFile(const std::string& file_location);
+
+private:
+    // One pass: inflate thread plus scan on the calling thread
+    void inflateAndScan();
+
+    int iters_;
+    std::string input_location_;
+    RegexScanOptions options_;
+    size_t chunk_size_;
+
+    std::vector<RegexQuery> queries_;
+    std::vector<std::string> patterns_;
+    std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> regexes_;
+    std::unique_ptr<LiteralPrefilter> prefilter_;
+    std::unique_ptr<LineScanner> scanner_;
+
+    // zlib or gzip stream of this pipe's rows
+    std::vector<unsigned char> compressed_;
+    bool skip_header_ = true;
+    // Chunk buffers handed between the inflate and the scan thread
+    std::vector<std::vector<char>> chunks_;
+
+    double avg_seconds_ = 0.0;
+    // Time the scan thread waited for inflated chunks
+    double avg_wait_seconds_ = 0.0;
+
+    std::vector<RegexQueryResult> results_;
+};
+
+#endif // KAYON_INFLATE_REGEX_PIPE_HPP
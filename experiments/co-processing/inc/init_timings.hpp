@@ -0,0 +1,60 @@
+#ifndef KAYON_INIT_TIMINGS_HPP
+#define KAYON_INIT_TIMINGS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Steps of DocaTaskConsumer::initDocaContext, in their order. The software
+// consumer fills the ones it has (file, buffers, its pool as the context,
+// tasks), the others stay 0.
+enum class InitStage {
+    LOG,
+    READ_FILE,
+    BUFFERS,
+    ENGINE,
+    DEVICE,
+    MMAPS,
+    INVENTORY,
+    STATE,
+    CONTEXT,
+    TASKS,
+    COUNT
+};
+
+// Wall time of each init stage of a consumer, their sum (init start to
+// ready), and the time from the start of its run to its first submitted
+// task: the startup a short job pays before the device does any work. The
+// wait for the start barrier between init and run is in neither.
+class InitTimings {
+    public:
+        // init begins
+        void start();
+        // stage ended now, it ran since the previous mark (or start)
+        void mark(InitStage stage);
+        // the run begins, past the start barrier
+        void running();
+        // a task was submitted, only the first one of the run counts
+        void submitted();
+
+        double seconds(InitStage stage) const { return seconds_[static_cast<size_t>(stage)]; }
+        double totalSeconds() const;
+
+        // results JSON values, in the order of INIT_TIMING_KEYS
+        std::vector<std::string> toStrings() const;
+
+    private:
+        std::chrono::steady_clock::time_point last_, run_start_, first_submit_;
+        std::array<double, static_cast<size_t>(InitStage::COUNT)> seconds_{};
+        bool running_ = false;
+        bool submitted_ = false;
+};
+
+#define INIT_TIMING_KEYS                                                                                      \
+    "init_log_elapsed", "init_read_file_elapsed", "init_buffers_elapsed", "init_engine_elapsed",               \
+        "init_device_elapsed", "init_mmaps_elapsed", "init_inventory_elapsed", "init_state_elapsed",           \
+        "init_context_elapsed", "init_tasks_elapsed", "init_total_elapsed", "first_submit_elapsed"
+
+#endif // KAYON_INIT_TIMINGS_HPP
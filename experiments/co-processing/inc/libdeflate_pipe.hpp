@@ -0,0 +1,51 @@
+#ifndef KAYON_LIBDEFLATE_PIPE_HPP
+#define KAYON_LIBDEFLATE_PIPE_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <libdeflate.h>
+
+// Whole-buffer counterpart of Zpipe's single-buffer path: libdeflate
+// compresses and decompresses the file in one call, without zlib's stream
+// state and its 16 KiB output copies. Streams are raw deflate (no zlib
+// header or trailer), the format the DOCA deflate tasks read and write.
+// All calls return 0 on success.
+class LibdeflatePipe {
+public:
+    // libdeflate levels run 0-12, 6 matches zlib's default used by Zpipe
+    explicit LibdeflatePipe(int level = 6);
+    ~LibdeflatePipe();
+
+    // 1) Init: read the file, allocate the (de)compressor and the output buffer.
+    //    original_size is the decompressed size if known, 0 to grow the output on demand
+    int deflate_init(const std::string &inFilename, const std::string &outFilename);
+    int inflate_init(const std::string &inFilename, const std::string &outFilename, size_t original_size = 0);
+
+    // 2) Execution: one call over the whole in-memory buffer
+    int deflate_execute();
+    int inflate_execute();
+
+    // 3) Cleanup: write the output file, free the (de)compressor
+    void deflate_cleanup();
+    void inflate_cleanup();
+
+    size_t output_size() const { return m_outputSize; }
+
+private:
+    int m_init(const std::string &inFilename, const std::string &outFilename);
+    void m_cleanup();
+
+    int m_level;
+    libdeflate_compressor *m_compressor = nullptr;
+    libdeflate_decompressor *m_decompressor = nullptr;
+
+    std::vector<unsigned char> m_input;
+    std::vector<unsigned char> m_output;
+    size_t m_outputSize = 0;
+
+    FILE *m_outFile = nullptr;
+};
+
+#endif // KAYON_LIBDEFLATE_PIPE_HPP
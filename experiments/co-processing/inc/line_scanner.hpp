@@ -0,0 +1,76 @@
+#ifndef KAYON_LINE_SCANNER_HPP
+#define KAYON_LINE_SCANNER_HPP
+
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <re2/re2.h>
+
+#include "literal_prefilter.hpp"
+#include "regex_common.hpp"
+
+// Runs the regex queries over CSV text as it arrives, chunk by chunk, so a
+// decompressor can hand over each block while it is still in cache. Lines are
+// split in place, only a line cut by a chunk boundary is copied. All queries
+// run on a line before the next one, the text is read once.
+class LineScanner {
+public:
+    LineScanner(const std::vector<RegexQuery>& queries,
+                std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> regexes,
+                const LiteralPrefilter* prefilter = nullptr);
+
+    // Scan the complete lines of the chunk, keep the cut last line for the next one.
+    void consume(const char* data, size_t size);
+
+    // Scan the last line if the text does not end with a newline.
+    void finish();
+
+    // Numbered blocks that complete in any order (DOCA tasks): a block is
+    // consumed once its predecessors were, its data has to stay valid until then.
+    void consumeBlock(size_t block_idx, const char* data, size_t size);
+
+    // finish() after the last block, warns about blocks left behind a missing one.
+    void finishBlocks();
+
+    // Forget the counts and expect a header line again.
+    void reset(bool skip_header = true);
+
+    // Text bytes consumed and data rows scanned (header excluded).
+    size_t bytes() const { return bytes_; }
+    size_t rows() const { return rows_; }
+
+    // Per query: matching rows, rows that passed the prefilter and bytes of the scanned fields.
+    const std::vector<size_t>& matches() const { return matches_; }
+    const std::vector<size_t>& prefilterPassed() const { return passed_; }
+    const std::vector<size_t>& fieldBytes() const { return field_bytes_; }
+
+private:
+    void scanLine(std::string_view line);
+
+    std::vector<RegexQuery> queries_;
+    std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> regexes_;
+    const LiteralPrefilter* prefilter_;
+
+    // Highest CSV column any query reads, fields past it are not split
+    int max_column_ = 0;
+    std::vector<std::string_view> fields_;
+
+    // Start of a line cut by the end of the previous chunk
+    std::string carry_;
+    bool skip_header_ = true;
+
+    // Blocks of consumeBlock waiting for their predecessors
+    std::map<size_t, std::pair<const char*, size_t>> pending_blocks_;
+    size_t next_block_ = 0;
+
+    size_t bytes_ = 0;
+    size_t rows_ = 0;
+    std::vector<size_t> matches_;
+    std::vector<size_t> passed_;
+    std::vector<size_t> field_bytes_;
+};
+
+#endif // KAYON_LINE_SCANNER_HPP
@@ -0,0 +1,45 @@
+#ifndef KAYON_LITERAL_PREFILTER_HPP
+#define KAYON_LITERAL_PREFILTER_HPP
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <re2/filtered_re2.h>
+
+// Cheap literal check in front of the regex engines. The required literals
+// (atoms) of each pattern come from RE2's FilteredRE2, a line that misses
+// them can not match and skips the full regex evaluation.
+class LiteralPrefilter {
+public:
+    explicit LiteralPrefilter(const std::vector<std::string>& patterns, int min_atom_len = 3);
+
+    // False only if the line can not match the pattern.
+    bool mayMatch(size_t pattern_idx, std::string_view line) const;
+
+    // False only if the line can not match any of the patterns.
+    bool mayMatchAny(std::string_view line) const;
+
+    // Lowercased required literals of a pattern (empty if unfiltered).
+    const std::vector<std::string>& atoms(size_t pattern_idx) const;
+
+    size_t numPatterns() const { return queries_.size(); }
+
+    // Case-insensitive substring search, needle must be lowercase.
+    // Returns std::string_view::npos if not found.
+    static size_t findCaseless(std::string_view haystack, std::string_view needle);
+
+    // SIMD variant findCaseless picked on this CPU ("avx2", "sse2", "neon" or "scalar")
+    static const char* kernelName();
+
+private:
+    struct Query {
+        std::unique_ptr<re2::FilteredRE2> filter;
+        std::vector<std::string> atoms;
+        bool unfiltered; // no usable literal, every line passes
+    };
+    std::vector<Query> queries_;
+};
+
+#endif // KAYON_LITERAL_PREFILTER_HPP
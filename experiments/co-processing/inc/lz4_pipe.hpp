@@ -33,6 +33,9 @@ public:
     //    - Compress the in-memory LZ4 buffer
     int compress_execute();
 
+    // Emit input the estimator finds incompressible as one literal block, off by default
+    void set_incompressible_bypass(bool enabled) { m_bypassIncompressible = enabled; }
+
     // 3) compress_cleanup: 
     //    - Writes the *compressed* data to disk, 
     //    - Clears buffers if desired
@@ -62,6 +65,8 @@ private:
 
     // Size for large enough buffer for worst-case LZ4 compression
     int m_maxDstSize;
+
+    bool m_bypassIncompressible = false;
 };
 
 #endif // LZ4_PIPE_HPP
\ No newline at end of file
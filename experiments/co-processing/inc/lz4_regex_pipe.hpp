@@ -0,0 +1,75 @@
+#ifndef KAYON_LZ4_REGEX_PIPE_HPP
+#define KAYON_LZ4_REGEX_PIPE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <re2/re2.h>
+
+#include "line_scanner.hpp"
+#include "literal_prefilter.hpp"
+#include "regex_common.hpp"
+
+// Fused LZ4 decompression and RE2 scan: the input is held as independent LZ4
+// blocks, each block is decompressed into one cache-sized buffer and scanned
+// before the next one, the whole plaintext never exists in memory.
+class Lz4RegexPipe {
+public:
+    // Default plaintext per block, small enough to stay in L2
+    static const size_t DEFAULT_BLOCK_SIZE = 256 * 1024;
+
+    explicit Lz4RegexPipe(const std::string& file_location, RegexScanOptions options = {},
+                          size_t block_size = DEFAULT_BLOCK_SIZE);
+
+    // Initialization: compile the regexes and compress the input into LZ4 blocks (not timed).
+    void init();
+
+    // Execute processing: decompress and scan the blocks of the row share.
+    void execute();
+
+    // Cleanup: output the results.
+    void cleanup();
+
+    // Blocks decompressed elsewhere (DecompressLz4Consumer::setBlockHandler),
+    // scanned in block order, see LineScanner::consumeBlock. Use after init instead of execute.
+    void scanDecompressedBlock(size_t block_idx, const char* data, size_t size);
+
+    // Scan the last line after the final block of scanDecompressedBlock.
+    void finishDecompressedBlocks();
+
+    // Per-query results, available after cleanup.
+    const std::vector<RegexQueryResult>& results() const { return results_; }
+
+private:
+    // Compress the input in line-aligned blocks, a block never cuts a row
+    void compressBlocks(const std::vector<char>& text);
+
+    int iters_;
+    std::string input_location_;
+    RegexScanOptions options_;
+    size_t block_size_;
+
+    std::vector<RegexQuery> queries_;
+    std::vector<std::string> patterns_;
+    std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> regexes_;
+    std::unique_ptr<LiteralPrefilter> prefilter_;
+    std::unique_ptr<LineScanner> scanner_;
+
+    // Compressed blocks: offsets into compressed_ and plaintext sizes
+    std::vector<char> compressed_;
+    std::vector<size_t> block_offsets_;
+    std::vector<size_t> block_sizes_;
+    // Blocks of this pipe's row share: [first_block_, last_block_)
+    size_t first_block_ = 0;
+    size_t last_block_ = 0;
+    // Reused decompression target, one block
+    std::vector<char> block_buffer_;
+
+    double avg_seconds_ = 0.0;
+    size_t compressed_bytes_ = 0;
+
+    std::vector<RegexQueryResult> results_;
+};
+
+#endif // KAYON_LZ4_REGEX_PIPE_HPP
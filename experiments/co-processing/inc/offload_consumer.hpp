@@ -0,0 +1,109 @@
+#ifndef KAYON_OFFLOAD_CONSUMER_HPP
+#define KAYON_OFFLOAD_CONSUMER_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "doca_task_consumer.hpp"
+#include "sw_task_consumer.hpp"
+
+// Options of the offloaded share: force the software executor, and its
+// pool/latency model (also used when it is the fallback), the host retry of
+// failed tasks, the stored bypass of incompressible chunks and the check of
+// the device checksums.
+struct OffloadOptions {
+    bool force_sw = false;
+    SwExecutorConfig sw;
+    RetryPolicy retry;
+    CompressibilityEstimator bypass;
+    bool verify = false;
+    // tasks the consumer is sized for up front (sweeps reshape it), 0: those of its input
+    uint32_t task_slots = 0;
+
+    // Parse --sw, --sw-threads N, --sw-latency-us US, --sw-mibs MIBS, --no-retry, --retry-threads N,
+    // --task-timeout-ms MS, --no-bypass, --verify at argv[idx], false if not one of them
+    bool parseFlag(int argc, char **argv, int &idx) {
+        std::string flag = argv[idx];
+        if (flag == "--sw") {
+            force_sw = true;
+        } else if (flag == "--sw-threads" && idx + 1 < argc) {
+            sw.threads = std::stoul(argv[++idx]);
+        } else if (flag == "--sw-latency-us" && idx + 1 < argc) {
+            sw.model.task_latency_us = std::stod(argv[++idx]);
+        } else if (flag == "--sw-mibs" && idx + 1 < argc) {
+            sw.model.mib_per_s = std::stod(argv[++idx]);
+        } else if (flag == "--no-retry") {
+            retry.enabled = false;
+        } else if (flag == "--retry-threads" && idx + 1 < argc) {
+            retry.threads = std::stoul(argv[++idx]);
+        } else if (flag == "--task-timeout-ms" && idx + 1 < argc) {
+            retry.task_timeout_ms = std::stod(argv[++idx]);
+        } else if (flag == "--no-bypass") {
+            bypass.enabled = false;
+        } else if (flag == "--verify") {
+            verify = true;
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static constexpr const char *usage = "[--sw] [--sw-threads N] [--sw-latency-us US] [--sw-mibs MIBS] "
+                                         "[--no-retry] [--retry-threads N] [--task-timeout-ms MS] [--no-bypass] [--verify]";
+};
+
+// Run the offloaded share on the DOCA consumer, or on its software stand-in
+// when forced or when no device, context or task could be set up. run gets
+// the initialized consumer, args are the consumer constructor arguments.
+template <typename DocaConsumer, typename SwConsumer, typename Run, typename... Args>
+void runOffloadConsumer(const OffloadOptions &options, Run &&run, Args... args) {
+    if (!options.force_sw) {
+        DocaConsumer consumer(args..., options.task_slots == 0);
+        if (options.task_slots > 0) {
+            consumer.reserveTasks(options.task_slots);
+            consumer.init();
+        }
+        if (consumer.ready()) {
+            consumer.setRetryPolicy(options.retry);
+            consumer.setBypass(options.bypass);
+            consumer.setVerify(options.verify);
+            run(consumer);
+            return;
+        }
+        consumer.cleanup();
+        std::cerr << consumer.getName() << " not ready, falling back to the software executor" << std::endl;
+    }
+    SwConsumer consumer(args..., options.task_slots == 0, options.sw);
+    if (options.task_slots > 0) {
+        consumer.reserveTasks(options.task_slots);
+        consumer.init();
+    }
+    consumer.setRetryPolicy(options.retry);
+    consumer.setBypass(options.bypass);
+    consumer.setVerify(options.verify);
+    run(consumer);
+}
+
+// Timings of a consumer plus the joined time for the results JSON, then the
+// CPU time of its worker threads (worker_cpu_time_elapsed: software pool and
+// host retries), the retry counters (RETRY_COUNTER_KEYS), the checksum
+// check (CHECKSUM_KEYS) and the init stages (INIT_TIMING_KEYS)
+template <typename Consumer>
+std::vector<std::string> offloadResults(Consumer &consumer, const std::string &joined_elapsed) {
+    auto result_times = consumer.getDocaResults();
+    result_times.push_back(joined_elapsed);
+    result_times.push_back(std::to_string(consumer.workerCpuSeconds()));
+    for (auto &counter : consumer.retryCounters().toStrings()) {
+        result_times.push_back(counter);
+    }
+    for (auto &value : consumer.checksumVerifier().toStrings()) {
+        result_times.push_back(value);
+    }
+    for (auto &value : consumer.initTimings().toStrings()) {
+        result_times.push_back(value);
+    }
+    return result_times;
+}
+
+#endif // KAYON_OFFLOAD_CONSUMER_HPP
@@ -0,0 +1,146 @@
+#ifndef KAYON_OFFLOAD_ROUTER_HPP
+#define KAYON_OFFLOAD_ROUTER_HPP
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "doca_coro_engine.hpp"
+#include "sw_task_executor.hpp"
+
+// Where a routed chunk ran
+enum class RouteTarget { HW, CPU };
+
+// Outcome of one routed chunk: status, bytes written to dst and checksums
+// of the uncompressed side, as DocaTaskResult, plus the side that ran it
+// and its latency. Both sides report the same checksums for the same chunk.
+struct RoutedResult {
+    doca_error_t status;
+    size_t size;
+    RouteTarget target;
+    double seconds;
+    uint32_t crc = 0;
+    uint32_t second = 0;
+};
+
+// Per-chunk router in front of a shared accelerator. Request coroutines
+//
+//     RoutedResult res = co_await router.route(src, dst);
+//
+// and each chunk goes to the DOCA context (DocaCoroEngine) or to a host
+// worker (SwTaskExecutor running the zlib/LZ4 calls of Zpipe/LZ4Pipe),
+// whichever is predicted to finish it first:
+//
+//   hw:  max(latency, (queued bytes + chunk) * completion interval), per byte
+//   cpu: (queued bytes / threads + chunk) * service time, per byte
+//
+// The hardware estimates come from the recent completions (EWMA), so other
+// tenants on the engine show up as longer intervals and deeper queues. Both
+// sides write the same format into the same dst slot (raw deflate or
+// plaintext), so the output does not depend on the route.
+template <typename Traits>
+class OffloadRouter {
+    using HwEngine = DocaCoroEngine<Traits>;
+
+public:
+    using DEVICE_TYPE = typename HwEngine::DEVICE_TYPE;
+
+    class RouteAwaiter {
+    public:
+        RouteAwaiter(OffloadRouter *router, std::span<const uint8_t> src, std::span<uint8_t> dst)
+            : router_(router), src_(src), dst_(dst) {}
+
+        bool await_ready() const noexcept { return false; }
+        // false resumes right away, the chunk could not be submitted on either side
+        bool await_suspend(std::coroutine_handle<> handle);
+        RoutedResult await_resume();
+
+    private:
+        friend class OffloadRouter;
+
+        OffloadRouter *router_;
+        std::span<const uint8_t> src_;
+        std::span<uint8_t> dst_;
+        size_t bytes_ = 0;
+        RouteTarget target_ = RouteTarget::HW;
+        std::optional<typename HwEngine::TaskAwaiter> hw_;
+        SwTask cpu_{};
+        std::coroutine_handle<> handle_;
+        doca_error_t submit_error_ = DOCA_SUCCESS;
+        // the host chunk found a free worker, its latency is the service time
+        bool cpu_idle_ = false;
+        std::chrono::steady_clock::time_point submitted_;
+    };
+
+    // Same registration as DocaCoroEngine, cpu_threads host workers next to it
+    OffloadRouter(DEVICE_TYPE dev_type, size_t input_capacity, size_t output_capacity, uint32_t max_in_flight,
+                  size_t cpu_threads);
+    ~OffloadRouter();
+
+    // Registered memory, chunk src/dst must lie inside these
+    std::span<uint8_t> input() { return hw_.input(); }
+    std::span<uint8_t> output() { return hw_.output(); }
+
+    // Route one chunk of the Traits codec from src into dst
+    RouteAwaiter route(std::span<const uint8_t> src, std::span<uint8_t> dst) { return {this, src, dst}; }
+
+    // Start a request coroutine, it runs until its first co_await
+    void spawn(DocaCoroutine coroutine) { hw_.spawn(std::move(coroutine)); }
+
+    // Tick the progress engine and the host workers until every spawned
+    // coroutine returned, rethrows the first exception a coroutine let escape
+    void run();
+
+    void cleanup();
+
+    // Buffers are there, the accelerator may still be missing (all chunks go to the host)
+    bool ready() const { return hw_ready_ || cpu_only_; }
+    bool hwReady() const { return hw_ready_; }
+
+    size_t routedHw() const { return routed_hw_; }
+    size_t routedCpu() const { return routed_cpu_; }
+    size_t failed() const { return failed_; }
+    // Chunk latency (submit to completion) at quantile q in [0, 1]
+    double latencyQuantile(double q) const;
+
+private:
+    RouteTarget choose(size_t bytes) const;
+    void finished(RouteAwaiter *awaiter, bool ok);
+
+    static void cpuCompleted(SwTask *task, void *ctx_user_data);
+    static void cpuFailed(SwTask *task, void *ctx_user_data);
+
+    HwEngine hw_;
+    SwTaskExecutor cpu_;
+    size_t cpu_threads_;
+    bool hw_ready_ = false;
+    bool cpu_only_ = false;
+
+    // queue state, bytes of the chunks submitted and not completed
+    uint32_t hw_depth_ = 0;
+    size_t hw_queued_bytes_ = 0;
+    uint32_t cpu_depth_ = 0;
+    size_t cpu_queued_bytes_ = 0;
+
+    // EWMA seconds per byte, 0 until the first sample
+    double hw_latency_ = 0.0;
+    double hw_interval_ = 0.0;
+    double cpu_service_ = 0.0;
+    std::chrono::steady_clock::time_point hw_last_completion_;
+    bool hw_backlogged_ = false;
+
+    size_t routed_hw_ = 0;
+    size_t routed_cpu_ = 0;
+    size_t failed_ = 0;
+    std::vector<double> latencies_;
+};
+
+// Instantiated in offload_router.cpp
+extern template class OffloadRouter<CompressDeflateTraits>;
+extern template class OffloadRouter<DecompressDeflateTraits>;
+extern template class OffloadRouter<DecompressLz4Traits>;
+
+#endif // KAYON_OFFLOAD_ROUTER_HPP
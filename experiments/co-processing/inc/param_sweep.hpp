@@ -0,0 +1,68 @@
+#ifndef KAYON_PARAM_SWEEP_HPP
+#define KAYON_PARAM_SWEEP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// One run of a sweep: the device share of the input and how it is cut into tasks
+struct SweepPoint {
+    int split_dpu = 0;
+    // bytes per task, 0: the device limit
+    uint64_t buffer_size = 0;
+    // at most this many tasks, 0: as many as the share needs
+    uint64_t buffer_count = 0;
+};
+
+// Grid of an in-process sweep: every combination of split percentage,
+// buffer size and buffer count runs in one process on one opened device
+// (instead of one launch per point in measure-*.sh). Lists that are not
+// given default to 0,10,..,100 (splits) and 0 (sizes, counts).
+struct SweepOptions {
+    bool enabled = false;
+    std::vector<int> splits;
+    std::vector<uint64_t> buffer_sizes;
+    std::vector<uint64_t> buffer_counts;
+    std::string output = "results-sweep.json";
+
+    // Parse --sweep-split P,.., --sweep-buffer-size B,.., --sweep-buffers N,..,
+    // --sweep-out FILE at argv[idx], false if not one of them
+    bool parseFlag(int argc, char **argv, int &idx);
+
+    // buffer sizes, then counts, then splits, the last varies fastest
+    std::vector<SweepPoint> points() const;
+
+    static constexpr const char *usage =
+        "[--sweep-split P,..] [--sweep-buffer-size B,..] [--sweep-buffers N,..] [--sweep-out FILE]";
+};
+
+// The share of a file percent takes, as measure-*.sh truncates it
+size_t shareBytes(size_t file_size, int percent);
+
+// Results of a sweep, one row per point and one column per result key.
+// Workers fill their own table and the driver merges them before writing.
+class SweepTable {
+    public:
+        explicit SweepTable(size_t rows = 0) : rows_(rows) {}
+
+        void set(size_t row, const std::string &column, const std::string &value);
+        // values in the order of keys, column names are prefix + key
+        void set(size_t row, const std::string &prefix, const std::vector<std::string> &keys,
+                 const std::vector<std::string> &values);
+        // columns of other (same rows), overwriting those of the same name
+        void merge(const SweepTable &other);
+
+        size_t rows() const { return rows_; }
+
+        // {"rows": N, "columns": {name: [value per row]}}, numbers as numbers,
+        // points that did not set a column as null
+        bool write(const std::string &filename) const;
+
+    private:
+        size_t rows_;
+        std::map<std::string, std::vector<std::string>> columns_;
+};
+
+#endif // KAYON_PARAM_SWEEP_HPP
@@ -0,0 +1,21 @@
+#ifndef KAYON_RE2_DFA_STATS_HPP
+#define KAYON_RE2_DFA_STATS_HPP
+
+#include <cstdint>
+
+// DFA events of RE2 on the calling thread, counted through re2::hooks. A
+// search failure means the DFA ran out of memory and RE2 fell back to the
+// much slower NFA; frequent cache resets precede it.
+struct Re2DfaCounters {
+    int64_t search_failures = 0;
+    int64_t cache_resets = 0;
+};
+
+// Install the hooks (process-wide, idempotent). Returns false when the RE2
+// library does not export them (e.g. a shared libre2 with a symbol map).
+bool installRe2DfaHooks();
+
+// Counters of the calling thread since it started, -1 without hooks.
+Re2DfaCounters threadRe2DfaCounters();
+
+#endif // KAYON_RE2_DFA_STATS_HPP
@@ -2,15 +2,20 @@
 #define KAYON_REGEX_PIPE_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <memory>
 #include <stdexcept>
 #include <re2/re2.h>
 
+#include "capture_columns.hpp"
+#include "literal_prefilter.hpp"
+#include "regex_common.hpp"
+
 class Re2Pipe {
 public:
     // Constructor takes the device identifier.
-    explicit Re2Pipe(const std::string& file_location);
+    explicit Re2Pipe(const std::string& file_location, RegexScanOptions options = {});
 
     // Initialization: precompile regexes and load file data into memory.
     void init();
@@ -21,14 +26,51 @@ public:
     // Cleanup: output the results.
     void cleanup();
 
+    // Compile the patterns with the RE2 options of the scan options.
+    static std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> compile(const std::vector<std::string>& patterns,
+                                                                            const RegexScanOptions& options);
+
+    // Per-query results, available after cleanup.
+    const std::vector<RegexQueryResult>& results() const { return results_; }
+
 private:
+    // Scan all lines (or distinct values) with one pattern, returns matching rows.
+    size_t scanPattern(size_t pattern_idx, bool use_prefilter, size_t& passed);
+
     int iters_;
-    size_t total_size_bytes_;
+    std::vector<RegexQuery> queries_;
     std::vector<std::string> patterns_;
-    std::vector<std::unique_ptr<RE2>> regexes_;
-    std::vector<std::string> lines_;
+    // Own copies by default, so threads do not share DFA caches
+    std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> regexes_;
     std::vector<double> full_match_durations_;
+    std::vector<size_t> match_counts_;
     std::string input_location_;
+
+    RegexScanOptions options_;
+
+    // Columns used by the queries, query_columns_[i] is the column of query i
+    std::vector<RegexColumn> columns_;
+    std::vector<size_t> query_columns_;
+    std::vector<uint8_t> value_hits_;
+    std::vector<uint8_t> row_hits_;
+
+    // Capture extraction: submatches of the current line, per distinct value
+    // groups in dictionary mode, and the columnar output of the last scan
+    std::vector<re2::StringPiece> submatches_;
+    std::vector<std::string_view> groups_;
+    std::vector<std::string_view> value_groups_;
+    CaptureColumns captures_;
+    std::vector<size_t> captured_bytes_;
+
+    // Literal prefilter and its per-query stats
+    std::unique_ptr<LiteralPrefilter> prefilter_;
+    std::vector<size_t> prefilter_passed_;
+
+    // DFA out-of-memory fallbacks and cache resets per query
+    std::vector<int64_t> dfa_fallbacks_;
+    std::vector<int64_t> dfa_resets_;
+
+    std::vector<RegexQueryResult> results_;
 };
 
 #endif // KAYON_REGEX_BENCHMARK_H
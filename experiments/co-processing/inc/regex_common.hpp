@@ -0,0 +1,112 @@
+#ifndef KAYON_REGEX_COMMON_HPP
+#define KAYON_REGEX_COMMON_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dict_column.hpp"
+
+namespace re2 {
+class RE2;
+}
+
+// Rows a worker scans, as fractions of the input rows: [begin, end).
+struct RowShare {
+    double begin = 0.0;
+    double end = 1.0;
+};
+
+// One CSV column as read from the input (header row dropped, '\r' stripped).
+struct CsvColumn {
+    int column_idx = 0;
+    size_t size_bytes = 0;
+    std::vector<std::string> lines;
+};
+
+// Optional scan strategies of the CPU regex engines.
+struct RegexScanOptions {
+    bool dictionary_encode = false; // run once per distinct line, expand through the codes
+    bool prefilter = false;         // skip lines missing a required literal of the pattern
+    bool vectored = false;          // vectorscan only: scan batches of lines per call
+    bool extract = false;           // RE2 only: materialize the capture groups of matching rows
+    std::string query_file;         // queries to run, empty runs defaultRegexQueries()
+    RowShare rows;                  // part of the input this pipe scans
+    std::string device = "cpu";     // device prefix in the report
+    int64_t re2_max_mem = 0;        // RE2 only: RE2::Options::set_max_mem, 0 keeps RE2's default
+    // RE2 only: regexes shared by all workers, null compiles per-pipe copies.
+    // Sharing makes the threads contend on the DFA cache locks.
+    std::shared_ptr<const std::vector<std::unique_ptr<re2::RE2>>> shared_re2;
+    // Columns parsed once before the rows are split, shared by all workers.
+    // Null makes each pipe parse the file itself.
+    std::shared_ptr<const std::vector<CsvColumn>> shared_columns;
+};
+
+// One regex query: "id, pattern[, column, full|partial]" in a query file.
+struct RegexQuery {
+    std::string id;
+    std::string pattern;
+    int column_idx = 9;     // CSV column the query runs on (Description)
+    bool full_match = true; // whole value must match, else any substring
+};
+
+// Per-query result of a CPU regex engine.
+struct RegexQueryResult {
+    std::string query_id;
+    size_t bytes;          // size of the scanned column
+    double dedup_ratio;    // rows / distinct values of the scanned column
+    double seconds;        // average scan time
+    size_t matches;        // matching rows
+    double prefilter_pass; // fraction of scanned lines that passed the prefilter
+    double saved_seconds;  // scan time saved by the prefilter
+    size_t captured_bytes; // bytes of extracted capture groups
+    int64_t dfa_fallbacks; // RE2 searches that ran out of DFA memory (NFA fallback), -1 unknown
+    int64_t dfa_resets;    // RE2 DFA state cache resets, -1 unknown
+};
+
+// Print the per-query results as CSV to stdout.
+void printRegexReport(const std::string& device, const std::vector<RegexQueryResult>& results);
+
+// Merge the per-query results of workers that scanned disjoint row ranges:
+// rows, bytes and captures add up, the time is the slowest worker's.
+std::vector<RegexQueryResult> mergeRegexResults(const std::vector<std::vector<RegexQueryResult>>& per_worker);
+
+// Queries of regex/us-accidents-queries.
+std::vector<RegexQuery> defaultRegexQueries();
+
+// Read a query file. Patterns may contain commas, the optional column and
+// match mode are only recognized as the last two fields.
+std::vector<RegexQuery> loadRegexQueries(const std::string& query_file);
+
+// Load one CSV column into memory (header row dropped, '\r' stripped).
+// Returns the total size of the loaded values in bytes.
+size_t loadCsvColumn(const std::string& file_location, int column_idx, std::vector<std::string>& lines);
+
+// Load every column the queries use in a single pass over the file, each
+// as loadCsvColumn would.
+std::vector<CsvColumn> loadCsvColumns(const std::string& file_location, const std::vector<RegexQuery>& queries);
+
+// One loaded CSV column, optionally dictionary-encoded.
+struct RegexColumn {
+    int column_idx = 0;
+    size_t size_bytes = 0;
+    std::vector<std::string> lines; // empty once encoded
+    DictColumn dict;
+    bool encoded = false;
+
+    // values a scan runs over: the lines or the distinct values
+    const std::vector<std::string>& scanned() const { return encoded ? dict.values() : lines; }
+    size_t numRows() const { return encoded ? dict.numRows() : lines.size(); }
+    double dedupRatio() const { return encoded ? dict.dedupRatio() : 1.0; }
+};
+
+// Load every column the queries use once, query_columns[i] is the index of
+// the column of query i in the returned vector. Only the rows in the share
+// are kept, shares that tile [0, 1) split the rows without gaps or overlap.
+// Columns found in parsed are copied from there instead of read from the file.
+std::vector<RegexColumn> loadQueryColumns(const std::string& file_location, const std::vector<RegexQuery>& queries,
+                                          bool dictionary_encode, std::vector<size_t>& query_columns,
+                                          RowShare share = {}, const std::vector<CsvColumn>* parsed = nullptr);
+
+#endif // KAYON_REGEX_COMMON_HPP
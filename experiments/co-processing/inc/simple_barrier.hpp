@@ -1,9 +1,12 @@
+#ifndef KAYON_SIMPLE_BARRIER_HPP
+#define KAYON_SIMPLE_BARRIER_HPP
+
 #include <mutex>
 #include <condition_variable>
 
 class SimpleBarrier {
 public:
-    explicit SimpleBarrier(unsigned int count) : m_count(count), m_generation(0) {}
+    explicit SimpleBarrier(unsigned int count) : m_threads(count), m_count(count), m_generation(0) {}
 
     void arrive_and_wait() {
         std::unique_lock<std::mutex> lock(m_mutex);
@@ -11,7 +14,8 @@ public:
 
         // Decrement the remaining arrivals
         if (--m_count == 0) {
-            // All threads reached the barrier
+            // All threads reached the barrier, re-arm it for the next round
+            m_count = m_threads;
             m_generation++;
             m_cond.notify_all();
         } else {
@@ -23,6 +27,9 @@ public:
 private:
     std::mutex m_mutex;
     std::condition_variable m_cond;
+    const unsigned int m_threads;
     unsigned int m_count;
     unsigned int m_generation;
 };
+
+#endif // KAYON_SIMPLE_BARRIER_HPP
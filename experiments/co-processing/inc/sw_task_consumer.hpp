@@ -0,0 +1,140 @@
+#ifndef KAYON_SW_TASK_CONSUMER_HPP
+#define KAYON_SW_TASK_CONSUMER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "checksum.hpp"
+#include "chunk_retry.hpp"
+#include "codec_task.hpp"
+#include "compressibility.hpp"
+#include "init_timings.hpp"
+#include "sw_task_executor.hpp"
+#include "task_buffers.hpp"
+
+// Pool size and latency model of the emulated accelerator
+struct SwExecutorConfig {
+    size_t threads = 4;
+    SwLatencyModel model;
+};
+
+// Called with the task id (block index), output data and length of every completed block
+using sw_block_handler = std::function<void(size_t, const uint8_t*, size_t)>;
+
+// Software stand-in for DocaTaskConsumer: the same constructors, lifecycle
+// and result timings, the tasks run on SwTaskExecutor instead of the DPU.
+// Runs the drivers on machines without a BlueField and serves as their
+// fallback when no device can be opened.
+template <typename Task>
+class SwTaskConsumer : protected TaskBuffers<Task> {
+        using Buffers = TaskBuffers<Task>;
+
+    public:
+        using DEVICE_TYPE = typename Buffers::DEVICE_TYPE;
+
+        // split_input: buffers are sized from the file
+        explicit SwTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, bool init = true,
+                                SwExecutorConfig config = {})
+            requires (Task::split_input);
+
+        // asked_num_buffers input buffers of asked_buffer_size bytes, original_file_size bytes of output
+        explicit SwTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, uint64_t asked_num_buffers,
+                                size_t original_file_size, bool init = true, SwExecutorConfig config = {})
+            requires (!Task::split_input);
+
+        ~SwTaskConsumer();
+
+        std::string getName();
+
+        // 1. read the input, prepare buffers, tasks and the pool
+        void initDocaContext();
+
+        // 2. submit all tasks and busy-wait for their completion
+        void executeDocaTask();
+
+        // 3. stop the pool and return the timings, same order as DocaTaskConsumer::getDocaResults
+        std::vector<std::string> getDocaResults();
+
+        // keep the pool for another run, see DocaTaskConsumer::keepAlive
+        void keepAlive(bool keep) { this->keep_alive_ = keep; }
+
+        // consume each block as it completes, set before executeDocaTask
+        void setBlockHandler(sw_block_handler handler);
+
+        // failed tasks are redone in a worst-case sized buffer, as in DocaTaskConsumer
+        // (the timeout does not apply, the pool does not stall)
+        void setRetryPolicy(RetryPolicy policy) { retrier_.setPolicy(policy); }
+        // deflate: incompressible chunks are stored, as in DocaTaskConsumer
+        void setBypass(CompressibilityEstimator estimator) { estimator_ = estimator; }
+        // check the checksums the executor reports per task, as DocaTaskConsumer::setVerify
+        void setVerify(bool verify) { checksums_.setEnabled(verify); }
+        const ChecksumVerifier &checksumVerifier() const { return checksums_; }
+        const std::vector<ChunkEngine> &chunkEngines() const { return retrier_.engines(); }
+        const RetryCounters &retryCounters() const { return retrier_.counters(); }
+        // the stages the pool has (file, buffers, tasks, its start as the context), see DocaTaskConsumer::initTimings
+        const InitTimings &initTimings() const { return init_timings_; }
+
+        // Engine lifecycle (engine.hpp), init is skipped if the constructor did it
+        void init();
+        void execute();
+        void cleanup();
+
+        // the software tasks are reused as they are, see DocaTaskConsumer::rearm
+        void rearm() {}
+
+        // see DocaTaskConsumer::reserveTasks and DocaTaskConsumer::reshape
+        void reserveTasks(uint32_t slots) { this->task_slots = slots; }
+        bool reshape(size_t bytes, uint64_t buffer_size, uint64_t max_buffers)
+            requires (Task::split_input);
+        uint32_t numTasks() const { return this->num_buffers; }
+        uint64_t bufferSize() const { return this->input_buff_size; }
+
+        bool ready() const { return ready_; }
+
+        // user+sys seconds of the pool and retry threads (the polling thread is in getDocaResults)
+        double workerCpuSeconds() const;
+
+    protected:
+        static void completedCallback(SwTask *task, void *ctx_user_data);
+        static void errorCallback(SwTask *task, void *ctx_user_data);
+
+        void releaseResources();
+
+        // one task per buffer, laid out as the DOCA tasks
+        void layoutTasks();
+
+        SwExecutorConfig config_;
+        std::unique_ptr<SwTaskExecutor> executor_;
+        std::vector<SwTask> tasks_;
+        sw_block_handler block_handler_;
+        ChunkRetrier retrier_{Task::codec};
+        CompressibilityEstimator estimator_;
+        ChecksumVerifier checksums_;
+        InitTimings init_timings_;
+        size_t completed_ = 0;
+
+        bool initialized = false;
+        bool ready_ = false;
+        bool released = false;
+        bool keep_alive_ = false;
+
+        // time counters
+        std::chrono::steady_clock::time_point submit_start, submit_end, busy_wait_end, last_callback,
+            ctx_stop_start, ctx_stop_end;
+        double thread_time_start = 0.0, thread_time_end = 0.0;
+};
+
+using SwCompressConsumer = SwTaskConsumer<CompressDeflateTask>;
+using SwDecompressDeflateConsumer = SwTaskConsumer<DecompressDeflateTask>;
+using SwDecompressLz4Consumer = SwTaskConsumer<DecompressLz4Task>;
+
+// Instantiated in sw_task_consumer.cpp
+extern template class SwTaskConsumer<CompressDeflateTask>;
+extern template class SwTaskConsumer<DecompressDeflateTask>;
+extern template class SwTaskConsumer<DecompressLz4Task>;
+
+#endif // KAYON_SW_TASK_CONSUMER_HPP
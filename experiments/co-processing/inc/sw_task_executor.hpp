@@ -0,0 +1,103 @@
+#ifndef KAYON_SW_TASK_EXECUTOR_HPP
+#define KAYON_SW_TASK_EXECUTOR_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "codec_task.hpp"
+
+// Service time of one emulated task: fixed latency plus bytes at a given
+// rate (plaintext bytes, as the accelerator numbers are reported). A task
+// never completes faster than the model, a zero model runs at CPU speed.
+struct SwLatencyModel {
+    double task_latency_us = 0.0;
+    double mib_per_s = 0.0;
+
+    double serviceSeconds(size_t plaintext_bytes) const;
+};
+
+// One emulated compress task, the counterpart of a doca_compress task
+struct SwTask {
+    TaskCodec codec;
+    const uint8_t *src;
+    size_t src_len;
+    uint8_t *dst;
+    size_t dst_cap;
+    size_t dst_len = 0;
+    bool failed = false;
+    uint64_t user_data = 0;
+    // report the checksums of the uncompressed side, as the device does
+    bool checksums = false;
+    uint32_t crc_cs = 0;
+    uint32_t second_cs = 0;
+};
+
+// Called on the thread that calls progress(), like the DOCA task callbacks
+using sw_task_callback = void (*)(SwTask *task, void *ctx_user_data);
+
+// Software stand-in for a doca_compress context on a doca_pe: tasks are
+// submitted from the polling thread, run on a pool of background threads,
+// and their callbacks run inside progress() on the polling thread.
+class SwTaskExecutor {
+    public:
+        explicit SwTaskExecutor(size_t num_threads, SwLatencyModel model = {});
+        ~SwTaskExecutor();
+
+        // callbacks and the most tasks in flight, as doca_compress_task_*_set_conf
+        void setConf(sw_task_callback completed, sw_task_callback failed, uint32_t num_tasks,
+                     void *ctx_user_data);
+
+        // start the pool, as doca_ctx_start
+        void start();
+
+        // false if not started or num_tasks are already in flight
+        bool submit(SwTask *task);
+
+        // run the callback of one finished task, 1 if there was one, as doca_pe_progress
+        uint8_t progress();
+
+        // drain the in-flight tasks and join the pool, as doca_ctx_stop plus its progress
+        void stop();
+
+        size_t inflight() const { return inflight_; }
+
+        // user+sys seconds the pool threads spent, the host cost of the emulated offload
+        double workerCpuSeconds() const;
+
+        // Run a codec on one task without the pool, false on corrupt input or a full dst
+        static bool runCodec(SwTask &task);
+
+        // Most bytes a codec can write for src_len input, dst_cap is the expected
+        // output (deflate grows incompressible input past it)
+        static size_t outputBound(TaskCodec codec, size_t src_len, size_t dst_cap);
+
+    private:
+        void workerLoop();
+
+        size_t num_threads_;
+        SwLatencyModel model_;
+        sw_task_callback completed_cb_ = nullptr;
+        sw_task_callback failed_cb_ = nullptr;
+        uint32_t max_tasks_ = 0;
+        void *ctx_user_data_ = nullptr;
+
+        std::vector<std::thread> workers_;
+        std::mutex submit_mutex_;
+        std::condition_variable submit_cond_;
+        std::deque<SwTask*> submitted_;
+        bool stopping_ = false;
+        bool running_ = false;
+
+        std::mutex done_mutex_;
+        std::deque<SwTask*> done_;
+        size_t inflight_ = 0;
+
+        std::atomic<uint64_t> worker_cpu_ns_{0};
+};
+
+#endif // KAYON_SW_TASK_EXECUTOR_HPP
@@ -0,0 +1,118 @@
+#ifndef KAYON_TASK_BUFFERS_HPP
+#define KAYON_TASK_BUFFERS_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <string>
+
+#include "codec_task.hpp"
+
+#define USER_MAX_FILE_NAME 255                 /* Max file name length */
+#define MAX_FILE_NAME (USER_MAX_FILE_NAME + 1) /* Max file name string length */
+#define BUFFER_SIZE_BF2 134217728 /* Max buffer size in bytes -- BF2 */
+#define BUFFER_SIZE_BF3 2097152 /* Max buffer size in bytes -- BF3 */
+
+struct region {
+    uint8_t *base;
+    uint32_t size;
+};
+
+// Tasks that cut a share of the input, as prepareBuffersAndRegions does
+struct PrefixLayout {
+    uint32_t tasks = 0;
+    uint64_t buffer_size = 0;
+};
+
+// bytes cut into buffers of buffer_size (0 or above max_buf_size: max_buf_size),
+// at most max_buffers of them (0: no limit). A share larger than one buffer
+// drops its partial last buffer, as a split file does.
+PrefixLayout prefixLayout(size_t bytes, uint64_t buffer_size, uint64_t max_buffers, uint64_t max_buf_size);
+
+// Input file and aligned input/output buffers of one batch of offloaded
+// tasks. Shared by the DOCA consumer and its software stand-in, so both cut
+// a file into the same tasks.
+template <typename Task>
+class TaskBuffers {
+    public:
+        enum DEVICE_TYPE { BF2, BF3 };
+
+    protected:
+        // device limits only, the caller sizes the buffers
+        explicit TaskBuffers(DEVICE_TYPE dev_type);
+
+        // split_input: buffers are sized from the file
+        TaskBuffers(DEVICE_TYPE dev_type, uint64_t asked_buffer_size)
+            requires (Task::split_input);
+
+        // asked_num_buffers input buffers of asked_buffer_size bytes, original_file_size bytes of output
+        TaskBuffers(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, uint64_t asked_num_buffers,
+                    size_t original_file_size)
+            requires (!Task::split_input);
+
+        // open and read input file size
+        bool readFile();
+
+        // instead of readFile: buffers for up to capacity input bytes that
+        // loadInput fills later (pooled consumers, DocaContextPool)
+        void reserveInput(size_t capacity);
+
+        // determine buffers and regions, read the input into them
+        bool prepareBuffersAndRegions();
+
+        // free the buffers, idempotent
+        void releaseBuffers();
+
+        // lay out the first bytes of the loaded input as tasks (prefixLayout)
+        // in the memory and task slots prepared at init, false if they do not
+        // fit. Only split_input sizes the output buffers after the input ones.
+        bool layoutPrefix(size_t bytes, uint64_t buffer_size, uint64_t max_buffers);
+
+        // copy bytes of a job's input into the registered buffers and lay
+        // them out in buffers of the size prepared at init, false if they do not fit
+        bool loadInput(const uint8_t *data, size_t bytes);
+
+        // get diff of two time points
+        static std::string calculateSeconds(const std::chrono::steady_clock::time_point end,
+                                            const std::chrono::steady_clock::time_point start);
+
+        char input_file_path[MAX_FILE_NAME];  /* File to compress/decompress */
+        char output_file_path[MAX_FILE_NAME];    /* Output file */
+        FILE *ifp = NULL;
+        size_t input_file_size = 0, original_file_size = 0;
+
+        // buffer related limits
+        uint32_t num_buffers = 2;
+
+        uint64_t max_buf_size = std::numeric_limits<uint64_t>::min();
+        uint64_t output_buffer_size = std::numeric_limits<uint64_t>::min();
+        uint64_t input_buff_size = std::numeric_limits<uint64_t>::min();
+
+        // false if the asked buffers exceed the device limit
+        bool valid_size = true;
+
+        // tasks the context, inventory and regions are sized for, at least
+        // num_buffers (set before init to lay out more tasks later)
+        uint32_t task_slots = 0;
+        // input bytes in the registered buffers, after prepareBuffersAndRegions
+        size_t buffer_capacity = 0;
+        // input buffer size of prepareBuffersAndRegions, loadInput cuts with it
+        uint64_t prepared_buffer_size = 0;
+
+        // Allocate aligned memory using posix_memalign on indata/outdata.
+        uint8_t *indata = nullptr;
+        uint8_t *outdata = nullptr;
+        // memory areas with input/output raw data and their pointers
+        region *region_buffer = nullptr;
+
+    private:
+        void setDeviceLimits(DEVICE_TYPE dev_type);
+};
+
+// Instantiated in task_buffers.cpp
+extern template class TaskBuffers<CompressDeflateTask>;
+extern template class TaskBuffers<DecompressDeflateTask>;
+extern template class TaskBuffers<DecompressLz4Task>;
+
+#endif // KAYON_TASK_BUFFERS_HPP
@@ -0,0 +1,91 @@
+#ifndef KAYON_TRIAL_STATS_HPP
+#define KAYON_TRIAL_STATS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json_fwd.hpp>
+
+// Repeated trials of a worker: warmup runs on the initialized engine that
+// are not recorded, then measured runs. Both workers of a driver run the
+// same number of trials, in lockstep through their barriers.
+struct TrialOptions {
+    size_t warmup = 0;
+    size_t repeat = 1;
+    // bootstrap resamples and level of the confidence interval of the median
+    size_t resamples = 2000;
+    double confidence = 0.95;
+
+    size_t runs() const { return warmup + repeat; }
+    // more than the one measured run the JSON has always held
+    bool repeated() const { return runs() > 1; }
+
+    // Parse --warmup N, --repeat M at argv[idx], false if not one of them
+    bool parseFlag(int argc, char **argv, int &idx);
+
+    static constexpr const char *usage = "[--warmup N] [--repeat M]";
+};
+
+// Summary of one metric over the measured runs
+struct TrialSummary {
+    size_t n = 0;
+    double mean = 0;
+    double median = 0;
+    double p5 = 0;
+    double p95 = 0;
+    // sample standard deviation (n - 1)
+    double stddev = 0;
+    // percentile bootstrap interval of the median
+    double ci_low = 0;
+    double ci_high = 0;
+};
+
+// Quantile q in [0, 1] of sorted samples, linear between the closest ranks
+double sortedQuantile(const std::vector<double> &sorted, double q);
+
+TrialSummary summarizeTrials(std::vector<double> samples, size_t resamples, double confidence, uint64_t seed = 1);
+
+// Collects the result values of each measured run, in the order of the
+// result keys of the driver, and summarizes the timings (keys ending in
+// "elapsed") for the results JSON.
+class TrialRecorder {
+    public:
+        explicit TrialRecorder(TrialOptions options = {}) : options_(options) {}
+
+        // values of one measured run, non-numeric ones are skipped
+        void add(const std::vector<std::string> &values);
+        size_t runs() const { return runs_; }
+
+        // summaries of the timings (keys ending in "elapsed") that have samples
+        std::vector<std::pair<std::string, TrialSummary>> summaries(const std::vector<std::string> &keys) const;
+
+        // {"warmup", "repeat", "confidence", "metrics": {key: summary and samples}},
+        // null if there were no repeated trials
+        nlohmann::json toJson(const std::vector<std::string> &keys) const;
+
+    private:
+        TrialOptions options_;
+        size_t runs_ = 0;
+        // per value position, the samples of the measured runs
+        std::vector<std::vector<double>> samples_;
+};
+
+// Runs run() once per trial, warmup runs first, and records the measured
+// ones. run() goes from the start to the end barrier and returns the result
+// values of that run; the last run's values are returned for the JSON.
+template <typename Run>
+std::vector<std::string> runTrials(const TrialOptions &options, TrialRecorder &recorder, Run &&run) {
+    std::vector<std::string> results;
+    for (size_t trial = 0; trial < options.runs(); ++trial) {
+        results = run();
+        if (trial >= options.warmup) {
+            recorder.add(results);
+        }
+    }
+    return results;
+}
+
+#endif // KAYON_TRIAL_STATS_HPP
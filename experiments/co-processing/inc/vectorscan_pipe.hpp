@@ -0,0 +1,71 @@
+#ifndef KAYON_VECTORSCAN_PIPE_HPP
+#define KAYON_VECTORSCAN_PIPE_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <hs/hs.h>
+
+#include "literal_prefilter.hpp"
+#include "regex_common.hpp"
+
+// Vectorscan (Hyperscan on x86) counterpart of Re2Pipe, same lifecycle and report.
+class VectorscanPipe {
+public:
+    explicit VectorscanPipe(const std::string& file_location, RegexScanOptions options = {});
+
+    ~VectorscanPipe();
+
+    // Initialization: compile one database per query and load file data into memory.
+    void init();
+
+    // Execute processing: benchmark the queries.
+    void execute();
+
+    // Cleanup: output the results.
+    void cleanup();
+
+    // Per-query results, available after cleanup.
+    const std::vector<RegexQueryResult>& results() const { return results_; }
+
+private:
+    // Scan all lines (or distinct values) with one database, returns matching rows.
+    size_t scanPattern(size_t pattern_idx, bool use_prefilter, size_t& passed, hs_scratch_t* scratch);
+
+    // block mode: one hs_scan per line
+    void scanLines(const std::vector<std::string>& rows, hs_database_t* database, bool use_prefilter,
+                   size_t pattern_idx, size_t& passed, hs_scratch_t* scratch);
+
+    // vectored mode: one hs_scan_vector per batch of newline-separated lines
+    void scanBatches(const std::vector<std::string>& rows, hs_database_t* database, bool use_prefilter,
+                     size_t pattern_idx, size_t& passed, hs_scratch_t* scratch);
+
+    int iters_;
+    std::vector<RegexQuery> queries_;
+    std::vector<std::string> patterns_;
+    std::vector<hs_database_t*> databases_;
+    // Prototype scratch, every executing thread works on its own clone
+    hs_scratch_t* scratch_ = nullptr;
+    std::vector<double> full_match_durations_;
+    std::vector<size_t> match_counts_;
+    std::string input_location_;
+
+    RegexScanOptions options_;
+
+    // Columns used by the queries, query_columns_[i] is the column of query i
+    std::vector<RegexColumn> columns_;
+    std::vector<size_t> query_columns_;
+
+    // Per scanned line (or distinct value) hit flags, expanded to rows with the dictionary
+    std::vector<uint8_t> value_hits_;
+    std::vector<uint8_t> row_hits_;
+
+    // Literal prefilter and its per-query stats
+    std::unique_ptr<LiteralPrefilter> prefilter_;
+    std::vector<size_t> prefilter_passed_;
+
+    std::vector<RegexQueryResult> results_;
+};
+
+#endif // KAYON_VECTORSCAN_PIPE_HPP
@@ -10,6 +10,8 @@
 class Zpipe {
   public:
     Zpipe();
+    // with the incompressible bypass set, see set_incompressible_bypass
+    explicit Zpipe(bool incompressible_bypass);
 
     // 1) Init: prepare single buffer (or multiple chunks otherwise) from disk
     int deflate_init(const std::string &inFilename, const std::string &outFilename, bool singleBufferExecution = true); // compress init
@@ -20,6 +22,12 @@ class Zpipe {
     int deflate_execute_single_buffer();
     int inflate_execute_single_buffer();
 
+    // Deflate input the estimator finds incompressible as stored blocks (level 0), off by default
+    void set_incompressible_bypass(bool enabled) { m_bypassIncompressible = enabled; }
+
+    // Deflate only the first bytes of the input in the single-buffer run (0: all of it), for in-process sweeps
+    void set_input_limit(size_t bytes) { m_inputLimit = bytes; }
+
     // 3) Cleanup: finalize/close z_stream, close files, reset state.
     void deflate_cleanup();
     void inflate_cleanup();
@@ -58,5 +66,7 @@ class Zpipe {
     FILE* m_outFile;
     z_stream stream;
     int m_deflateLevel;
+    bool m_bypassIncompressible = false;
+    size_t m_inputLimit = 0;
 };
 #endif
\ No newline at end of file
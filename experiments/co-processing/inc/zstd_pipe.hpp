@@ -0,0 +1,92 @@
+#ifndef KAYON_ZSTD_PIPE_HPP
+#define KAYON_ZSTD_PIPE_HPP
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <zstd.h>
+
+// Compression parameters of the zstd engine, from the driver flags
+struct ZstdOptions {
+    bool enabled = false;
+    int level = 3;
+    // long-distance matching, window_log 0 keeps zstd's default window for it
+    bool long_distance = false;
+    int window_log = 0;
+    // zstd's own worker threads (ZSTD_c_nbWorkers), 0 compresses on the calling thread
+    int workers = 0;
+
+    // consume one flag at argv[idx] (and its value), false if it is not a zstd flag
+    bool parseFlag(int argc, char **argv, int &idx) {
+        std::string flag = argv[idx];
+        if (flag == "--zstd") {
+            enabled = true;
+        } else if (flag == "--zstd-level" && idx + 1 < argc) {
+            level = std::stoi(argv[++idx]);
+        } else if (flag == "--zstd-long") {
+            long_distance = true;
+        } else if (flag == "--zstd-window-log" && idx + 1 < argc) {
+            window_log = std::stoi(argv[++idx]);
+        } else if (flag == "--zstd-workers" && idx + 1 < argc) {
+            workers = std::stoi(argv[++idx]);
+        } else {
+            return false;
+        }
+        return true;
+    }
+
+    static constexpr const char *usage = "[--zstd] [--zstd-level N] [--zstd-long] [--zstd-window-log N] "
+                                         "[--zstd-workers N]";
+};
+
+// zstd counterpart of Zpipe and LZ4Pipe: the whole file in one buffer, one
+// frame, same init/execute/cleanup split. All calls return 0 on success.
+class ZstdPipe {
+public:
+    explicit ZstdPipe(ZstdOptions options = {});
+    ~ZstdPipe();
+
+    // 1) compress_init: read the input file, set up the context
+    int compress_init(const std::string &inputFile, const std::string &outputFile);
+
+    // 2) compress_execute: compress the in-memory input into one frame
+    int compress_execute();
+
+    // 3) compress_cleanup: write the frame to disk and clear the buffers
+    void compress_cleanup();
+
+    // 1) decompress_init: read the (uncompressed) input and compress it in memory
+    int decompress_init(const std::string &inputFile, const std::string &outputFile);
+
+    // 2) decompress_execute: decompress the in-memory frame
+    int decompress_execute();
+
+    // 3) decompress_cleanup: write the decompressed data to disk and clear the buffers
+    void decompress_cleanup();
+
+    // set before init
+    void set_options(ZstdOptions options) { m_options = options; }
+    const ZstdOptions &options() const { return m_options; }
+
+private:
+    int readInputFile(const std::string &filename);
+    int openOutputFile(const std::string &filename);
+    // apply m_options to m_cctx
+    int configure();
+    void writeOutput(const std::vector<char> &data, size_t size);
+    void reset();
+
+    ZstdOptions m_options;
+    ZSTD_CCtx *m_cctx = nullptr;
+    ZSTD_DCtx *m_dctx = nullptr;
+
+    std::vector<char> m_originalData;
+    std::vector<char> m_compressedData;
+    size_t m_compressedSize = 0;
+    std::vector<char> m_decompressedData;
+
+    FILE *m_outFile = nullptr;
+};
+
+#endif // KAYON_ZSTD_PIPE_HPP
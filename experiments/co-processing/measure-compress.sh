@@ -2,6 +2,8 @@
 
 # Initialize the arm flag to false
 arm=false
+# One process per file for the whole split grid (--sweep), instead of one per split
+sweep=false
 
 # Parse arguments
 while [[ $# -gt 0 ]]; do
@@ -10,6 +12,10 @@ while [[ $# -gt 0 ]]; do
       arm=true
       shift
       ;;
+    --sweep)
+      sweep=true
+      shift
+      ;;
     *)
       # If you have other arguments, handle them here
       shift
@@ -43,6 +49,18 @@ find ../local-compress/corpora/silesia -type d -name ".git" -prune -o -type f !
     filesize=$(stat -c '%s' $file)
     filesize=2097152 # only runs on bf2, max is 2 MiB
 
+    if $sweep; then
+        # both shares are cut from the front of the same copy, as the truncated ones below
+        cp $file /dev/shm/deflt-input # cpu
+        cp $file /dev/shm/input.deflate # doca
+        truncate -s "$filesize" /dev/shm/deflt-input
+        truncate -s "$filesize" /dev/shm/input.deflate
+
+        ./build/co-processing-compress 0 0 --sweep-split 0,10,20,30,40,50,60,70,80,90,100 \
+            --sweep-out results-$filename-sweep-compress.json >> /dev/null
+        continue
+    fi
+
     # Loop over percentage pairs
     for (( i=0, j=100; i<=100; i+=10, j-=10 )); do
         # Calculate sizes
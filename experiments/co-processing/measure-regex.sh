@@ -1,5 +1,8 @@
 #!/bin/bash
 
+# extra engine flags, e.g. REGEX_ARGS="--engine vectorscan --vectored --prefilter" or "--inflate-chunk 256"
+REGEX_ARGS=${REGEX_ARGS:-}
+
 # create results dir
 rm -rf results/doca ; mkdir -p results ; mkdir -p results/doca
 
@@ -12,24 +15,18 @@ find ../regex/data/ -type d -name ".git" -prune -o -type f ! -name "README.md" -
     fi
     filesize=$(stat -c '%s' $file)
 
+    # all workers read the same input and split its rows by percentage
+    cp $file /dev/shm/regex-input
+
     # Loop over percentage pairs
     for (( i=0, j=100; i<=100; i+=10, j-=10 )); do
-        # Calculate sizes
+        # Approximate bytes per share (the split is by rows)
         SIZE_CPU=$(( filesize * j / 100 ))
         SIZE_DPU=$(( filesize * i / 100 ))
 
-        # Create temp copies and truncate
-        cp $file /dev/shm/cpu-regex # cpu
-        cp $file /dev/shm/dpu-regex # doca
-        
-        truncate -s "$SIZE_CPU" /dev/shm/cpu-regex
-        truncate -s "$SIZE_DPU" /dev/shm/dpu-regex
-
-        ./build/co-processing-regex $j $i $SIZE_DPU >> /dev/null
-        mv results-cpu-regex.json results-$j-$i-$filename-cpu-regex.json
-        mv results-doca-regex.json results-$j-$i-$filename-doca-regex.json
-        compressed_filesize_cpu=$(stat -c '%s' /dev/shm/cpu-regex)
-        compressed_filesize_dpu=$(stat -c '%s' /dev/shm/dpu-regex)
-        echo $compressed_filesize_cpu $compressed_filesize_dpu $filesize >> results-$j-$i-$filename.size
+        ./build/co-processing-regex $j $i $SIZE_DPU $REGEX_ARGS >> /dev/null
+        [ -f results-cpu-regex.json ] && mv results-cpu-regex.json results-$j-$i-$filename-cpu-regex.json
+        [ -f results-doca-regex.json ] && mv results-doca-regex.json results-$j-$i-$filename-doca-regex.json
+        echo $SIZE_CPU $SIZE_DPU $filesize >> results-$j-$i-$filename.size
     done
 done
@@ -0,0 +1,164 @@
+#include "adaptive_codec.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "lz4.h"
+#include "sw_task_executor.hpp"
+#include "zlib.h"
+
+bool parseDecodeTarget(const std::string &name, DecodeTarget &target) {
+    if (name == "host") {
+        target = DecodeTarget::HOST;
+    } else if (name == "bf2") {
+        target = DecodeTarget::BF2;
+    } else if (name == "bf3") {
+        target = DecodeTarget::BF3;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static double mibPerSecond(size_t bytes, std::chrono::steady_clock::duration elapsed) {
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    return seconds > 0.0 ? bytes / (seconds * 1048576.0) : 0.0;
+}
+
+CodecChoice CodecSelector::choose(const uint8_t *data, size_t len) const {
+    CodecChoice choice{ChunkCodec::STORED, 1.0, 1.0, 0.0, 0.0};
+    if (len == 0 || this->estimator.incompressible(data, len)) {
+        return choice;
+    }
+
+    // the windows the estimator samples, evenly spread over the chunk
+    size_t window = std::min(std::max<size_t>(this->estimator.window_bytes, 1), len);
+    size_t windows = std::max<size_t>(1, std::min(this->estimator.sample_bytes / window, len / window));
+    size_t stride = windows > 1 ? (len - window) / (windows - 1) : 0;
+    size_t sampled = windows * window;
+
+    std::vector<uint8_t> out(std::max<size_t>(LZ4_compressBound(static_cast<int>(window)),
+                                              compressBound(static_cast<uLong>(window))));
+
+    // a BF2 cannot decompress LZ4 blocks, only deflate is tried for it
+    bool lz4_allowed = this->budget.target != DecodeTarget::BF2;
+    size_t lz4_bytes = lz4_allowed ? 0 : sampled;
+    auto lz4_start = std::chrono::steady_clock::now();
+    for (size_t w = 0; lz4_allowed && w < windows; ++w) {
+        const char *begin = reinterpret_cast<const char*>(data + w * stride);
+        int size = LZ4_compress_default(begin, reinterpret_cast<char*>(out.data()), static_cast<int>(window),
+                                        static_cast<int>(out.size()));
+        lz4_bytes += size > 0 ? static_cast<size_t>(size) : window;
+    }
+    auto lz4_end = std::chrono::steady_clock::now();
+
+    // the level the software executor and the hardware use
+    size_t deflate_bytes = 0;
+    for (size_t w = 0; w < windows; ++w) {
+        SwTask task{TaskCodec::DEFLATE, data + w * stride, window, out.data(), out.size()};
+        deflate_bytes += SwTaskExecutor::runCodec(task) ? task.dst_len : window;
+    }
+    auto deflate_end = std::chrono::steady_clock::now();
+
+    choice.lz4_ratio = static_cast<double>(lz4_bytes) / sampled;
+    choice.deflate_ratio = static_cast<double>(deflate_bytes) / sampled;
+    choice.lz4_mib_s = mibPerSecond(sampled, lz4_end - lz4_start);
+    choice.deflate_mib_s = mibPerSecond(sampled, deflate_end - lz4_end);
+    if (choice.lz4_ratio >= 1.0 && choice.deflate_ratio >= 1.0) {
+        return choice;
+    }
+    if (!lz4_allowed) {
+        choice.codec = ChunkCodec::DEFLATE;
+        return choice;
+    }
+
+    bool deflate_denser = choice.deflate_ratio * (1.0 + this->budget.max_ratio_loss) < choice.lz4_ratio ||
+                          choice.lz4_ratio >= 1.0;
+    bool lz4_fast_enough = this->budget.target_mib_s <= 0.0 || choice.lz4_mib_s >= this->budget.target_mib_s;
+    bool deflate_fast_enough = this->budget.target_mib_s <= 0.0 || choice.deflate_mib_s >= this->budget.target_mib_s;
+
+    // neither meets the target: the faster one
+    choice.codec = deflate_fast_enough && (deflate_denser || !lz4_fast_enough) ? ChunkCodec::DEFLATE : ChunkCodec::LZ4;
+    return choice;
+}
+
+AdaptiveCompressEngine::AdaptiveCompressEngine(const std::string &input_file, const std::string &output_file,
+                                               size_t chunk_size, CodecSelector selector)
+    : input_file_(input_file), output_file_(output_file), chunk_size_(chunk_size), selector_(selector) {
+    if (this->chunk_size_ == 0 || this->chunk_size_ > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+        throw std::invalid_argument("Adaptive chunk size out of range: " + std::to_string(chunk_size));
+    }
+}
+
+void AdaptiveCompressEngine::init() {
+    std::ifstream in(this->input_file_, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed init cpu-compress-adaptive of " + this->input_file_);
+    }
+    this->input_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    size_t bound = std::max<size_t>(LZ4_compressBound(static_cast<int>(this->chunk_size_)),
+                                    compressBound(static_cast<uLong>(this->chunk_size_)));
+    this->scratch_.resize(bound);
+    size_t chunk_count = (this->input_.size() + this->chunk_size_ - 1) / this->chunk_size_;
+    this->output_.reserve(CHUNK_CONTAINER_HEADER_SIZE + chunk_count * CHUNK_HEADER_SIZE + this->input_.size());
+}
+
+void AdaptiveCompressEngine::execute() {
+    size_t chunk_count = (this->input_.size() + this->chunk_size_ - 1) / this->chunk_size_;
+    this->output_.clear();
+    this->chunk_counts_ = {};
+    writeContainerHeader(this->output_, static_cast<uint32_t>(this->chunk_size_), chunk_count);
+
+    for (size_t offset = 0; offset < this->input_.size(); offset += this->chunk_size_) {
+        const uint8_t *chunk = this->input_.data() + offset;
+        size_t len = std::min(this->chunk_size_, this->input_.size() - offset);
+
+        ChunkCodec codec = this->selector_.choose(chunk, len).codec;
+        size_t payload = 0;
+        if (codec == ChunkCodec::LZ4) {
+            int size = LZ4_compress_default(reinterpret_cast<const char*>(chunk),
+                                            reinterpret_cast<char*>(this->scratch_.data()), static_cast<int>(len),
+                                            static_cast<int>(this->scratch_.size()));
+            payload = size > 0 ? static_cast<size_t>(size) : 0;
+        } else if (codec == ChunkCodec::DEFLATE) {
+            SwTask task{TaskCodec::DEFLATE, chunk, len, this->scratch_.data(), this->scratch_.size()};
+            payload = SwTaskExecutor::runCodec(task) ? task.dst_len : 0;
+        }
+
+        // the sample can be wrong about the rest of the chunk
+        if (codec == ChunkCodec::STORED || payload == 0 || payload >= len) {
+            codec = ChunkCodec::STORED;
+            appendChunk(this->output_, codec, static_cast<uint32_t>(len), chunk, static_cast<uint32_t>(len));
+        } else {
+            appendChunk(this->output_, codec, static_cast<uint32_t>(len), this->scratch_.data(),
+                        static_cast<uint32_t>(payload));
+        }
+        ++this->chunk_counts_[static_cast<size_t>(codec)];
+    }
+}
+
+bool AdaptiveCompressEngine::verify() const {
+    std::vector<uint8_t> plain;
+    if (!decodeContainer(this->output_.data(), this->output_.size(), plain)) {
+        std::cerr << "Adaptive container could not be decoded" << std::endl;
+        return false;
+    }
+    return plain == this->input_;
+}
+
+void AdaptiveCompressEngine::cleanup() {
+    std::ofstream out(this->output_file_, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: cannot write " << this->output_file_ << std::endl;
+    } else {
+        out.write(reinterpret_cast<const char*>(this->output_.data()), static_cast<std::streamsize>(this->output_.size()));
+    }
+    this->scratch_.clear();
+    this->scratch_.shrink_to_fit();
+}
@@ -0,0 +1,60 @@
+#include "capture_columns.hpp"
+
+CaptureColumns::CaptureColumns(size_t num_groups, size_t batch_rows)
+    : batch_rows_(batch_rows), offsets_(num_groups, std::vector<uint64_t>{0}), bytes_(num_groups) {
+    staged_.reserve(batch_rows_ * num_groups);
+}
+
+void CaptureColumns::append(const std::string_view* groups) {
+    staged_.insert(staged_.end(), groups, groups + offsets_.size());
+    if (staged_.size() >= batch_rows_ * offsets_.size()) {
+        flush();
+    }
+}
+
+void CaptureColumns::flush() {
+    const size_t num_groups = offsets_.size();
+    if (num_groups == 0 || staged_.empty()) {
+        staged_.clear();
+        return;
+    }
+    const size_t staged_rows = staged_.size() / num_groups;
+
+    // Column at a time: size the bytes once, then copy the batch.
+    for (size_t group = 0; group < num_groups; ++group) {
+        auto& offsets = offsets_[group];
+        auto& bytes = bytes_[group];
+        size_t batch_bytes = 0;
+        for (size_t row = 0; row < staged_rows; ++row) {
+            batch_bytes += staged_[row * num_groups + group].size();
+        }
+        bytes.reserve(bytes.size() + batch_bytes);
+        offsets.reserve(offsets.size() + staged_rows);
+        for (size_t row = 0; row < staged_rows; ++row) {
+            const auto& value = staged_[row * num_groups + group];
+            bytes.append(value.data(), value.size());
+            offsets.push_back(bytes.size());
+        }
+    }
+    rows_ += staged_rows;
+    staged_.clear();
+}
+
+void CaptureColumns::clear() {
+    for (auto& offsets : offsets_) {
+        offsets.resize(1);
+    }
+    for (auto& bytes : bytes_) {
+        bytes.clear();
+    }
+    staged_.clear();
+    rows_ = 0;
+}
+
+size_t CaptureColumns::bytes() const {
+    size_t total = 0;
+    for (const auto& bytes : bytes_) {
+        total += bytes.size();
+    }
+    return total;
+}
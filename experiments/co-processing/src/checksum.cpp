@@ -0,0 +1,393 @@
+#include "checksum.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+
+#include "cpu_dispatch.hpp"
+#include "zlib.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KAYON_CHECKSUM_X86 1
+#elif defined(__aarch64__)
+#include <arm_acle.h>
+#define KAYON_CHECKSUM_ARM 1
+#endif
+
+using checksum_fn = uint32_t (*)(uint32_t, const uint8_t*, size_t);
+
+// ---- CRC32 (reflected 0xEDB88320, as zlib) ----
+
+static constexpr std::array<std::array<uint32_t, 256>, 8> makeCrcTables() {
+    std::array<std::array<uint32_t, 256>, 8> tables{};
+    for (uint32_t idx = 0; idx < 256; ++idx) {
+        uint32_t crc = idx;
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = crc & 1 ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+        }
+        tables[0][idx] = crc;
+    }
+    for (size_t slice = 1; slice < 8; ++slice) {
+        for (uint32_t idx = 0; idx < 256; ++idx) {
+            uint32_t prev = tables[slice - 1][idx];
+            tables[slice][idx] = (prev >> 8) ^ tables[0][prev & 0xff];
+        }
+    }
+    return tables;
+}
+
+static constexpr auto CRC_TABLES = makeCrcTables();
+
+// slicing-by-8, 8 table lookups per 8 bytes
+static uint32_t crc32Portable(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    if constexpr (std::endian::native == std::endian::little) {
+        for (; len >= 8; data += 8, len -= 8) {
+            uint32_t lo, hi;
+            std::memcpy(&lo, data, 4);
+            std::memcpy(&hi, data + 4, 4);
+            lo ^= crc;
+            crc = CRC_TABLES[7][lo & 0xff] ^ CRC_TABLES[6][(lo >> 8) & 0xff] ^
+                  CRC_TABLES[5][(lo >> 16) & 0xff] ^ CRC_TABLES[4][lo >> 24] ^
+                  CRC_TABLES[3][hi & 0xff] ^ CRC_TABLES[2][(hi >> 8) & 0xff] ^
+                  CRC_TABLES[1][(hi >> 16) & 0xff] ^ CRC_TABLES[0][hi >> 24];
+        }
+    }
+    for (; len > 0; ++data, --len) {
+        crc = CRC_TABLES[0][(crc ^ *data) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+#ifdef KAYON_CHECKSUM_X86
+// Folding with carry-less multiplies, "Fast CRC Computation for Generic
+// Polynomials Using PCLMULQDQ" (Intel). Constants are x^(k) mod P for the
+// fold distances of 512, 128 and 64 bits, then the Barrett reduction.
+alignas(16) static const uint64_t FOLD_512[2] = {0x0154442bd4, 0x01c6e41596};
+alignas(16) static const uint64_t FOLD_128[2] = {0x01751997d0, 0x00ccaa009e};
+alignas(16) static const uint64_t FOLD_64[2] = {0x0163cd6124, 0x0000000000};
+alignas(16) static const uint64_t BARRETT[2] = {0x01db710641, 0x01f7011641};
+
+// crc state (not inverted) over len bytes, len at least 64 and a multiple of 16
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t crc32FoldPclmul(uint32_t crc, const uint8_t *data, size_t len) {
+    __m128i x1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00));
+    __m128i x2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10));
+    __m128i x3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20));
+    __m128i x4 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(FOLD_512));
+    data += 64;
+    len -= 64;
+
+    // four 128-bit lanes, 64 bytes per step
+    for (; len >= 64; data += 64, len -= 64) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        __m128i x6 = _mm_clmulepi64_si128(x2, k, 0x00);
+        __m128i x7 = _mm_clmulepi64_si128(x3, k, 0x00);
+        __m128i x8 = _mm_clmulepi64_si128(x4, k, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, k, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, k, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, k, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, k, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8), _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 0x30)));
+    }
+
+    // fold the lanes into one, then the remaining 16-byte blocks
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(FOLD_128));
+    for (__m128i next : {x2, x3, x4}) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11), next), x5);
+    }
+    for (; len >= 16; data += 16, len -= 16) {
+        __m128i x5 = _mm_clmulepi64_si128(x1, k, 0x00);
+        x1 = _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x1, k, 0x11),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(data))), x5);
+    }
+
+    // 128 to 64 bits
+    const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    __m128i x2r = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1 = _mm_xor_si128(_mm_srli_si128(x1, 8), x2r);
+    k = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(FOLD_64));
+    x2r = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), k, 0x00), x2r);
+
+    // Barrett reduction to 32 bits
+    k = _mm_load_si128(reinterpret_cast<const __m128i*>(BARRETT));
+    x2r = _mm_clmulepi64_si128(_mm_and_si128(x1, low32), k, 0x10);
+    x2r = _mm_clmulepi64_si128(_mm_and_si128(x2r, low32), k, 0x00);
+    x1 = _mm_xor_si128(x1, x2r);
+    return static_cast<uint32_t>(_mm_extract_epi32(x1, 1));
+}
+
+static uint32_t crc32Pclmul(uint32_t crc, const uint8_t *data, size_t len) {
+    if (len < 64) {
+        return crc32Portable(crc, data, len);
+    }
+    size_t folded = len & ~static_cast<size_t>(15);
+    crc = ~crc32FoldPclmul(~crc, data, folded);
+    return crc32Portable(crc, data + folded, len - folded);
+}
+#endif
+
+#ifdef KAYON_CHECKSUM_ARM
+// ARMv8 CRC32 instructions, the same polynomial as zlib (not CRC32C)
+__attribute__((target("+crc")))
+static uint32_t crc32Armv8(uint32_t crc, const uint8_t *data, size_t len) {
+    crc = ~crc;
+    for (; len >= 8; data += 8, len -= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        crc = __crc32d(crc, word);
+    }
+    for (; len > 0; ++data, --len) {
+        crc = __crc32b(crc, *data);
+    }
+    return ~crc;
+}
+#endif
+
+struct ChecksumKernel {
+    checksum_fn fn;
+    const char *name;
+};
+
+static ChecksumKernel pickCrc32() {
+#ifdef KAYON_CHECKSUM_X86
+    if (cpuFeatures().pclmul && cpuFeatures().sse41) {
+        return {crc32Pclmul, "pclmul"};
+    }
+#elif defined(KAYON_CHECKSUM_ARM)
+    if (cpuFeatures().arm_crc32) {
+        return {crc32Armv8, "armv8-crc"};
+    }
+#endif
+    return {crc32Portable, "slice8"};
+}
+
+static const ChecksumKernel &crc32Kernel() {
+    static const ChecksumKernel kernel = pickCrc32();
+    return kernel;
+}
+
+uint32_t crc32Update(uint32_t crc, const uint8_t *data, size_t len) {
+    return crc32Kernel().fn(crc, data, len);
+}
+
+// ---- Adler32 ----
+
+static const uint32_t ADLER_BASE = 65521;
+// most bytes before the sums can overflow 32 bits
+static const size_t ADLER_NMAX = 5552;
+
+static uint32_t adler32Portable(uint32_t adler, const uint8_t *data, size_t len) {
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+    while (len > 0) {
+        size_t block = std::min(len, ADLER_NMAX);
+        len -= block;
+        for (; block > 0; --block) {
+            s1 += *data++;
+            s2 += s1;
+        }
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+    return (s2 << 16) | s1;
+}
+
+#ifdef KAYON_CHECKSUM_X86
+// 32 bytes per step: SAD sums the bytes into s1, byte-weighted multiply-adds
+// (weights 32..1) give their share of s2, s1 carried over adds 32x per step
+__attribute__((target("ssse3")))
+static uint32_t adler32Ssse3(uint32_t adler, const uint8_t *data, size_t len) {
+    const size_t BLOCK = 32;
+    uint32_t s1 = adler & 0xffff;
+    uint32_t s2 = adler >> 16;
+
+    size_t blocks = len / BLOCK;
+    len -= blocks * BLOCK;
+    const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+    const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    while (blocks > 0) {
+        size_t steps = std::min(blocks, ADLER_NMAX / BLOCK);
+        blocks -= steps;
+
+        __m128i v_ps = _mm_set_epi32(0, 0, 0, static_cast<int>(s1 * steps));
+        __m128i v_s2 = _mm_set_epi32(0, 0, 0, static_cast<int>(s2));
+        __m128i v_s1 = _mm_setzero_si128();
+        for (; steps > 0; --steps, data += BLOCK) {
+            const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+            const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16));
+            v_ps = _mm_add_epi32(v_ps, v_s1);
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes1, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+            v_s1 = _mm_add_epi32(v_s1, _mm_sad_epu8(bytes2, zero));
+            v_s2 = _mm_add_epi32(v_s2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+        }
+        v_s2 = _mm_add_epi32(v_s2, _mm_slli_epi32(v_ps, 5));
+
+        // horizontal sums
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s1 = _mm_add_epi32(v_s1, _mm_shuffle_epi32(v_s1, _MM_SHUFFLE(1, 0, 3, 2)));
+        s1 += static_cast<uint32_t>(_mm_cvtsi128_si32(v_s1));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(2, 3, 0, 1)));
+        v_s2 = _mm_add_epi32(v_s2, _mm_shuffle_epi32(v_s2, _MM_SHUFFLE(1, 0, 3, 2)));
+        s2 = static_cast<uint32_t>(_mm_cvtsi128_si32(v_s2));
+
+        s1 %= ADLER_BASE;
+        s2 %= ADLER_BASE;
+    }
+    return adler32Portable((s2 << 16) | s1, data, len);
+}
+#endif
+
+static ChecksumKernel pickAdler32() {
+#ifdef KAYON_CHECKSUM_X86
+    if (cpuFeatures().ssse3) {
+        return {adler32Ssse3, "ssse3"};
+    }
+#endif
+    return {adler32Portable, "scalar"};
+}
+
+static const ChecksumKernel &adler32Kernel() {
+    static const ChecksumKernel kernel = pickAdler32();
+    return kernel;
+}
+
+uint32_t adler32Update(uint32_t adler, const uint8_t *data, size_t len) {
+    return adler32Kernel().fn(adler, data, len);
+}
+
+// ---- xxHash32, four independent lanes (the reference algorithm) ----
+
+static const uint32_t XXH_P1 = 2654435761u;
+static const uint32_t XXH_P2 = 2246822519u;
+static const uint32_t XXH_P3 = 3266489917u;
+static const uint32_t XXH_P4 = 668265263u;
+static const uint32_t XXH_P5 = 374761393u;
+
+static inline uint32_t rotl32(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+static inline uint32_t readLe32(const uint8_t *data) {
+    return static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+           static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+}
+
+static inline uint32_t xxhRound(uint32_t acc, uint32_t input) {
+    return rotl32(acc + input * XXH_P2, 13) * XXH_P1;
+}
+
+uint32_t xxhash32(const uint8_t *data, size_t len, uint32_t seed) {
+    const uint8_t *end = data + len;
+    uint32_t hash;
+    if (len >= 16) {
+        uint32_t v1 = seed + XXH_P1 + XXH_P2;
+        uint32_t v2 = seed + XXH_P2;
+        uint32_t v3 = seed;
+        uint32_t v4 = seed - XXH_P1;
+        const uint8_t *limit = end - 16;
+        do {
+            v1 = xxhRound(v1, readLe32(data));
+            v2 = xxhRound(v2, readLe32(data + 4));
+            v3 = xxhRound(v3, readLe32(data + 8));
+            v4 = xxhRound(v4, readLe32(data + 12));
+            data += 16;
+        } while (data <= limit);
+        hash = rotl32(v1, 1) + rotl32(v2, 7) + rotl32(v3, 12) + rotl32(v4, 18);
+    } else {
+        hash = seed + XXH_P5;
+    }
+    hash += static_cast<uint32_t>(len);
+
+    for (; data + 4 <= end; data += 4) {
+        hash = rotl32(hash + readLe32(data) * XXH_P3, 17) * XXH_P4;
+    }
+    for (; data < end; ++data) {
+        hash = rotl32(hash + *data * XXH_P5, 11) * XXH_P1;
+    }
+    hash ^= hash >> 15;
+    hash *= XXH_P2;
+    hash ^= hash >> 13;
+    hash *= XXH_P3;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+std::string checksumKernels() {
+    return std::string("crc32=") + crc32Kernel().name + " adler32=" + adler32Kernel().name;
+}
+
+// ---- combination ----
+
+uint32_t crc32Combine(uint32_t crc_a, uint32_t crc_b, size_t len_b) {
+    return static_cast<uint32_t>(crc32_combine(crc_a, crc_b, static_cast<z_off_t>(len_b)));
+}
+
+uint32_t adler32Combine(uint32_t adler_a, uint32_t adler_b, size_t len_b) {
+    return static_cast<uint32_t>(adler32_combine(adler_a, adler_b, static_cast<z_off_t>(len_b)));
+}
+
+ChunkChecksum chunkChecksum(ChecksumKind kind, const uint8_t *plain, size_t len) {
+    uint32_t second = kind == ChecksumKind::ADLER32 ? adler32Update(1, plain, len) : xxhash32(plain, len);
+    return {crc32Update(0, plain, len), second};
+}
+
+// ---- verifier ----
+
+void ChecksumVerifier::reset(size_t num_chunks, ChecksumKind kind) {
+    this->kind_ = kind;
+    this->chunks_.assign(num_chunks, ChunkChecksum{0, 0});
+    this->lengths_.assign(num_chunks, 0);
+    this->seen_.assign(num_chunks, false);
+    this->verified_ = 0;
+    this->mismatched_ = 0;
+}
+
+bool ChecksumVerifier::verify(size_t chunk, ChunkChecksum device, const uint8_t *plain, size_t len) {
+    ChunkChecksum host = chunkChecksum(this->kind_, plain, len);
+    this->chunks_[chunk] = host;
+    this->lengths_[chunk] = len;
+    this->seen_[chunk] = true;
+
+    bool match = host.crc == device.crc && host.second == device.second;
+    ++(match ? this->verified_ : this->mismatched_);
+    return match;
+}
+
+void ChecksumVerifier::record(size_t chunk, const uint8_t *plain, size_t len) {
+    this->chunks_[chunk] = chunkChecksum(this->kind_, plain, len);
+    this->lengths_[chunk] = len;
+    this->seen_[chunk] = true;
+}
+
+uint64_t ChecksumVerifier::streamChecksum() const {
+    if (this->chunks_.empty() || std::find(this->seen_.begin(), this->seen_.end(), false) != this->seen_.end()) {
+        return 0;
+    }
+
+    uint32_t crc = this->chunks_[0].crc;
+    uint32_t adler = this->chunks_[0].second;
+    for (size_t chunk = 1; chunk < this->chunks_.size(); ++chunk) {
+        crc = crc32Combine(crc, this->chunks_[chunk].crc, this->lengths_[chunk]);
+        if (this->kind_ == ChecksumKind::ADLER32) {
+            adler = adler32Combine(adler, this->chunks_[chunk].second, this->lengths_[chunk]);
+        }
+    }
+    return this->kind_ == ChecksumKind::ADLER32 ? docaChecksum(crc, adler) : crc;
+}
+
+std::vector<std::string> ChecksumVerifier::toStrings() const {
+    return {std::to_string(this->verified_), std::to_string(this->mismatched_), std::to_string(this->streamChecksum())};
+}
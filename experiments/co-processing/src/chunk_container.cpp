@@ -0,0 +1,101 @@
+#include "chunk_container.hpp"
+
+#include <cstring>
+
+#include "sw_task_executor.hpp"
+
+const char *chunkCodecName(ChunkCodec codec) {
+    switch (codec) {
+        case ChunkCodec::STORED: return "stored";
+        case ChunkCodec::DEFLATE: return "deflate";
+        case ChunkCodec::LZ4: return "lz4";
+    }
+    return "unknown";
+}
+
+static void putLe(std::vector<uint8_t> &out, uint64_t value, size_t bytes) {
+    for (size_t idx = 0; idx < bytes; ++idx) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * idx)));
+    }
+}
+
+static uint64_t getLe(const uint8_t *data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t idx = 0; idx < bytes; ++idx) {
+        value |= static_cast<uint64_t>(data[idx]) << (8 * idx);
+    }
+    return value;
+}
+
+void writeContainerHeader(std::vector<uint8_t> &out, uint32_t chunk_size, uint64_t chunk_count) {
+    out.insert(out.end(), CHUNK_CONTAINER_MAGIC, CHUNK_CONTAINER_MAGIC + sizeof(CHUNK_CONTAINER_MAGIC));
+    putLe(out, chunk_size, 4);
+    putLe(out, chunk_count, 8);
+}
+
+void appendChunk(std::vector<uint8_t> &out, ChunkCodec codec, uint32_t plain_len, const uint8_t *payload,
+                 uint32_t payload_len) {
+    out.push_back(static_cast<uint8_t>(codec));
+    putLe(out, 0, 3);
+    putLe(out, plain_len, 4);
+    putLe(out, payload_len, 4);
+    out.insert(out.end(), payload, payload + payload_len);
+}
+
+bool parseContainer(const uint8_t *data, size_t len, std::vector<ChunkView> &chunks) {
+    chunks.clear();
+    if (len < CHUNK_CONTAINER_HEADER_SIZE ||
+        std::memcmp(data, CHUNK_CONTAINER_MAGIC, sizeof(CHUNK_CONTAINER_MAGIC)) != 0) {
+        return false;
+    }
+    uint64_t chunk_count = getLe(data + 8, 8);
+
+    size_t offset = CHUNK_CONTAINER_HEADER_SIZE;
+    for (uint64_t chunk = 0; chunk < chunk_count; ++chunk) {
+        if (len - offset < CHUNK_HEADER_SIZE) {
+            return false;
+        }
+        uint8_t codec = data[offset];
+        if (codec > static_cast<uint8_t>(ChunkCodec::LZ4)) {
+            return false;
+        }
+        ChunkView view{static_cast<ChunkCodec>(codec), static_cast<uint32_t>(getLe(data + offset + 4, 4)), nullptr,
+                       static_cast<uint32_t>(getLe(data + offset + 8, 4))};
+        offset += CHUNK_HEADER_SIZE;
+        if (len - offset < view.payload_len) {
+            return false;
+        }
+        view.payload = data + offset;
+        offset += view.payload_len;
+        chunks.push_back(view);
+    }
+    return true;
+}
+
+bool decodeContainer(const uint8_t *data, size_t len, std::vector<uint8_t> &plain) {
+    std::vector<ChunkView> chunks;
+    if (!parseContainer(data, len, chunks)) {
+        return false;
+    }
+
+    plain.clear();
+    for (const auto &chunk : chunks) {
+        size_t offset = plain.size();
+        plain.resize(offset + chunk.plain_len);
+        if (chunk.codec == ChunkCodec::STORED) {
+            if (chunk.payload_len != chunk.plain_len) {
+                return false;
+            }
+            std::memcpy(plain.data() + offset, chunk.payload, chunk.plain_len);
+            continue;
+        }
+
+        // the same codec calls the software executor runs for the DOCA tasks
+        SwTask task{chunk.codec == ChunkCodec::DEFLATE ? TaskCodec::INFLATE : TaskCodec::LZ4_BLOCK_DECOMPRESS,
+                    chunk.payload, chunk.payload_len, plain.data() + offset, chunk.plain_len};
+        if (!SwTaskExecutor::runCodec(task) || task.dst_len != chunk.plain_len) {
+            return false;
+        }
+    }
+    return true;
+}
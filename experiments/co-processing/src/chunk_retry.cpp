@@ -0,0 +1,123 @@
+#include <iostream>
+
+#include "chunk_retry.hpp"
+#include "compressibility.hpp"
+
+std::vector<std::string> RetryCounters::toStrings() const {
+    return {std::to_string(offload_failed), std::to_string(offload_timed_out), std::to_string(cpu_retried),
+            std::to_string(cpu_retry_failed), std::to_string(stored_bypass)};
+}
+
+ChunkRetrier::ChunkRetrier(TaskCodec codec) : codec_(codec) {}
+
+ChunkRetrier::~ChunkRetrier() {
+    this->stop();
+}
+
+void ChunkRetrier::reset(size_t num_chunks) {
+    this->engines_.assign(num_chunks, ChunkEngine::NONE);
+    this->requeued_.assign(num_chunks, false);
+    this->buffers_.clear();
+    this->buffers_.resize(num_chunks);
+    this->tasks_.assign(num_chunks, SwTask{this->codec_, nullptr, 0, nullptr, 0});
+    this->queued_.clear();
+    this->counters_ = {};
+}
+
+bool ChunkRetrier::offloaded(size_t id) {
+    if (this->requeued_[id]) {
+        return false;
+    }
+    this->engines_[id] = ChunkEngine::OFFLOAD;
+    return true;
+}
+
+void ChunkRetrier::retry(size_t id, const uint8_t *src, size_t src_len, size_t dst_cap, bool timed_out) {
+    // a late failure of a chunk that already timed out
+    if (this->requeued_[id]) {
+        return;
+    }
+    this->requeued_[id] = true;
+    ++(timed_out ? this->counters_.offload_timed_out : this->counters_.offload_failed);
+    if (!this->policy_.enabled) {
+        return;
+    }
+
+    // own buffer: the device one may be too small, or still written by a timed-out task
+    auto &buffer = this->buffers_[id];
+    buffer.resize(SwTaskExecutor::outputBound(this->codec_, src_len, dst_cap));
+    this->tasks_[id] = SwTask{this->codec_, src, src_len, buffer.data(), buffer.size()};
+    this->tasks_[id].user_data = id;
+    this->queued_.push_back(id);
+}
+
+void ChunkRetrier::store(size_t id, const uint8_t *src, size_t src_len) {
+    auto &buffer = this->buffers_[id];
+    buffer.resize(storedDeflateSize(src_len));
+    size_t written = writeStoredDeflate(src, src_len, buffer.data(), buffer.size());
+
+    this->requeued_[id] = true;
+    this->engines_[id] = ChunkEngine::STORED;
+    ++this->counters_.stored_bypass;
+    if (this->done_handler_) {
+        this->done_handler_(id, buffer.data(), written);
+    }
+}
+
+std::vector<size_t> ChunkRetrier::missing() const {
+    std::vector<size_t> ids;
+    for (size_t id = 0; id < this->engines_.size(); ++id) {
+        if (this->engines_[id] == ChunkEngine::NONE && !this->requeued_[id]) {
+            ids.push_back(id);
+        }
+    }
+    return ids;
+}
+
+void ChunkRetrier::progress() {
+    if (!this->queued_.empty() && !this->executor_) {
+        this->executor_ = std::make_unique<SwTaskExecutor>(this->policy_.threads);
+        this->executor_->setConf(retryCompleted, retryFailed, static_cast<uint32_t>(this->engines_.size()), this);
+        this->executor_->start();
+    }
+    while (!this->queued_.empty()) {
+        if (!this->executor_->submit(&this->tasks_[this->queued_.front()])) {
+            break;
+        }
+        this->queued_.pop_front();
+        ++this->running_;
+    }
+    if (this->executor_) {
+        (void)this->executor_->progress();
+    }
+}
+
+void ChunkRetrier::retryCompleted(SwTask *task, void *ctx_user_data) {
+    auto *retrier = static_cast<ChunkRetrier*>(ctx_user_data);
+    --retrier->running_;
+    ++retrier->counters_.cpu_retried;
+    retrier->engines_[task->user_data] = ChunkEngine::CPU_RETRY;
+    if (retrier->done_handler_) {
+        retrier->done_handler_(task->user_data, task->dst, task->dst_len);
+    }
+}
+
+void ChunkRetrier::retryFailed(SwTask *task, void *ctx_user_data) {
+    // corrupt input, the chunk stays missing
+    auto *retrier = static_cast<ChunkRetrier*>(ctx_user_data);
+    --retrier->running_;
+    ++retrier->counters_.cpu_retry_failed;
+    std::cerr << "Chunk " << task->user_data << " failed on the host too" << std::endl;
+}
+
+void ChunkRetrier::stop() {
+    if (this->executor_) {
+        this->executor_->stop();
+        this->worker_cpu_seconds_ += this->executor_->workerCpuSeconds();
+        this->executor_.reset();
+    }
+}
+
+double ChunkRetrier::workerCpuSeconds() const {
+    return this->worker_cpu_seconds_ + (this->executor_ ? this->executor_->workerCpuSeconds() : 0.0);
+}
@@ -0,0 +1,112 @@
+#include "compressibility.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "lz4.h"
+
+// Largest payload of one stored block (LEN is 16 bits)
+static const size_t STORED_BLOCK_MAX = 65535;
+// BFINAL/BTYPE byte, LEN and NLEN
+static const size_t STORED_BLOCK_HEADER = 5;
+
+CompressibilityEstimate CompressibilityEstimator::estimate(const uint8_t *data, size_t len) const {
+    CompressibilityEstimate result{0.0, 1.0, false};
+    if (len == 0) {
+        return result;
+    }
+
+    // windows evenly spread over the chunk, the whole chunk if it is small
+    size_t window = std::min(std::max<size_t>(this->window_bytes, 1), len);
+    size_t windows = std::max<size_t>(1, std::min(this->sample_bytes / window, len / window));
+    size_t stride = windows > 1 ? (len - window) / (windows - 1) : 0;
+
+    std::array<uint32_t, 256> histogram{};
+    for (size_t w = 0; w < windows; ++w) {
+        const uint8_t *begin = data + w * stride;
+        for (size_t idx = 0; idx < window; ++idx) {
+            ++histogram[begin[idx]];
+        }
+    }
+
+    double sampled = static_cast<double>(windows * window);
+    for (uint32_t count : histogram) {
+        if (count > 0) {
+            double p = count / sampled;
+            result.entropy_bits -= p * std::log2(p);
+        }
+    }
+    if (result.entropy_bits < this->max_entropy_bits) {
+        return result;
+    }
+
+    // looks random byte-wise, see if LZ4 finds matches in the same windows
+    std::vector<char> out(LZ4_compressBound(static_cast<int>(window)));
+    size_t compressed = 0;
+    for (size_t w = 0; w < windows; ++w) {
+        const char *begin = reinterpret_cast<const char*>(data + w * stride);
+        int size = LZ4_compress_default(begin, out.data(), static_cast<int>(window), static_cast<int>(out.size()));
+        compressed += size > 0 ? static_cast<size_t>(size) : window;
+    }
+    result.lz4_ratio = compressed / sampled;
+    result.incompressible = result.lz4_ratio > 1.0 - this->min_lz4_saving;
+    return result;
+}
+
+size_t storedDeflateSize(size_t len) {
+    size_t blocks = std::max<size_t>(1, (len + STORED_BLOCK_MAX - 1) / STORED_BLOCK_MAX);
+    return len + blocks * STORED_BLOCK_HEADER;
+}
+
+size_t writeStoredDeflate(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_cap) {
+    if (dst_cap < storedDeflateSize(len)) {
+        return 0;
+    }
+
+    size_t written = 0;
+    size_t offset = 0;
+    do {
+        size_t block = std::min(STORED_BLOCK_MAX, len - offset);
+        bool final = offset + block == len;
+        // BFINAL bit, BTYPE 00, then padding to the byte boundary
+        dst[written++] = final ? 1 : 0;
+        dst[written++] = static_cast<uint8_t>(block & 0xff);
+        dst[written++] = static_cast<uint8_t>(block >> 8);
+        dst[written++] = static_cast<uint8_t>(~block & 0xff);
+        dst[written++] = static_cast<uint8_t>((~block >> 8) & 0xff);
+        std::memcpy(dst + written, src + offset, block);
+        written += block;
+        offset += block;
+    } while (offset < len);
+    return written;
+}
+
+size_t lz4LiteralsSize(size_t len) {
+    // token, 255-steps of the length past 15, literals
+    size_t length_bytes = len >= 15 ? (len - 15) / 255 + 1 : 0;
+    return 1 + length_bytes + len;
+}
+
+size_t writeLz4Literals(const uint8_t *src, size_t len, uint8_t *dst, size_t dst_cap) {
+    if (dst_cap < lz4LiteralsSize(len)) {
+        return 0;
+    }
+
+    size_t written = 0;
+    if (len >= 15) {
+        dst[written++] = 0xf0;
+        size_t rest = len - 15;
+        while (rest >= 255) {
+            dst[written++] = 255;
+            rest -= 255;
+        }
+        dst[written++] = static_cast<uint8_t>(rest);
+    } else {
+        dst[written++] = static_cast<uint8_t>(len << 4);
+    }
+    std::memcpy(dst + written, src, len);
+    return written + len;
+}
@@ -0,0 +1,75 @@
+#include "cpu_codec_worker.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+void pin_and_expose(const char* name, int core) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(core, &mask);
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+
+    pid_t tid = syscall(SYS_gettid);
+    printf("%s TID=%d (core %d)\n", name, tid, core);
+    fflush(stdout);
+}
+
+double thread_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+double process_cpu_seconds() {
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+std::string calculateSeconds(const std::chrono::steady_clock::time_point end,
+                             const std::chrono::steady_clock::time_point start) {
+    auto elapsed = end - start;
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    // Convert the float to a string with fixed formatting and desired precision
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8) << seconds;
+    return oss.str();
+}
+
+const std::vector<std::string> CPU_RESULT_KEYS = {"overall_submission_elapsed", "cpu_time_elapsed",
+                                                  "joined_submission_elapsed"};
+
+void cpuWriteJson(const std::vector<std::string> times, const std::string filename, const TrialRecorder& trials) {
+    nlohmann::json j;
+    const std::vector<std::string>& keys = CPU_RESULT_KEYS;
+    for (uint16_t idx = 0; idx < times.size(); ++idx) {
+        j[keys[idx]] = times[idx];
+    }
+    // summaries of the repeated trials, if any
+    auto summary = trials.toJson(keys);
+    if (!summary.is_null()) {
+        j["trials"] = summary;
+    }
+
+    // Pretty print the JSON with an indent of 4 spaces
+    std::string prettyJson = j.dump(4);
+
+    // Optionally, write the pretty printed JSON to a file
+    std::ofstream outFile(filename);
+    if (outFile) {
+        outFile << prettyJson;
+    }
+}
+
+std::vector<std::string> cpuResults(std::chrono::steady_clock::time_point start,
+                                    std::chrono::steady_clock::time_point task_end,
+                                    std::chrono::steady_clock::time_point end, double cpu_seconds) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8) << cpu_seconds;
+    return {calculateSeconds(task_end, start), oss.str(), calculateSeconds(end, start)};
+}
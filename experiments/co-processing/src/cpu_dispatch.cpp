@@ -0,0 +1,51 @@
+#include "cpu_dispatch.hpp"
+
+#include <utility>
+
+#if defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+static CpuFeatures detectCpuFeatures() {
+    CpuFeatures features;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    features.ssse3 = __builtin_cpu_supports("ssse3");
+    features.sse41 = __builtin_cpu_supports("sse4.1");
+    features.pclmul = __builtin_cpu_supports("pclmul");
+    features.avx2 = __builtin_cpu_supports("avx2");
+#elif defined(__aarch64__)
+    unsigned long hwcap = getauxval(AT_HWCAP);
+    features.arm_crc32 = hwcap & HWCAP_CRC32;
+    features.arm_pmull = hwcap & HWCAP_PMULL;
+#endif
+    return features;
+}
+
+const CpuFeatures &cpuFeatures() {
+    static const CpuFeatures features = detectCpuFeatures();
+    return features;
+}
+
+std::string cpuFeaturesString() {
+    const CpuFeatures &features = cpuFeatures();
+#if defined(__x86_64__) || defined(__i386__)
+    std::string name = "x86-64";
+#elif defined(__aarch64__)
+    std::string name = "aarch64";
+#else
+    std::string name = "generic";
+#endif
+    const std::pair<bool, const char *> flags[] = {
+        {features.ssse3, "ssse3"}, {features.sse41, "sse4.1"}, {features.pclmul, "pclmul"},
+        {features.avx2, "avx2"}, {features.arm_crc32, "crc32"}, {features.arm_pmull, "pmull"},
+    };
+    for (const auto &[present, flag] : flags) {
+        if (present) {
+            name += " ";
+            name += flag;
+        }
+    }
+    return name;
+}
@@ -0,0 +1,47 @@
+#include "dict_column.hpp"
+
+#include <unordered_map>
+
+DictColumn DictColumn::encode(std::vector<std::string>& rows) {
+    DictColumn column;
+    column.codes_.reserve(rows.size());
+
+    std::unordered_map<std::string, uint32_t> lookup;
+    lookup.reserve(rows.size() / 4 + 1);
+
+    for (auto& row : rows) {
+        column.row_bytes_ += row.size();
+        auto [it, inserted] = lookup.try_emplace(row, static_cast<uint32_t>(column.values_.size()));
+        if (inserted) {
+            column.value_bytes_ += row.size();
+            column.values_.push_back(std::move(row));
+        }
+        column.codes_.push_back(it->second);
+    }
+    rows.clear();
+    rows.shrink_to_fit();
+
+    return column;
+}
+
+void DictColumn::expand(const std::vector<uint8_t>& per_value, std::vector<uint8_t>& per_row) const {
+    per_row.resize(codes_.size());
+    for (size_t row = 0; row < codes_.size(); ++row) {
+        per_row[row] = per_value[codes_[row]];
+    }
+}
+
+size_t DictColumn::countRows(const std::vector<uint8_t>& per_value) const {
+    size_t count = 0;
+    for (auto code : codes_) {
+        count += per_value[code];
+    }
+    return count;
+}
+
+double DictColumn::dedupRatio() const {
+    if (values_.empty()) {
+        return 1.0;
+    }
+    return static_cast<double>(codes_.size()) / values_.size();
+}
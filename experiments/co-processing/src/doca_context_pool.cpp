@@ -0,0 +1,66 @@
+#include <algorithm>
+
+#include "doca_context_pool.hpp"
+
+template <typename Traits>
+DocaContextPool<Traits>::Lease::Lease(Lease &&other) noexcept
+    : pool_(other.pool_), consumer_(other.consumer_) {
+    other.pool_ = nullptr;
+    other.consumer_ = nullptr;
+}
+
+template <typename Traits>
+typename DocaContextPool<Traits>::Lease &DocaContextPool<Traits>::Lease::operator=(Lease &&other) noexcept {
+    if (this != &other) {
+        this->release();
+        std::swap(this->pool_, other.pool_);
+        std::swap(this->consumer_, other.consumer_);
+    }
+    return *this;
+}
+
+template <typename Traits>
+void DocaContextPool<Traits>::Lease::release() {
+    if (this->consumer_ != nullptr) {
+        this->pool_->giveBack(this->consumer_);
+        this->pool_ = nullptr;
+        this->consumer_ = nullptr;
+    }
+}
+
+template <typename Traits>
+DocaContextPool<Traits>::~DocaContextPool() {
+    for (auto &consumer : this->consumers_) {
+        consumer->cleanup();
+    }
+}
+
+template <typename Traits>
+typename DocaContextPool<Traits>::Lease DocaContextPool<Traits>::acquire() {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    if (this->idle_.empty()) {
+        return Lease();
+    }
+    Consumer *consumer = this->idle_.back();
+    this->idle_.pop_back();
+    return Lease(this, consumer);
+}
+
+template <typename Traits>
+size_t DocaContextPool<Traits>::idle() const {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->idle_.size();
+}
+
+template <typename Traits>
+void DocaContextPool<Traits>::giveBack(Consumer *consumer) {
+    // the next job sets its own handler
+    consumer->setBlockHandler(nullptr);
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    // the least recently used one is handed out last
+    this->idle_.insert(this->idle_.begin(), consumer);
+}
+
+template class DocaContextPool<CompressDeflateTraits>;
+template class DocaContextPool<DecompressDeflateTraits>;
+template class DocaContextPool<DecompressLz4Traits>;
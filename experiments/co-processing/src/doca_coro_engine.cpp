@@ -0,0 +1,287 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include <doca_buf.h>
+#include <doca_buf_inventory.h>
+#include <doca_compress.h>
+#include <doca_ctx.h>
+#include <doca_error.h>
+#include <doca_log.h>
+#include <doca_mmap.h>
+#include <doca_pe.h>
+
+#include "doca_coro_engine.hpp"
+
+template <typename Traits>
+DocaCoroEngine<Traits>::DocaCoroEngine(DEVICE_TYPE dev_type, size_t input_capacity, size_t output_capacity,
+                                       uint32_t max_in_flight)
+    : Base(dev_type), input_capacity_(input_capacity), output_capacity_(output_capacity),
+      max_in_flight_(max_in_flight) {
+    this->initialized = true;
+
+    // 1. init DOCA log
+    doca_log_backend_create_standard();
+    doca_log_backend_create_with_file_sdk(stderr, &this->sdkLog);
+    doca_log_backend_set_sdk_level(this->sdkLog, DOCA_LOG_LEVEL_WARNING);
+
+    if (this->max_in_flight_ == 0 || this->input_capacity_ == 0 || this->output_capacity_ == 0) {
+        std::cerr << "DocaCoroEngine: needs buffers and at least one task slot" << std::endl;
+        return;
+    }
+
+    // 2. one registered region each way, prepareMmaps maps num_buffers * size
+    this->num_buffers = 1;
+    this->input_buff_size = this->input_capacity_;
+    this->output_buffer_size = this->output_capacity_;
+    if (posix_memalign((void **)&this->indata, 64, this->input_capacity_) != 0 ||
+        posix_memalign((void **)&this->outdata, 64, this->output_capacity_) != 0) {
+        std::cerr << "2. error" << std::endl;
+        return;
+    }
+
+    // 3. prepare progress engine (no epoll)
+    auto err = this->prepareEngine();
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "3. error" << std::endl;
+        return;
+    }
+
+    // 4. open device for the task type
+    err = this->openDocaDevice();
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "4. error" << std::endl;
+        return;
+    }
+
+    // 5. prepare mmaps
+    err = this->prepareMmaps(DOCA_ACCESS_FLAG_LOCAL_READ_WRITE, DOCA_ACCESS_FLAG_LOCAL_READ_WRITE);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "5. error" << std::endl;
+        return;
+    }
+
+    // 6. inventory for the src and dst of every task slot
+    err = doca_buf_inventory_create(this->max_in_flight_ * 2, &this->inventory);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "6.1 error" << std::endl;
+        return;
+    }
+    err = doca_buf_inventory_start(this->inventory);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "6.2 error" << std::endl;
+        return;
+    }
+
+    // 7. open and start ctx with the resuming callbacks
+    err = this->openCompressContext(taskCompleted, taskFailed, this->max_in_flight_);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "7. error" << std::endl;
+        return;
+    }
+
+    this->ready_ = true;
+}
+
+template <typename Traits>
+DocaCoroEngine<Traits>::~DocaCoroEngine() {
+    this->cleanup();
+}
+
+template <typename Traits>
+bool DocaCoroEngine<Traits>::TaskAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    this->handle_ = handle;
+    if (!this->engine_->ready_) {
+        this->result_ = {DOCA_ERROR_BAD_STATE, 0};
+        ++this->engine_->failed_;
+        return false;
+    }
+
+    // queue behind earlier awaiters, else take a free slot
+    if (this->engine_->in_flight_ >= this->engine_->max_in_flight_ || !this->engine_->waiting_.empty()) {
+        this->engine_->waiting_.push_back(this);
+        this->engine_->peak_waiting_ = std::max(this->engine_->peak_waiting_, this->engine_->waiting_.size());
+        return true;
+    }
+
+    auto err = this->engine_->submit(this);
+    if (err != DOCA_SUCCESS) {
+        this->result_ = {err, 0};
+        ++this->engine_->failed_;
+        return false;
+    }
+    return true;
+}
+
+template <typename Traits>
+doca_error_t DocaCoroEngine<Traits>::submit(TaskAwaiter *awaiter) {
+    // tasks only see the registered regions and the per-task device limit
+    const uint8_t *in_begin = this->indata;
+    const uint8_t *out_begin = this->outdata;
+    if (awaiter->src_.empty() || awaiter->dst_.empty() ||
+        awaiter->src_.data() < in_begin || awaiter->src_.data() + awaiter->src_.size() > in_begin + this->input_capacity_ ||
+        awaiter->dst_.data() < out_begin || awaiter->dst_.data() + awaiter->dst_.size() > out_begin + this->output_capacity_ ||
+        awaiter->src_.size() > this->max_buf_size || awaiter->dst_.size() > this->max_buf_size) {
+        return DOCA_ERROR_INVALID_VALUE;
+    }
+
+    doca_buf *buf_in = nullptr;
+    doca_buf *buf_out = nullptr;
+    auto err = doca_buf_inventory_buf_get_by_data(this->inventory, this->mmap_in,
+                                                  const_cast<uint8_t*>(awaiter->src_.data()),
+                                                  awaiter->src_.size(), &buf_in);
+    if (err != DOCA_SUCCESS) {
+        return err;
+    }
+
+    err = doca_buf_inventory_buf_get_by_addr(this->inventory, this->mmap_out, awaiter->dst_.data(),
+                                             awaiter->dst_.size(), &buf_out);
+    if (err != DOCA_SUCCESS) {
+        doca_buf_dec_refcount(buf_in, nullptr);
+        return err;
+    }
+
+    task_type *task = nullptr;
+    union doca_data task_user_data = { .ptr = awaiter };
+    err = Traits::allocInit(this->state_obj.compress, buf_in, buf_out, task_user_data, &task);
+    if (err != DOCA_SUCCESS) {
+        doca_buf_dec_refcount(buf_in, nullptr);
+        doca_buf_dec_refcount(buf_out, nullptr);
+        return err;
+    }
+
+    err = doca_task_submit(Traits::asTask(task));
+    if (err != DOCA_SUCCESS) {
+        doca_task_free(Traits::asTask(task));
+        doca_buf_dec_refcount(buf_in, nullptr);
+        doca_buf_dec_refcount(buf_out, nullptr);
+        return err;
+    }
+
+    ++this->in_flight_;
+    return DOCA_SUCCESS;
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::drainWaiting() {
+    while (this->in_flight_ < this->max_in_flight_ && !this->waiting_.empty()) {
+        TaskAwaiter *awaiter = this->waiting_.front();
+        this->waiting_.pop_front();
+        auto err = this->submit(awaiter);
+        if (err != DOCA_SUCCESS) {
+            awaiter->result_ = {err, 0};
+            ++this->failed_;
+            awaiter->handle_.resume();
+        }
+    }
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::finishTask(task_type *task, TaskAwaiter *awaiter) {
+    DocaCoroEngine *engine = awaiter->engine_;
+
+    doca_buf_dec_refcount(const_cast<doca_buf*>(Traits::getSrc(task)), nullptr);
+    doca_buf_dec_refcount(Traits::getDst(task), nullptr);
+    doca_task_free(Traits::asTask(task));
+    --engine->in_flight_;
+
+    // refill the freed slot first, queued awaiters are served in order
+    engine->drainWaiting();
+    awaiter->handle_.resume();
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::taskCompleted(task_type *task, union doca_data task_user_data,
+                                           union doca_data ctx_user_data) {
+    (void)ctx_user_data;
+    auto *awaiter = static_cast<TaskAwaiter*>(task_user_data.ptr);
+
+    size_t out_len = 0;
+    doca_buf_get_data_len(Traits::getDst(task), &out_len);
+    awaiter->result_ = {DOCA_SUCCESS, out_len, Traits::getCrc(task), Traits::getSecondChecksum(task)};
+    ++awaiter->engine_->completed_;
+
+    finishTask(task, awaiter);
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::taskFailed(task_type *task, union doca_data task_user_data,
+                                        union doca_data ctx_user_data) {
+    (void)ctx_user_data;
+    auto *awaiter = static_cast<TaskAwaiter*>(task_user_data.ptr);
+
+    awaiter->result_ = {doca_task_get_status(Traits::asTask(task)), 0};
+    ++awaiter->engine_->failed_;
+
+    finishTask(task, awaiter);
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::spawn(DocaCoroutine coroutine) {
+    auto handle = coroutine.handle();
+    handle.promise().finished = &this->finished_;
+    this->coroutines_.push_back(std::move(coroutine));
+
+    // long-running services spawn forever, drop finished frames now and then
+    if (this->coroutines_.size() >= 1024 && 2 * (this->finished_ - this->reaped_) >= this->coroutines_.size()) {
+        this->reap();
+    }
+    handle.resume();
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::reap() {
+    auto done = std::remove_if(this->coroutines_.begin(), this->coroutines_.end(), [this](const DocaCoroutine &coroutine) {
+        if (!coroutine.handle().done()) {
+            return false;
+        }
+        if (coroutine.handle().promise().error && !this->error_) {
+            this->error_ = coroutine.handle().promise().error;
+        }
+        return true;
+    });
+    this->reaped_ += std::distance(done, this->coroutines_.end());
+    this->coroutines_.erase(done, this->coroutines_.end());
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::run() {
+    while (this->finished_ - this->reaped_ < this->coroutines_.size()) {
+        if (this->in_flight_ == 0 && this->waiting_.empty()) {
+            throw std::runtime_error("DocaCoroEngine: coroutines suspended on something else than a DOCA task");
+        }
+        (void)doca_pe_progress(this->engine);
+    }
+    this->reap();
+
+    if (this->error_) {
+        std::rethrow_exception(std::exchange(this->error_, nullptr));
+    }
+}
+
+template <typename Traits>
+uint8_t DocaCoroEngine<Traits>::progress() {
+    return doca_pe_progress(this->engine);
+}
+
+template <typename Traits>
+void DocaCoroEngine<Traits>::cleanup() {
+    // tasks in flight still write into the buffers and resume their frames,
+    // let them complete before both go away
+    if (this->in_flight_ > 0) {
+        std::cerr << "DocaCoroEngine: cleanup with " << this->in_flight_ << " tasks in flight, draining" << std::endl;
+    }
+    while (this->in_flight_ > 0) {
+        (void)doca_pe_progress(this->engine);
+    }
+    this->ready_ = false;
+    this->releaseResources();
+    this->waiting_.clear();
+    this->coroutines_.clear();
+}
+
+template class DocaCoroEngine<CompressDeflateTraits>;
+template class DocaCoroEngine<DecompressDeflateTraits>;
+template class DocaCoroEngine<DecompressLz4Traits>;
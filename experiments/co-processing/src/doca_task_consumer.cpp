@@ -0,0 +1,823 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include <doca_buf.h>
+#include <doca_buf_inventory.h>
+#include <doca_compress.h>
+#include <doca_ctx.h>
+#include <doca_dev.h>
+#include <doca_error.h>
+#include <doca_log.h>
+#include <doca_mmap.h>
+#include <doca_pe.h>
+
+#include "doca_task_consumer.hpp"
+#include "engine.hpp"
+#include "logger.hpp"
+
+template <typename Traits>
+DocaTaskConsumer<Traits>::DocaTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, bool init)
+    requires (Traits::split_input)
+    : Buffers(dev_type, asked_buffer_size) {
+    if (init) {
+        this->initDocaContext();
+    }
+}
+
+template <typename Traits>
+DocaTaskConsumer<Traits>::DocaTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size,
+                                           uint64_t asked_num_buffers, size_t original_file_size, bool init)
+    requires (!Traits::split_input)
+    : Buffers(dev_type, asked_buffer_size, asked_num_buffers, original_file_size) {
+    if (init && this->valid_size) {
+        this->initDocaContext();
+    }
+}
+
+template <typename Traits>
+DocaTaskConsumer<Traits>::DocaTaskConsumer(DEVICE_TYPE dev_type) : Buffers(dev_type) {}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::initDocaContext() {
+    this->initialized = true;
+    this->init_timings.start();
+
+    // 1. init DOCA log
+    doca_log_backend_create_standard();
+    doca_log_backend_create_with_file_sdk(stderr, &this->sdkLog);
+    doca_log_backend_set_sdk_level(this->sdkLog, DOCA_LOG_LEVEL_WARNING);
+    this->init_timings.mark(InitStage::LOG);
+    std::cout << "1. init DOCA log" << std::endl;
+
+    // 2. read file and file size, or reserve the input of later jobs
+    if (this->warm_capacity_ > 0) {
+        this->reserveInput(this->warm_capacity_);
+    } else if (!this->readFile()) {
+        std::cerr << "2. error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::READ_FILE);
+    this->logInitStep("2. read file and file size");
+
+    // 3. determine final buffer size and prepare regions
+    if (!this->prepareBuffersAndRegions()) {
+        std::cerr << "3. error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::BUFFERS);
+    this->logInitStep("3. determine final buffer size and prepare regions");
+
+    // 4. prepare progress engine (no epoll)
+    auto err = this->prepareEngine();
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "4. error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::ENGINE);
+    this->logInitStep("4. prepare progress engine (no epoll)");
+
+    // 5. open device for compression
+    err = this->openDocaDevice();
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "5. error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::DEVICE);
+    this->logInitStep("5. open device for compression");
+
+    // 6. prepare mmaps (open memory mmap from C impl)
+    err = this->prepareMmaps(DOCA_ACCESS_FLAG_LOCAL_READ_WRITE, DOCA_ACCESS_FLAG_LOCAL_READ_WRITE);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "6. error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::MMAPS);
+    this->logInitStep("6. prepare mmaps (open memory mmap from C impl)");
+
+    // 7. make an inventory
+    err = doca_buf_inventory_create(this->task_slots * 2, &this->inventory);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "7.1 error" << std::endl;
+        return;
+    }
+    err = doca_buf_inventory_start(this->inventory);
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "7.2 error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::INVENTORY);
+    this->logInitStep("7. make an inventory");
+
+    // 8. populate user data object for context
+    this->state_obj = {
+        .in = this->indata,
+        .out = this->outdata,
+        .num_buffers = this->num_buffers,
+        .input_buffer_size = this->input_buff_size,
+        .output_buffer_size = this->output_buffer_size,
+        .offloaded = 0,
+        .completed = 0,
+
+        .mmap_in = this->mmap_in,
+        .mmap_out = this->mmap_out,
+        .buf_inv = this->inventory,
+        .out_regions = this->region_buffer,
+        .on_block = &this->block_handler,
+        .retrier = &this->retrier,
+        .checksums = &this->checksums
+    };
+    this->init_timings.mark(InitStage::STATE);
+    this->logInitStep("8. populate user data object for context");
+
+    // 9. open and start ctx
+    err = this->openCompressContext();
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "9 error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::CONTEXT);
+
+    // 10. allocate/prepare tasks from main thread
+    err = this->allocateCompressTasks();
+    if (err != DOCA_SUCCESS) {
+        std::cerr << "10. error" << std::endl;
+        return;
+    }
+    this->init_timings.mark(InitStage::TASKS);
+    this->logInitStep("10. allocate/prepare tasks from main thread");
+    this->armed_ = true;
+    this->ready_ = true;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::prepareEngine() {
+    doca_error_t err;
+    err = doca_pe_create(&this->engine);
+    if(err != DOCA_SUCCESS) {
+        doca_pe_destroy(this->engine);
+    }
+
+    return err;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::openDocaDevice() {
+    struct doca_devinfo **dev_list;
+    uint32_t nb_devs;
+    doca_error_t err;
+    uint8_t is_addr_equal = 0;
+    const char* pcie_addr = "87:00.0";
+    const char* pcie_addr_second = "87:00.1";
+    const char* pcie_addr_dpu0 = "67:00.0";
+    const char* pcie_addr_dpu0_second = "67:00.1";
+
+    err = doca_devinfo_create_list(&dev_list, &nb_devs);
+    if(err != DOCA_SUCCESS) {
+        return err;
+    }
+    std::cout << "Found " << nb_devs << " devices" << std::endl;
+
+    err = DOCA_ERROR_NOT_FOUND;
+    for(uint32_t i = 0; i < nb_devs; ++i) {
+        if (Traits::skip_dpu0) {
+            doca_devinfo_is_equal_pci_addr(dev_list[i], pcie_addr_dpu0, &is_addr_equal);
+        }
+        if (is_addr_equal) {
+            is_addr_equal = 0;
+            std::cout << "We found DPU0, skipping..." << std::endl;
+            continue;
+        }
+        if (Traits::skip_dpu0) {
+            doca_devinfo_is_equal_pci_addr(dev_list[i], pcie_addr_dpu0_second, &is_addr_equal);
+        }
+        if (is_addr_equal) {
+            is_addr_equal = 0;
+            std::cout << "We found DPU0 second, skipping..." << std::endl;
+            continue;
+        }
+        if(Traits::isSupported(dev_list[i]) == DOCA_SUCCESS) {
+            if(doca_dev_open(dev_list[i], &this->device) == DOCA_SUCCESS) {
+                err = DOCA_SUCCESS;
+                doca_devinfo_is_equal_pci_addr(dev_list[i], pcie_addr, &is_addr_equal);
+                if (is_addr_equal) {
+                    std::cout << "We chose DPU1" << std::endl;
+                }
+                doca_devinfo_is_equal_pci_addr(dev_list[i], pcie_addr_second, &is_addr_equal);
+                if (is_addr_equal) {
+                    std::cout << "We chose DPU1 second" << std::endl;
+                }
+                break;
+            } else {
+                std::cout << "Failed to open capable device " << i << ", due to: " << doca_error_get_descr(err) << std::endl;
+            }
+        }
+    }
+    doca_devinfo_destroy_list(dev_list);
+
+    return err;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::prepareMmaps(uint32_t in_permissions, uint32_t out_permissions) {
+    doca_error_t err;
+
+    // prep input
+    err = doca_mmap_create(&this->mmap_in);
+    if (err != DOCA_SUCCESS) {
+        this->mmap_in = nullptr;
+    }
+
+    err = doca_mmap_set_memrange(this->mmap_in, this->indata, this->num_buffers * this->input_buff_size);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_in);
+    }
+
+    err = doca_mmap_set_permissions(this->mmap_in, in_permissions);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_in);
+    }
+
+    err = doca_mmap_add_dev(this->mmap_in, this->device);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_in);
+    }
+
+    err = doca_mmap_start(this->mmap_in);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_in);
+    }
+
+    // prep output
+    err = doca_mmap_create(&this->mmap_out);
+    if (err != DOCA_SUCCESS) {
+        this->mmap_out = nullptr;
+    }
+
+    err = doca_mmap_set_memrange(this->mmap_out, this->outdata, this->num_buffers * this->output_buffer_size);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_out);
+    }
+
+    err = doca_mmap_set_permissions(this->mmap_out, out_permissions);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_out);
+    }
+
+    err = doca_mmap_add_dev(this->mmap_out, this->device);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_out);
+    }
+
+    err = doca_mmap_start(this->mmap_out);
+    if(err != DOCA_SUCCESS) {
+        doca_mmap_destroy(this->mmap_out);
+    }
+
+    return err;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::openCompressContext() {
+    return this->openCompressContext(completedCallback, errorCallback, this->task_slots);
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::openCompressContext(typename Traits::callback_type completed,
+                                                           typename Traits::callback_type failed,
+                                                           uint32_t num_tasks) {
+    doca_error_t err;
+
+    err = doca_compress_create(this->device, &this->state_obj.compress);
+    if(err != DOCA_SUCCESS) {
+        return err;
+    }
+
+    ctx = doca_compress_as_ctx(this->state_obj.compress);
+
+    union doca_data ctx_user_data = { .ptr = &this->state_obj };
+    err = doca_ctx_set_user_data(this->ctx, ctx_user_data);
+    if(err != DOCA_SUCCESS) {
+        doca_compress_destroy(this->state_obj.compress);
+        return err;
+    }
+
+    err = Traits::setConf(this->state_obj.compress, completed, failed, num_tasks);
+    if(err != DOCA_SUCCESS) {
+        doca_compress_destroy(this->state_obj.compress);
+        return err;
+    }
+
+    err = doca_pe_connect_ctx(this->engine, this->ctx);
+    if(err != DOCA_SUCCESS) {
+        doca_compress_destroy(this->state_obj.compress);
+        return err;
+    }
+
+    err = doca_ctx_start(this->ctx);
+    if(err != DOCA_SUCCESS) {
+        doca_compress_destroy(this->state_obj.compress);
+        return err;
+    }
+
+    return DOCA_SUCCESS;
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::logInitStep(const char *step) {
+    if constexpr (Traits::log_init_steps) {
+        std::cout << step << std::endl;
+    }
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::allocateCompressTasks() {
+    doca_error_t err;
+    uint32_t task_id = 0;
+    this->state_obj.tasks = static_cast<task_type**>(
+        std::calloc(this->state_obj.num_buffers, sizeof(*this->state_obj.tasks))
+    );
+
+    for (task_id = 0; task_id < this->state_obj.num_buffers; task_id++) {
+        size_t offset = this->state_obj.input_buffer_size * task_id;
+        size_t output_offset = this->state_obj.output_buffer_size * task_id;
+
+        doca_buf *buf_in = nullptr;
+        doca_buf *buf_out = nullptr;
+
+        err = doca_buf_inventory_buf_get_by_data(this->state_obj.buf_inv, 
+                                                 this->state_obj.mmap_in, 
+                                                 static_cast<std::uint8_t*>(this->state_obj.in) + offset, 
+                                                 this->state_obj.input_buffer_size, 
+                                                 &buf_in);
+        if(err != DOCA_SUCCESS) {
+            return err;
+        }
+
+        err = doca_buf_inventory_buf_get_by_addr(this->state_obj.buf_inv, 
+                                                 this->state_obj.mmap_out, 
+                                                 static_cast<std::uint8_t*>(this->state_obj.out) + output_offset, 
+                                                 this->state_obj.output_buffer_size, 
+                                                 &buf_out);
+        if(err != DOCA_SUCCESS) {
+            doca_buf_dec_refcount(buf_in, nullptr);
+            return err;
+        }
+
+        union doca_data task_user_data = { .u64 = task_id };
+        err = Traits::allocInit(this->state_obj.compress, 
+                                                             buf_in, 
+                                                             buf_out, 
+                                                             task_user_data, 
+                                                             &this->state_obj.tasks[task_id]);
+        if(err != DOCA_SUCCESS) {
+            doca_buf_dec_refcount(buf_out, nullptr);
+            return err;
+        }
+    }
+
+    return err;
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::dropTask(uint32_t task_id) {
+    task_type *task = this->state_obj.tasks[task_id];
+    doca_buf_dec_refcount(const_cast<doca_buf*>(Traits::getSrc(task)), nullptr);
+    doca_buf_dec_refcount(Traits::getDst(task), nullptr);
+    doca_task_free(Traits::asTask(task));
+    ++this->state_obj.completed;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::submitCompressTasks() {
+	uint32_t task_id = 0;
+    doca_error_t err = DOCA_SUCCESS;
+    std::vector<uint32_t> stored;
+
+	for (task_id = 0; task_id < this->state_obj.num_buffers; task_id++) {
+        // chunks not worth compressing stay off the device
+        if constexpr (Traits::codec == TaskCodec::DEFLATE) {
+            if (this->estimator.incompressible(this->indata + this->input_buff_size * task_id, this->input_buff_size)) {
+                this->dropTask(task_id);
+                stored.push_back(task_id);
+                continue;
+            }
+        }
+        err = doca_task_submit(Traits::asTask(this->state_obj.tasks[task_id]));
+        if (err != DOCA_SUCCESS) {
+            break;
+        }
+        this->init_timings.submitted();
+    }
+
+    // the device takes no more, the rest of the batch goes to the host
+    for (; task_id < this->state_obj.num_buffers; task_id++) {
+        this->dropTask(task_id);
+        this->retrier.retry(task_id, this->indata + this->input_buff_size * task_id, this->input_buff_size,
+                            this->output_buffer_size, false);
+    }
+
+    // stored blocks of the skipped chunks, while the device works
+    for (uint32_t stored_id : stored) {
+        this->retrier.store(stored_id, this->indata + this->input_buff_size * stored_id, this->input_buff_size);
+    }
+
+	return err;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::pollTillCompletion() {
+    const std::chrono::duration<double, std::milli> timeout(this->retrier.policy().task_timeout_ms);
+    auto last_completion = std::chrono::steady_clock::now();
+    bool gave_up = false;
+
+	/* This loop ticks the progress engine, and the host retries of failed tasks */
+	while ((!gave_up && this->state_obj.completed < this->state_obj.num_buffers) || !this->retrier.idle()) {
+		/**
+		 * doca_pe_progress shall return 1 if a task was completed and 0 if not.
+		 */
+		if (doca_pe_progress(this->engine)) {
+			last_completion = std::chrono::steady_clock::now();
+		} else if (!gave_up && timeout.count() > 0 && std::chrono::steady_clock::now() - last_completion > timeout) {
+			// the device stalled, redo what it still holds on the host, late completions are ignored
+			for (size_t task_id : this->retrier.missing()) {
+				this->retrier.retry(task_id, this->indata + this->input_buff_size * task_id, this->input_buff_size,
+				                    this->output_buffer_size, true);
+			}
+			gave_up = true;
+		}
+		this->retrier.progress();
+	}
+
+	// the device still holds tasks of the given-up chunks: flush them before
+	// the next run or the release, so no late completion lands in either
+	if (gave_up && this->state_obj.completed < this->state_obj.num_buffers) {
+		if (this->stopContext() != DOCA_SUCCESS) {
+			std::cerr << "DOCA context could not be stopped after the timeout" << std::endl;
+		}
+	}
+
+	return gave_up ? DOCA_ERROR_TIME_OUT : DOCA_SUCCESS;
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::stopContext() {
+    if (this->ctx == nullptr || this->ctx_stopped_) {
+        return DOCA_SUCCESS;
+    }
+    doca_error_t err = doca_ctx_stop(this->ctx);
+    if (err == DOCA_ERROR_IN_PROGRESS) {
+        // the flushed tasks complete (with an error) through the progress engine
+        enum doca_ctx_states state = DOCA_CTX_STATE_STOPPING;
+        do {
+            (void)doca_pe_progress(this->engine);
+            err = doca_ctx_get_state(this->ctx, &state);
+        } while (err == DOCA_SUCCESS && state != DOCA_CTX_STATE_IDLE);
+    }
+    this->ctx_stopped_ = err == DOCA_SUCCESS;
+    return err;
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::executeDocaTask() {
+    this->init_timings.running();
+    this->armed_ = false;
+    // blocks redone on the host land in the regions like device ones
+    this->retrier.reset(this->num_buffers);
+    this->checksums.reset(this->num_buffers, checksumKind(Traits::codec));
+    this->retrier.setDoneHandler([this](size_t task_id, const uint8_t *data, size_t len) {
+        if (this->checksums.enabled()) {
+            if constexpr (Traits::codec == TaskCodec::DEFLATE) {
+                this->checksums.record(task_id, this->indata + this->input_buff_size * task_id, this->input_buff_size);
+            } else {
+                this->checksums.record(task_id, data, len);
+            }
+        }
+        this->region_buffer[task_id].base = const_cast<uint8_t*>(data);
+        this->region_buffer[task_id].size = static_cast<uint32_t>(len);
+        if (this->block_handler) {
+            this->block_handler(task_id, data, len);
+        }
+        this->state_obj.end = std::chrono::steady_clock::now();
+    });
+
+    // 11. submit array of tasks
+    this->submit_start = std::chrono::steady_clock::now();
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    this->thread_time_start = ts.tv_sec + ts.tv_nsec * 1e-9;
+
+    auto result = this->submitCompressTasks();
+    if (result != DOCA_SUCCESS) {
+        std::cout << "DOCA Task submission with errors" << std::endl;
+    }
+
+    this->submit_end = std::chrono::steady_clock::now();
+
+    // 12. tick and wait for completion
+    result = this->pollTillCompletion();
+    if (result != DOCA_SUCCESS) {
+        std::cout << "DOCA Task polling has errors" << std::endl;
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    this->thread_time_end = ts.tv_sec + ts.tv_nsec * 1e-9;
+    this->busy_wait_end = std::chrono::steady_clock::now();
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::completedCallback(task_type *compress_task,
+                                                           union doca_data task_user_data,
+                                                           union doca_data ctx_user_data) {
+    size_t task_id = (size_t) task_user_data.u64;
+    auto *state = (compression_state<task_type> *) ctx_user_data.ptr;
+
+    struct doca_buf const *buf_in = Traits::getSrc(compress_task);
+    struct doca_buf *buf_out = Traits::getDst(compress_task);
+
+    void *out_head;
+    size_t out_len;
+    doca_buf_get_data(buf_out, &out_head);
+    doca_buf_get_data_len(buf_out, &out_len);
+
+    ++state->completed;
+    // a late completion of a timed-out task, the host retry owns the region
+    if (state->retrier->offloaded(task_id)) {
+        if (state->checksums->enabled()) {
+            // the checksums cover the uncompressed side: the input of a compress, the output of a decompress
+            void *plain = out_head;
+            size_t plain_len = out_len;
+            if constexpr (Traits::codec == TaskCodec::DEFLATE) {
+                doca_buf_get_data(buf_in, &plain);
+                doca_buf_get_data_len(buf_in, &plain_len);
+            }
+            if (!state->checksums->verify(task_id, {Traits::getCrc(compress_task), Traits::getSecondChecksum(compress_task)},
+                                          static_cast<const uint8_t*>(plain), plain_len)) {
+                std::cerr << "Checksum mismatch in block " << task_id << std::endl;
+            }
+        }
+        state->out_regions[task_id].base = static_cast<uint8_t*>(out_head);
+        state->out_regions[task_id].size = out_len;
+        if (state->on_block && *state->on_block) {
+            (*state->on_block)(task_id, static_cast<const uint8_t*>(out_head), out_len);
+        }
+    }
+
+    doca_buf_dec_refcount((struct doca_buf*) buf_in, NULL);
+    doca_buf_dec_refcount(buf_out, NULL);
+    doca_task_free(Traits::asTask(compress_task));
+
+    state->end = std::chrono::steady_clock::now();
+
+    // if(state->offloaded < state->num_buffers) {
+    //     offload_next(state);
+    // } else if(state->completed == state->num_buffers) {
+    //     // clock_gettime(CLOCK_MONOTONIC, &state->end);
+    //     doca_ctx_stop(doca_compress_as_ctx(state->compress));
+    // }
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::errorCallback(task_type *compress_task,
+                                                       union doca_data task_user_data,
+                                                       union doca_data ctx_user_data) {
+    size_t task_id = (size_t) task_user_data.u64;
+
+    /* This sample defines that a task is completed even if it is completed with error */
+    auto *state = (compression_state<task_type> *) ctx_user_data.ptr;
+    ++state->completed; 
+
+    // requeue the chunk to the host instead of leaving a hole in out_regions
+    state->retrier->retry(task_id, static_cast<const uint8_t*>(state->in) + state->input_buffer_size * task_id,
+                          state->input_buffer_size, state->output_buffer_size, false);
+
+    struct doca_buf const *src = Traits::getSrc(compress_task);
+    struct doca_buf *dst = Traits::getDst(compress_task);
+
+    doca_buf_dec_refcount((struct doca_buf*) src, nullptr);
+    doca_buf_dec_refcount(dst, nullptr);
+    doca_task_free(Traits::asTask(compress_task));
+
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::stateChangedCallback(union doca_data user_data, struct doca_ctx *ctx, 
+                                                doca_ctx_states prev_state, doca_ctx_states next_state) {
+    (void) ctx;
+    (void) prev_state;
+
+    if(next_state == DOCA_CTX_STATE_RUNNING) {
+        auto *state = (compression_state<task_type> *) user_data.ptr;
+        state->start = std::chrono::steady_clock::now();
+    }
+}
+
+template <typename Traits>
+doca_error_t DocaTaskConsumer<Traits>::releaseResources() {
+    if (this->released) {
+        return DOCA_SUCCESS;
+    }
+    this->released = true;
+
+    // host retries write to the regions, finish them first
+    this->retrier.stop();
+
+    this->ctx_stop_start = std::chrono::steady_clock::now();
+
+    /* A context must be stopped, and its tasks flushed, before it is destroyed */
+    (void)this->stopContext();
+    this->ctx_stop_end = std::chrono::steady_clock::now();
+
+    /* All contexts must be destroyed before PE is destroyed. Context destroy disconnects it from the PE */
+    if (this->state_obj.compress != nullptr) {
+        (void) doca_compress_destroy(this->state_obj.compress);
+    }
+
+    this->ctx_stop_end = std::chrono::steady_clock::now();
+
+    if (this->engine != nullptr) {
+        (void)doca_pe_destroy(this->engine);
+    }
+
+	if (this->inventory != nullptr) {
+		(void)doca_buf_inventory_stop(this->inventory);
+		(void)doca_buf_inventory_destroy(this->inventory);
+	}
+
+	if (this->mmap_in != nullptr) {
+		(void)doca_mmap_stop(this->mmap_in);
+		(void)doca_mmap_destroy(this->mmap_in);
+	}
+
+    if (this->mmap_out != nullptr) {
+		(void)doca_mmap_stop(this->mmap_out);
+		(void)doca_mmap_destroy(this->mmap_out);
+	}
+
+	if (this->device != nullptr) {
+        (void)doca_dev_close(this->device);
+    }
+
+    this->releaseBuffers();
+
+    return DOCA_SUCCESS;
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::setBlockHandler(doca_block_handler handler) {
+    this->block_handler = std::move(handler);
+}
+
+template <typename Traits>
+std::vector<std::string> DocaTaskConsumer<Traits>::getDocaResults() {
+    // clean doca structs, unless another run follows
+    if (!this->keep_alive_) {
+        this->releaseResources();
+    }
+    
+    // ctx stop time from cleanup (add to overall later)
+    auto ctx_stop_elapsed = this->calculateSeconds(this->ctx_stop_end, this->ctx_stop_start);
+
+    // overall submission time
+    auto overall_submission_elapsed = this->calculateSeconds(this->busy_wait_end, this->submit_start);
+
+    // task submission time
+    auto task_submission_elapsed = this->calculateSeconds(this->submit_end, this->submit_start);
+
+    // busy-wait time
+    auto busy_wait_elapsed = this->calculateSeconds(this->busy_wait_end, this->submit_end);
+
+    // from task submission to last success cb
+    auto cb_elapsed = this->calculateSeconds(this->state_obj.end, this->submit_start);
+
+    // from last success cb to busy-wait end
+    auto cb_end_elapsed = this->calculateSeconds(this->busy_wait_end, this->state_obj.end);
+
+    // cpu+sys time from submission to end of busy-wait
+    auto cpu_time_elapsed = this->thread_time_end - this->thread_time_start;
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8) << cpu_time_elapsed;
+    std::string thread_time_elapsed = oss.str();
+
+    // Create vector of results
+    return std::vector<std::string>{overall_submission_elapsed, task_submission_elapsed, 
+        busy_wait_elapsed, cb_elapsed, cb_end_elapsed, ctx_stop_elapsed, thread_time_elapsed};
+}
+
+template <typename Traits>
+DocaTaskConsumer<Traits>::~DocaTaskConsumer() = default;
+
+template <typename Traits>
+std::string DocaTaskConsumer<Traits>::getName() {
+    return Traits::name;
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::init() {
+    if (!this->initialized) {
+        this->initDocaContext();
+    }
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::execute() {
+    this->executeDocaTask();
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::cleanup() {
+    this->releaseResources();
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::rearm() {
+    if (!this->ready_ || this->armed_) {
+        return;
+    }
+    // a timeout stopped the context, every task of that run has come back
+    if (this->ctx_stopped_) {
+        if (doca_ctx_start(this->ctx) != DOCA_SUCCESS) {
+            std::cerr << "DOCA context could not be started again" << std::endl;
+            return;
+        }
+        this->ctx_stopped_ = false;
+    }
+    std::free(this->state_obj.tasks);
+    this->state_obj.tasks = nullptr;
+    this->state_obj.completed = 0;
+    if (this->allocateCompressTasks() != DOCA_SUCCESS) {
+        std::cerr << "DOCA tasks could not be allocated again" << std::endl;
+        return;
+    }
+    this->armed_ = true;
+}
+
+template <typename Traits>
+bool DocaTaskConsumer<Traits>::reshape(size_t bytes, uint64_t buffer_size, uint64_t max_buffers)
+    requires (Traits::split_input) {
+    if (!this->ready_) {
+        return false;
+    }
+    this->disarm();
+    if (!this->layoutPrefix(bytes, buffer_size, max_buffers)) {
+        return false;
+    }
+    return this->armLayout();
+}
+
+template <typename Traits>
+bool DocaTaskConsumer<Traits>::warmUp(size_t capacity) {
+    if (this->initialized || capacity == 0) {
+        return false;
+    }
+    this->warm_capacity_ = capacity;
+    this->initDocaContext();
+    return this->ready_;
+}
+
+template <typename Traits>
+bool DocaTaskConsumer<Traits>::load(const uint8_t *data, size_t bytes) {
+    if (!this->ready_) {
+        return false;
+    }
+    this->init_timings.start();
+    this->disarm();
+    if (!this->loadInput(data, bytes)) {
+        return false;
+    }
+    this->init_timings.mark(InitStage::READ_FILE);
+    bool armed = this->armLayout();
+    this->init_timings.mark(InitStage::TASKS);
+    return armed;
+}
+
+template <typename Traits>
+void DocaTaskConsumer<Traits>::disarm() {
+    // the tasks of the previous layout give their buffers back to the inventory
+    if (this->armed_) {
+        for (uint32_t task_id = 0; task_id < this->state_obj.num_buffers; ++task_id) {
+            this->dropTask(task_id);
+        }
+        this->armed_ = false;
+    }
+}
+
+template <typename Traits>
+bool DocaTaskConsumer<Traits>::armLayout() {
+    this->state_obj.num_buffers = this->num_buffers;
+    this->state_obj.input_buffer_size = this->input_buff_size;
+    this->state_obj.output_buffer_size = this->output_buffer_size;
+    this->rearm();
+    return this->armed_;
+}
+
+template class DocaTaskConsumer<CompressDeflateTraits>;
+template class DocaTaskConsumer<DecompressDeflateTraits>;
+template class DocaTaskConsumer<DecompressLz4Traits>;
+
+static_assert(NamedEngine<DocaTaskConsumer<CompressDeflateTraits>>);
+static_assert(NamedEngine<DocaTaskConsumer<DecompressDeflateTraits>>);
+static_assert(NamedEngine<DocaTaskConsumer<DecompressLz4Traits>>);
@@ -0,0 +1,252 @@
+#include "inflate_regex_pipe.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "zlib.h"
+
+#include "re2_pipe.hpp"
+
+// Compressed bytes handed to inflate per call, as in Zpipe::inf
+static const size_t CHUNK = 16384;
+
+// Blocking FIFO between the inflate and the scan thread.
+template <typename T>
+class HandoffQueue {
+public:
+    void push(T value) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_items.push_back(value);
+        }
+        m_cond.notify_one();
+    }
+
+    T pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cond.wait(lock, [this] { return !m_items.empty(); });
+        T value = m_items.front();
+        m_items.pop_front();
+        return value;
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<T> m_items;
+};
+
+// An inflated chunk, last marks the end of the stream
+struct FilledChunk {
+    size_t chunk;
+    size_t size;
+    bool last;
+};
+
+static bool isCompressed(const std::vector<unsigned char>& data) {
+    if (data.size() < 2) {
+        return false;
+    }
+    bool gzip = data[0] == 0x1f && data[1] == 0x8b;
+    // zlib header with the 32 KiB window, other windows would also match plain text
+    bool zlib = data[0] == 0x78 && (data[0] * 256 + data[1]) % 31 == 0;
+    return gzip || zlib;
+}
+
+// Constructor: initialize members.
+InflateRegexPipe::InflateRegexPipe(const std::string& input_location, RegexScanOptions options, size_t chunk_size)
+    : iters_(3), input_location_(input_location), options_(options), chunk_size_(chunk_size) {
+    if (chunk_size_ == 0 || chunk_size_ > std::numeric_limits<uInt>::max()) {
+        throw std::runtime_error("Invalid inflate chunk size");
+    }
+}
+
+bool InflateRegexPipe::isCompressedFile(const std::string& file_location) {
+    std::ifstream data_file(file_location, std::ios::binary);
+    std::vector<unsigned char> magic(2, 0);
+    data_file.read(reinterpret_cast<char*>(magic.data()), magic.size());
+    return data_file.gcount() == 2 && isCompressed(magic);
+}
+
+// init: Precompile regex patterns and prepare the compressed stream.
+void InflateRegexPipe::init() {
+    queries_ = options_.query_file.empty() ? defaultRegexQueries() : loadRegexQueries(options_.query_file);
+    for (const auto &query : queries_) {
+        patterns_.push_back(query.pattern);
+    }
+    regexes_ = options_.shared_re2 ? options_.shared_re2 : Re2Pipe::compile(patterns_, options_);
+    if (options_.prefilter) {
+        prefilter_ = std::make_unique<LiteralPrefilter>(patterns_);
+    }
+    scanner_ = std::make_unique<LineScanner>(queries_, regexes_, prefilter_.get());
+
+    std::ifstream data_file(input_location_, std::ios::binary);
+    if (!data_file.is_open()) {
+        throw std::runtime_error("Could not open data file");
+    }
+    std::vector<unsigned char> data((std::istreambuf_iterator<char>(data_file)), std::istreambuf_iterator<char>());
+    const bool whole_input = options_.rows.begin <= 0.0 && options_.rows.end >= 1.0;
+
+    if (isCompressed(data)) {
+        // A deflate stream can not be entered in the middle
+        if (!whole_input) {
+            throw std::runtime_error("A compressed input can not be split by rows, give it to a single worker");
+        }
+        compressed_ = std::move(data);
+        skip_header_ = true;
+    } else {
+        // Keep the header plus this pipe's rows, then deflate them
+        std::vector<size_t> line_starts;
+        for (size_t pos = 0; pos < data.size();) {
+            line_starts.push_back(pos);
+            auto newline = std::find(data.begin() + pos, data.end(), '\n');
+            pos = newline == data.end() ? data.size() : newline - data.begin() + 1;
+        }
+        line_starts.push_back(data.size());
+        const size_t num_rows = line_starts.size() > 2 ? line_starts.size() - 2 : 0;
+        size_t begin = std::min(num_rows, static_cast<size_t>(options_.rows.begin * num_rows));
+        size_t end = options_.rows.end >= 1.0 ? num_rows
+                                              : std::min(num_rows, static_cast<size_t>(options_.rows.end * num_rows));
+        end = std::max(begin, end);
+        // Row r is line r + 1, the header stays with the first share
+        size_t text_begin = begin == 0 ? 0 : line_starts[begin + 1];
+        size_t text_end = num_rows == 0 ? data.size() : line_starts[end + 1];
+        skip_header_ = begin == 0;
+
+        uLong text_size = static_cast<uLong>(text_end - text_begin);
+        uLongf compressed_size = compressBound(text_size);
+        compressed_.resize(compressed_size);
+        if (compress2(compressed_.data(), &compressed_size, data.data() + text_begin, text_size,
+                      Z_DEFAULT_COMPRESSION) != Z_OK) {
+            throw std::runtime_error("Deflating the input failed");
+        }
+        compressed_.resize(compressed_size);
+    }
+    chunks_.assign(NUM_CHUNKS, std::vector<char>(chunk_size_));
+
+    std::cerr << "Inflate regex input: " << compressed_.size() << " bytes compressed, "
+              << NUM_CHUNKS << " chunks of " << chunk_size_ << " bytes" << std::endl;
+}
+
+void InflateRegexPipe::inflateAndScan() {
+    HandoffQueue<size_t> free_chunks;
+    HandoffQueue<FilledChunk> filled_chunks;
+    for (size_t chunk = 0; chunk < chunks_.size(); ++chunk) {
+        free_chunks.push(chunk);
+    }
+
+    // Inflate thread: fill free chunks until the input ends
+    std::string error;
+    std::thread inflater([&] {
+        z_stream stream{};
+        if (inflateInit2(&stream, MAX_WBITS + 32) != Z_OK) { // zlib or gzip header
+            error = "inflateInit2 failed";
+            filled_chunks.push({0, 0, true});
+            return;
+        }
+        size_t consumed = 0;
+        bool done = false;
+        while (!done && error.empty()) {
+            size_t chunk = free_chunks.pop();
+            stream.next_out = reinterpret_cast<Bytef*>(chunks_[chunk].data());
+            stream.avail_out = static_cast<uInt>(chunk_size_);
+            while (stream.avail_out > 0) {
+                if (stream.avail_in == 0) {
+                    size_t feed = std::min(CHUNK, compressed_.size() - consumed);
+                    stream.next_in = compressed_.data() + consumed;
+                    stream.avail_in = static_cast<uInt>(feed);
+                    consumed += feed;
+                }
+                int ret = inflate(&stream, Z_NO_FLUSH);
+                if (ret == Z_STREAM_END) {
+                    // Concatenated gzip members continue after the end of a stream
+                    if (stream.avail_in == 0 && consumed == compressed_.size()) {
+                        done = true;
+                        break;
+                    }
+                    inflateReset(&stream);
+                } else if (ret == Z_BUF_ERROR && stream.avail_in == 0 && consumed == compressed_.size()) {
+                    error = "truncated deflate stream";
+                    break;
+                } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+                    error = stream.msg ? stream.msg : "inflate failed";
+                    break;
+                }
+            }
+            filled_chunks.push({chunk, chunk_size_ - stream.avail_out, false});
+        }
+        inflateEnd(&stream);
+        filled_chunks.push({0, 0, true});
+    });
+
+    // Scan thread: split and match each chunk, then hand it back
+    double wait_seconds = 0.0;
+    while (true) {
+        auto wait_start = std::chrono::high_resolution_clock::now();
+        FilledChunk filled = filled_chunks.pop();
+        wait_seconds += std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - wait_start).count();
+        if (filled.last) {
+            break;
+        }
+        scanner_->consume(chunks_[filled.chunk].data(), filled.size);
+        free_chunks.push(filled.chunk);
+    }
+    inflater.join();
+    if (!error.empty()) {
+        throw std::runtime_error("Inflate failed: " + error);
+    }
+    scanner_->finish();
+    avg_wait_seconds_ += wait_seconds;
+}
+
+// execute: Inflate on one thread, scan on this one.
+void InflateRegexPipe::execute() {
+    std::cerr << "Inflate regex starting iters..." << std::endl;
+    avg_seconds_ = 0.0;
+    avg_wait_seconds_ = 0.0;
+    for (int iter = 0; iter < iters_; ++iter) {
+        scanner_->reset(skip_header_);
+        auto start = std::chrono::high_resolution_clock::now();
+        this->inflateAndScan();
+        auto end = std::chrono::high_resolution_clock::now();
+        avg_seconds_ += std::chrono::duration<double>(end - start).count();
+    }
+    avg_seconds_ /= iters_;
+    avg_wait_seconds_ /= iters_;
+}
+
+// cleanup: Output the benchmark results.
+void InflateRegexPipe::cleanup() {
+    results_.clear();
+    const size_t rows = scanner_->rows();
+    for (size_t idx = 0; idx < queries_.size(); ++idx) {
+        // bytes are the inflated bytes, full (mib/s) is the end-to-end plaintext rate
+        RegexQueryResult result{queries_[idx].id, scanner_->bytes(), 1.0, avg_seconds_,
+                                scanner_->matches()[idx], 1.0, 0.0, 0, -1, -1};
+        if (rows) {
+            result.prefilter_pass = static_cast<double>(scanner_->prefilterPassed()[idx]) / rows;
+        }
+        results_.push_back(result);
+    }
+
+    std::string device = options_.device + "_inflate_re2";
+    device += options_.prefilter ? "_prefilter" : "";
+    printRegexReport(device, results_);
+
+    // Rows per second from compressed input, the wait shows whether inflate or the scan limits
+    double seconds = avg_seconds_ > 0.0 ? avg_seconds_ : 1.0;
+    std::cout << "device (str),compressed (bytes),plaintext (bytes),rows (count),seconds (s),"
+              << "scan_wait (s),rows (rows/s),compressed (mib/s)" << std::endl;
+    std::cout << device << "," << compressed_.size() << "," << scanner_->bytes() << "," << rows << ","
+              << avg_seconds_ << "," << avg_wait_seconds_ << "," << rows / seconds << ","
+              << compressed_.size() / seconds / 1048576.0 << std::endl;
+}
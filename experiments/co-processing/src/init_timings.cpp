@@ -0,0 +1,54 @@
+#include "init_timings.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+void InitTimings::start() {
+    last_ = std::chrono::steady_clock::now();
+    seconds_.fill(0.0);
+    running_ = false;
+    submitted_ = false;
+}
+
+void InitTimings::mark(InitStage stage) {
+    auto now = std::chrono::steady_clock::now();
+    seconds_[static_cast<size_t>(stage)] += std::chrono::duration<double>(now - last_).count();
+    last_ = now;
+}
+
+void InitTimings::running() {
+    run_start_ = std::chrono::steady_clock::now();
+    running_ = true;
+    submitted_ = false;
+}
+
+void InitTimings::submitted() {
+    if (running_ && !submitted_) {
+        first_submit_ = std::chrono::steady_clock::now();
+        submitted_ = true;
+    }
+}
+
+double InitTimings::totalSeconds() const {
+    double total = 0.0;
+    for (double seconds : seconds_) {
+        total += seconds;
+    }
+    return total;
+}
+
+std::vector<std::string> InitTimings::toStrings() const {
+    auto format = [](double value) {
+        std::ostringstream oss;
+        oss << std::fixed << std::setprecision(8) << value;
+        return oss.str();
+    };
+    std::vector<std::string> values;
+    for (double seconds : seconds_) {
+        values.push_back(format(seconds));
+    }
+    values.push_back(format(totalSeconds()));
+    // no task submitted yet: 0
+    values.push_back(format(submitted_ ? std::chrono::duration<double>(first_submit_ - run_start_).count() : 0.0));
+    return values;
+}
@@ -0,0 +1,126 @@
+#include "libdeflate_pipe.hpp"
+
+#include <iostream>
+
+static const size_t READ_CHUNK = 16384;
+// output guess of an inflate without a known size, per input byte
+static const size_t INFLATE_GROWTH = 4;
+
+LibdeflatePipe::LibdeflatePipe(int level) : m_level(level) {}
+
+LibdeflatePipe::~LibdeflatePipe() {
+    m_cleanup();
+}
+
+int LibdeflatePipe::m_init(const std::string &inFilename, const std::string &outFilename) {
+    FILE *inFile = std::fopen(inFilename.c_str(), "rb");
+    if (!inFile) {
+        std::cerr << "Failed to open input file: " << inFilename << "\n";
+        return -1;
+    }
+
+    m_input.clear();
+    unsigned char temp[READ_CHUNK];
+    size_t bytesRead;
+    while ((bytesRead = std::fread(temp, 1, READ_CHUNK, inFile)) > 0) {
+        m_input.insert(m_input.end(), temp, temp + bytesRead);
+    }
+    bool failed = std::ferror(inFile);
+    std::fclose(inFile);
+    if (failed || m_input.empty()) {
+        std::cerr << "Error reading file in full.\n";
+        m_input.clear();
+        return -1;
+    }
+
+    m_outFile = std::fopen(outFilename.c_str(), "wb");
+    if (!m_outFile) {
+        std::cerr << "Failed to open output file: " << outFilename << "\n";
+        m_input.clear();
+        return -1;
+    }
+    return 0;
+}
+
+int LibdeflatePipe::deflate_init(const std::string &inFilename, const std::string &outFilename) {
+    if (m_init(inFilename, outFilename) != 0) {
+        std::cerr << "Failed to init DEFLATE" << std::endl;
+        return -1;
+    }
+    m_compressor = libdeflate_alloc_compressor(m_level);
+    if (!m_compressor) {
+        std::cerr << "Failed to allocate libdeflate compressor (level " << m_level << ")\n";
+        return -1;
+    }
+    m_output.resize(libdeflate_deflate_compress_bound(m_compressor, m_input.size()));
+    return 0;
+}
+
+int LibdeflatePipe::inflate_init(const std::string &inFilename, const std::string &outFilename, size_t original_size) {
+    if (m_init(inFilename, outFilename) != 0) {
+        std::cerr << "Failed to init INFLATE" << std::endl;
+        return -1;
+    }
+    m_decompressor = libdeflate_alloc_decompressor();
+    if (!m_decompressor) {
+        std::cerr << "Failed to allocate libdeflate decompressor\n";
+        return -1;
+    }
+    m_output.resize(original_size > 0 ? original_size : m_input.size() * INFLATE_GROWTH);
+    return 0;
+}
+
+int LibdeflatePipe::deflate_execute() {
+    m_outputSize = libdeflate_deflate_compress(m_compressor, m_input.data(), m_input.size(),
+                                               m_output.data(), m_output.size());
+    if (m_outputSize == 0) {
+        std::cerr << "libdeflate compression failed.\n";
+        return -1;
+    }
+    return 0;
+}
+
+int LibdeflatePipe::inflate_execute() {
+    // no streaming: a too small guess is retried with twice the space
+    libdeflate_result ret;
+    while ((ret = libdeflate_deflate_decompress(m_decompressor, m_input.data(), m_input.size(), m_output.data(),
+                                                m_output.size(), &m_outputSize)) == LIBDEFLATE_INSUFFICIENT_SPACE) {
+        m_output.resize(m_output.size() * 2);
+    }
+    if (ret != LIBDEFLATE_SUCCESS) {
+        std::cerr << "libdeflate decompression failed (" << ret << ").\n";
+        m_outputSize = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void LibdeflatePipe::m_cleanup() {
+    if (m_outFile) {
+        size_t written = std::fwrite(m_output.data(), 1, m_outputSize, m_outFile);
+        if (written != m_outputSize || std::ferror(m_outFile)) {
+            std::cerr << "Error writing FULL data." << std::endl;
+        }
+        std::fclose(m_outFile);
+        m_outFile = nullptr;
+    }
+    if (m_compressor) {
+        libdeflate_free_compressor(m_compressor);
+        m_compressor = nullptr;
+    }
+    if (m_decompressor) {
+        libdeflate_free_decompressor(m_decompressor);
+        m_decompressor = nullptr;
+    }
+    m_input.clear();
+    m_output.clear();
+    m_outputSize = 0;
+}
+
+void LibdeflatePipe::deflate_cleanup() {
+    m_cleanup();
+}
+
+void LibdeflatePipe::inflate_cleanup() {
+    m_cleanup();
+}
@@ -0,0 +1,134 @@
+#include "line_scanner.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+LineScanner::LineScanner(const std::vector<RegexQuery>& queries,
+                         std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> regexes,
+                         const LiteralPrefilter* prefilter)
+    : queries_(queries), regexes_(std::move(regexes)), prefilter_(prefilter) {
+    if (!regexes_ || regexes_->size() != queries_.size()) {
+        throw std::runtime_error("Regexes do not match the queries");
+    }
+    for (const auto& query : queries_) {
+        max_column_ = std::max(max_column_, query.column_idx);
+    }
+    this->reset();
+}
+
+void LineScanner::reset(bool skip_header) {
+    carry_.clear();
+    pending_blocks_.clear();
+    next_block_ = 0;
+    skip_header_ = skip_header;
+    bytes_ = 0;
+    rows_ = 0;
+    matches_.assign(queries_.size(), 0);
+    passed_.assign(queries_.size(), 0);
+    field_bytes_.assign(queries_.size(), 0);
+}
+
+void LineScanner::consume(const char* data, size_t size) {
+    bytes_ += size;
+    const char* end = data + size;
+    const char* line = data;
+
+    // Complete the line cut by the previous chunk
+    if (!carry_.empty()) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (newline == nullptr) {
+            carry_.append(line, end);
+            return;
+        }
+        carry_.append(line, newline);
+        this->scanLine(carry_);
+        carry_.clear();
+        line = newline + 1;
+    }
+
+    while (line < end) {
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        if (newline == nullptr) {
+            carry_.assign(line, end);
+            return;
+        }
+        this->scanLine(std::string_view(line, newline - line));
+        line = newline + 1;
+    }
+}
+
+void LineScanner::finish() {
+    if (!carry_.empty()) {
+        this->scanLine(carry_);
+        carry_.clear();
+    }
+}
+
+void LineScanner::consumeBlock(size_t block_idx, const char* data, size_t size) {
+    if (block_idx != next_block_) {
+        pending_blocks_[block_idx] = {data, size};
+        return;
+    }
+    this->consume(data, size);
+    ++next_block_;
+    // Drain the blocks that were waiting for this one
+    for (auto it = pending_blocks_.begin(); it != pending_blocks_.end() && it->first == next_block_;
+         it = pending_blocks_.erase(it)) {
+        this->consume(it->second.first, it->second.second);
+        ++next_block_;
+    }
+}
+
+void LineScanner::finishBlocks() {
+    if (!pending_blocks_.empty()) {
+        std::cerr << "Line scanner: " << pending_blocks_.size() << " blocks after the missing block "
+                  << next_block_ << " were not scanned" << std::endl;
+        pending_blocks_.clear();
+    }
+    next_block_ = 0;
+    this->finish();
+}
+
+void LineScanner::scanLine(std::string_view line) {
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (skip_header_) {
+        skip_header_ = false;
+        return;
+    }
+    ++rows_;
+
+    // Naive comma split like loadCsvColumn: no trailing empty field, no quoting
+    fields_.clear();
+    size_t begin = 0;
+    while (fields_.size() <= static_cast<size_t>(max_column_)) {
+        size_t comma = line.find(',', begin);
+        if (comma == std::string_view::npos) {
+            if (begin < line.size()) {
+                fields_.push_back(line.substr(begin));
+            }
+            break;
+        }
+        fields_.push_back(line.substr(begin, comma - begin));
+        begin = comma + 1;
+    }
+
+    for (size_t idx = 0; idx < queries_.size(); ++idx) {
+        const auto& query = queries_[idx];
+        if (static_cast<size_t>(query.column_idx) >= fields_.size()) {
+            continue;
+        }
+        std::string_view field = fields_[query.column_idx];
+        field_bytes_[idx] += field.size();
+        if (prefilter_ != nullptr && !prefilter_->mayMatch(idx, field)) {
+            continue;
+        }
+        ++passed_[idx];
+        const auto& regex = *(*regexes_)[idx];
+        bool hit = query.full_match ? RE2::FullMatch(field, regex) : RE2::PartialMatch(field, regex);
+        matches_[idx] += hit;
+    }
+}
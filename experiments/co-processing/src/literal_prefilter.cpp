@@ -0,0 +1,206 @@
+#include "literal_prefilter.hpp"
+
+#include <stdexcept>
+
+#include "cpu_dispatch.hpp"
+
+#if defined(__SSE2__) || defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+static inline char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+}
+
+static inline bool equalsCaseless(const char* text, std::string_view needle) {
+    for (size_t idx = 0; idx < needle.size(); ++idx) {
+        if (asciiLower(text[idx]) != needle[idx]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+LiteralPrefilter::LiteralPrefilter(const std::vector<std::string>& patterns, int min_atom_len) {
+    // One filter per pattern, so each query can be checked on its own.
+    for (const auto& pattern : patterns) {
+        Query query;
+        query.filter = std::make_unique<re2::FilteredRE2>(min_atom_len);
+        int id = 0;
+        if (query.filter->Add(pattern, RE2::DefaultOptions, &id) != RE2::NoError) {
+            throw std::runtime_error("Failed to compile pattern: " + pattern);
+        }
+        query.filter->Compile(&query.atoms);
+
+        // A pattern without usable atoms passes even when nothing matched.
+        std::vector<int> potentials;
+        query.filter->AllPotentials({}, &potentials);
+        query.unfiltered = !potentials.empty() || query.atoms.empty();
+        queries_.push_back(std::move(query));
+    }
+}
+
+bool LiteralPrefilter::mayMatch(size_t pattern_idx, std::string_view line) const {
+    const auto& query = queries_[pattern_idx];
+    if (query.unfiltered) {
+        return true;
+    }
+
+    thread_local std::vector<int> matched;
+    thread_local std::vector<int> potentials;
+    matched.clear();
+    for (size_t atom_idx = 0; atom_idx < query.atoms.size(); ++atom_idx) {
+        if (findCaseless(line, query.atoms[atom_idx]) != std::string_view::npos) {
+            matched.push_back(static_cast<int>(atom_idx));
+        }
+    }
+
+    // Nothing found rejects, everything found passes any AND/OR tree.
+    if (matched.empty()) {
+        return false;
+    }
+    if (matched.size() == query.atoms.size()) {
+        return true;
+    }
+    query.filter->AllPotentials(matched, &potentials);
+    return !potentials.empty();
+}
+
+bool LiteralPrefilter::mayMatchAny(std::string_view line) const {
+    for (size_t idx = 0; idx < queries_.size(); ++idx) {
+        if (mayMatch(idx, line)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<std::string>& LiteralPrefilter::atoms(size_t pattern_idx) const {
+    return queries_[pattern_idx].atoms;
+}
+
+// SSE2 (any x86-64) or NEON (any aarch64) search, scalar elsewhere
+static size_t findCaselessBase(const char* text, size_t n, std::string_view needle) {
+    const size_t k = needle.size();
+    size_t pos = 0;
+
+    // Compare the first and last needle byte at 16 positions at once, OR-ing
+    // 0x20 folds ASCII case. Candidates are then verified byte by byte.
+#if defined(__SSE2__)
+    const __m128i fold = _mm_set1_epi8(0x20);
+    const __m128i first = _mm_set1_epi8(static_cast<char>(needle[0] | 0x20));
+    const __m128i last = _mm_set1_epi8(static_cast<char>(needle[k - 1] | 0x20));
+    for (; pos + k - 1 + 16 <= n; pos += 16) {
+        __m128i block_first = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos)), fold);
+        __m128i block_last = _mm_or_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos + k - 1)), fold);
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(block_first, first),
+                                                        _mm_cmpeq_epi8(block_last, last)));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (equalsCaseless(text + pos + bit, needle)) {
+                return pos + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+#elif defined(__ARM_NEON)
+    const uint8x16_t fold = vdupq_n_u8(0x20);
+    const uint8x16_t first = vdupq_n_u8(static_cast<uint8_t>(needle[0] | 0x20));
+    const uint8x16_t last = vdupq_n_u8(static_cast<uint8_t>(needle[k - 1] | 0x20));
+    for (; pos + k - 1 + 16 <= n; pos += 16) {
+        uint8x16_t block_first = vorrq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(text + pos)), fold);
+        uint8x16_t block_last = vorrq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(text + pos + k - 1)), fold);
+        uint8x16_t eq = vandq_u8(vceqq_u8(block_first, first), vceqq_u8(block_last, last));
+        // narrow to 4 bits per byte to get a scalar mask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(eq), 4)), 0);
+        while (mask) {
+            unsigned bit = __builtin_ctzll(mask) >> 2;
+            if (equalsCaseless(text + pos + bit, needle)) {
+                return pos + bit;
+            }
+            mask &= ~(0xFull << (bit * 4));
+        }
+    }
+#endif
+
+    // Scalar tail (or whole line without SIMD)
+    for (; pos + k <= n; ++pos) {
+        if (equalsCaseless(text + pos, needle)) {
+            return pos;
+        }
+    }
+    return std::string_view::npos;
+}
+
+#if defined(__x86_64__)
+// Same search 32 positions at a time, the rest goes to the base variant
+__attribute__((target("avx2")))
+static size_t findCaselessAvx2(const char* text, size_t n, std::string_view needle) {
+    const size_t k = needle.size();
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    const __m256i first = _mm256_set1_epi8(static_cast<char>(needle[0] | 0x20));
+    const __m256i last = _mm256_set1_epi8(static_cast<char>(needle[k - 1] | 0x20));
+    size_t pos = 0;
+    for (; pos + k - 1 + 32 <= n; pos += 32) {
+        __m256i block_first = _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos)), fold);
+        __m256i block_last =
+            _mm256_or_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos + k - 1)), fold);
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(block_first, first), _mm256_cmpeq_epi8(block_last, last))));
+        while (mask) {
+            unsigned bit = __builtin_ctz(mask);
+            if (equalsCaseless(text + pos + bit, needle)) {
+                return pos + bit;
+            }
+            mask &= mask - 1;
+        }
+    }
+    size_t found = findCaselessBase(text + pos, n - pos, needle);
+    return found == std::string_view::npos ? found : pos + found;
+}
+#endif
+
+using find_fn = size_t (*)(const char*, size_t, std::string_view);
+
+static find_fn pickFindCaseless() {
+#if defined(__x86_64__)
+    if (cpuFeatures().avx2) {
+        return findCaselessAvx2;
+    }
+#endif
+    return findCaselessBase;
+}
+
+static find_fn findCaselessKernel() {
+    static const find_fn kernel = pickFindCaseless();
+    return kernel;
+}
+
+const char* LiteralPrefilter::kernelName() {
+#if defined(__x86_64__)
+    if (findCaselessKernel() == findCaselessAvx2) {
+        return "avx2";
+    }
+#endif
+#if defined(__SSE2__)
+    return "sse2";
+#elif defined(__ARM_NEON)
+    return "neon";
+#else
+    return "scalar";
+#endif
+}
+
+size_t LiteralPrefilter::findCaseless(std::string_view haystack, std::string_view needle) {
+    const size_t n = haystack.size();
+    const size_t k = needle.size();
+    if (k == 0) {
+        return 0;
+    }
+    if (k > n) {
+        return std::string_view::npos;
+    }
+    return findCaselessKernel()(haystack.data(), n, needle);
+}
@@ -4,6 +4,7 @@
 #include "lz4.h"     // LZ4 one-shot API
 
 #include "lz4_pipe.hpp"
+#include "compressibility.hpp"
 
 static const size_t READ_CHUNK = 16384;
 
@@ -193,6 +194,14 @@ int LZ4Pipe::compress_init(const std::string &inputFile, const std::string &outp
 }
 
 int LZ4Pipe::compress_execute() {
+    // Random input: literals only, the bound of LZ4_compressBound covers them
+    const auto *original = reinterpret_cast<const uint8_t*>(m_originalData.data());
+    if (m_bypassIncompressible && CompressibilityEstimator{}.incompressible(original, m_originalData.size())) {
+        m_compressedSize = static_cast<int>(writeLz4Literals(original, m_originalData.size(),
+            reinterpret_cast<uint8_t*>(m_compressedData.data()), m_compressedData.size()));
+        return m_compressedSize > 0 ? 0 : -1;
+    }
+
     // LZ4_compress_default returns number of bytes in compressed data
     m_compressedSize = LZ4_compress_default(
         m_originalData.data(),        // source
@@ -0,0 +1,145 @@
+#include "lz4_regex_pipe.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include "lz4.h"
+
+#include "re2_pipe.hpp"
+
+// Constructor: initialize members.
+Lz4RegexPipe::Lz4RegexPipe(const std::string& input_location, RegexScanOptions options, size_t block_size)
+    : iters_(3), input_location_(input_location), options_(options), block_size_(block_size) {
+    if (block_size_ == 0 || block_size_ > static_cast<size_t>(LZ4_MAX_INPUT_SIZE)) {
+        throw std::runtime_error("Invalid LZ4 block size");
+    }
+}
+
+// init: Precompile regex patterns and compress the input into blocks.
+void Lz4RegexPipe::init() {
+    queries_ = options_.query_file.empty() ? defaultRegexQueries() : loadRegexQueries(options_.query_file);
+    for (const auto &query : queries_) {
+        patterns_.push_back(query.pattern);
+    }
+    regexes_ = options_.shared_re2 ? options_.shared_re2 : Re2Pipe::compile(patterns_, options_);
+    if (options_.prefilter) {
+        prefilter_ = std::make_unique<LiteralPrefilter>(patterns_);
+    }
+    scanner_ = std::make_unique<LineScanner>(queries_, regexes_, prefilter_.get());
+
+    std::ifstream data_file(input_location_, std::ios::binary);
+    if (!data_file.is_open()) {
+        throw std::runtime_error("Could not open data file");
+    }
+    std::vector<char> text((std::istreambuf_iterator<char>(data_file)), std::istreambuf_iterator<char>());
+    this->compressBlocks(text);
+
+    // Blocks hold whole rows, so the row share maps to a block range
+    const size_t num_blocks = block_sizes_.size();
+    first_block_ = std::min(num_blocks, static_cast<size_t>(options_.rows.begin * num_blocks));
+    last_block_ = options_.rows.end >= 1.0 ? num_blocks
+                                           : std::min(num_blocks, static_cast<size_t>(options_.rows.end * num_blocks));
+    last_block_ = std::max(first_block_, last_block_);
+    compressed_bytes_ = 0;
+    for (size_t block = first_block_; block < last_block_; ++block) {
+        compressed_bytes_ += block_offsets_[block + 1] - block_offsets_[block];
+    }
+    block_buffer_.resize(block_size_);
+
+    std::cerr << "LZ4 regex input: " << text.size() << " bytes in " << num_blocks << " blocks of "
+              << block_size_ << " bytes, " << compressed_.size() << " bytes compressed" << std::endl;
+}
+
+void Lz4RegexPipe::compressBlocks(const std::vector<char>& text) {
+    compressed_.clear();
+    block_offsets_.assign(1, 0);
+    block_sizes_.clear();
+    size_t begin = 0;
+    while (begin < text.size()) {
+        size_t end = std::min(text.size(), begin + block_size_);
+        // Cut after the last newline of the block, a longer line gets split
+        if (end < text.size()) {
+            const char* first = text.data() + begin;
+            const char* last = text.data() + end;
+            auto newline = std::find(std::make_reverse_iterator(last), std::make_reverse_iterator(first), '\n');
+            if (newline.base() != first) {
+                end = newline.base() - text.data();
+            }
+        }
+        const int src_size = static_cast<int>(end - begin);
+        const size_t offset = compressed_.size();
+        compressed_.resize(offset + LZ4_compressBound(src_size));
+        int written = LZ4_compress_default(text.data() + begin, compressed_.data() + offset, src_size,
+                                           LZ4_compressBound(src_size));
+        if (written <= 0) {
+            throw std::runtime_error("LZ4 compression failed");
+        }
+        compressed_.resize(offset + written);
+        block_offsets_.push_back(compressed_.size());
+        block_sizes_.push_back(end - begin);
+        begin = end;
+    }
+}
+
+// execute: Decompress each block into the reused buffer and scan it right away.
+void Lz4RegexPipe::execute() {
+    std::cerr << "LZ4 regex starting iters..." << std::endl;
+    avg_seconds_ = 0.0;
+    for (int iter = 0; iter < iters_; ++iter) {
+        scanner_->reset(first_block_ == 0);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t block = first_block_; block < last_block_; ++block) {
+            const int src_size = static_cast<int>(block_offsets_[block + 1] - block_offsets_[block]);
+            int size = LZ4_decompress_safe(compressed_.data() + block_offsets_[block], block_buffer_.data(),
+                                           src_size, static_cast<int>(block_buffer_.size()));
+            if (size < 0 || static_cast<size_t>(size) != block_sizes_[block]) {
+                throw std::runtime_error("LZ4 decompression failed in block " + std::to_string(block));
+            }
+            scanner_->consume(block_buffer_.data(), size);
+        }
+        scanner_->finish();
+        auto end = std::chrono::high_resolution_clock::now();
+        avg_seconds_ += std::chrono::duration<double>(end - start).count();
+    }
+    avg_seconds_ /= iters_;
+}
+
+void Lz4RegexPipe::scanDecompressedBlock(size_t block_idx, const char* data, size_t size) {
+    scanner_->consumeBlock(block_idx, data, size);
+}
+
+void Lz4RegexPipe::finishDecompressedBlocks() {
+    scanner_->finishBlocks();
+}
+
+// cleanup: Output the benchmark results.
+void Lz4RegexPipe::cleanup() {
+    results_.clear();
+    const size_t rows = scanner_->rows();
+    for (size_t idx = 0; idx < queries_.size(); ++idx) {
+        // bytes are the decompressed bytes, full (mib/s) is the end-to-end plaintext rate
+        RegexQueryResult result{queries_[idx].id, scanner_->bytes(), 1.0, avg_seconds_,
+                                scanner_->matches()[idx], 1.0, 0.0, 0, -1, -1};
+        if (rows) {
+            result.prefilter_pass = static_cast<double>(scanner_->prefilterPassed()[idx]) / rows;
+        }
+        results_.push_back(result);
+    }
+
+    std::string device = options_.device + "_lz4_re2";
+    device += options_.prefilter ? "_prefilter" : "";
+    printRegexReport(device, results_);
+
+    // Rows per second from compressed input, all queries in one pass
+    double seconds = avg_seconds_ > 0.0 ? avg_seconds_ : 1.0;
+    std::cout << "device (str),blocks (count),compressed (bytes),plaintext (bytes),rows (count),"
+              << "seconds (s),rows (rows/s),compressed (mib/s)" << std::endl;
+    std::cout << device << "," << last_block_ - first_block_ << "," << compressed_bytes_ << ","
+              << scanner_->bytes() << "," << rows << "," << avg_seconds_ << "," << rows / seconds << ","
+              << compressed_bytes_ / seconds / 1048576.0 << std::endl;
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+
+#include "offload_router.hpp"
+
+// Weight of the newest sample in the latency estimates
+static const double ROUTER_EWMA_WEIGHT = 0.25;
+
+static void ewma(double &estimate, double sample) {
+    estimate = estimate == 0.0 ? sample : estimate + ROUTER_EWMA_WEIGHT * (sample - estimate);
+}
+
+template <typename Traits>
+OffloadRouter<Traits>::OffloadRouter(DEVICE_TYPE dev_type, size_t input_capacity, size_t output_capacity,
+                                     uint32_t max_in_flight, size_t cpu_threads)
+    : hw_(dev_type, input_capacity, output_capacity, max_in_flight), cpu_(cpu_threads),
+      cpu_threads_(cpu_threads) {
+    this->hw_ready_ = this->hw_.ready();
+
+    // host workers take at most as many chunks as the device, a deeper host queue never wins
+    if (this->cpu_threads_ > 0) {
+        this->cpu_.setConf(cpuCompleted, cpuFailed, static_cast<uint32_t>(max_in_flight + this->cpu_threads_), this);
+        this->cpu_.start();
+    }
+
+    // without a device every chunk runs on the host, if the buffers are there
+    this->cpu_only_ = !this->hw_ready_ && this->cpu_threads_ > 0 &&
+                      this->input().data() != nullptr && this->output().data() != nullptr;
+    if (!this->hw_ready_) {
+        std::cerr << "OffloadRouter: no DOCA context, " << (this->cpu_only_ ? "all chunks on the host" : "no workers")
+                  << std::endl;
+    }
+}
+
+template <typename Traits>
+OffloadRouter<Traits>::~OffloadRouter() {
+    this->cleanup();
+}
+
+template <typename Traits>
+RouteTarget OffloadRouter<Traits>::choose(size_t bytes) const {
+    if (!this->hw_ready_) {
+        return RouteTarget::CPU;
+    }
+    if (this->cpu_threads_ == 0) {
+        return RouteTarget::HW;
+    }
+
+    // no estimate yet: fill the device slots, then the idle workers
+    if (this->hw_latency_ == 0.0 || this->cpu_service_ == 0.0) {
+        if (this->hw_depth_ < this->hw_.maxInFlight()) {
+            return RouteTarget::HW;
+        }
+        return this->cpu_depth_ < this->cpu_threads_ ? RouteTarget::CPU : RouteTarget::HW;
+    }
+
+    double hw_eta = std::max(this->hw_latency_ * bytes, (this->hw_queued_bytes_ + bytes) * this->hw_interval_);
+    double cpu_eta = (static_cast<double>(this->cpu_queued_bytes_) / this->cpu_threads_ + bytes) * this->cpu_service_;
+    return hw_eta <= cpu_eta ? RouteTarget::HW : RouteTarget::CPU;
+}
+
+template <typename Traits>
+bool OffloadRouter<Traits>::RouteAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    OffloadRouter *router = this->router_;
+    this->handle_ = handle;
+    this->submitted_ = std::chrono::steady_clock::now();
+    // plaintext bytes, the side of the chunk both codecs are linear in
+    this->bytes_ = Traits::codec == TaskCodec::DEFLATE ? this->src_.size() : this->dst_.size();
+    this->target_ = router->choose(this->bytes_);
+
+    if (this->target_ == RouteTarget::CPU) {
+        this->cpu_ = SwTask{Traits::codec, this->src_.data(), this->src_.size(), this->dst_.data(), this->dst_.size()};
+        this->cpu_.user_data = reinterpret_cast<uintptr_t>(this);
+        this->cpu_.checksums = true;
+        this->cpu_idle_ = router->cpu_depth_ < router->cpu_threads_;
+        ++router->cpu_depth_;
+        router->cpu_queued_bytes_ += this->bytes_;
+        ++router->routed_cpu_;
+        if (router->cpu_.submit(&this->cpu_)) {
+            return true;
+        }
+
+        // host queue full: the device takes it after all, if there is one
+        --router->cpu_depth_;
+        router->cpu_queued_bytes_ -= this->bytes_;
+        --router->routed_cpu_;
+        if (!router->hw_ready_) {
+            ++router->cpu_depth_;
+            router->cpu_queued_bytes_ += this->bytes_;
+            this->submit_error_ = DOCA_ERROR_AGAIN;
+            return false;
+        }
+        this->target_ = RouteTarget::HW;
+    }
+
+    ++router->hw_depth_;
+    router->hw_queued_bytes_ += this->bytes_;
+    ++router->routed_hw_;
+    this->hw_.emplace(router->hw_.compress(this->src_, this->dst_));
+    return this->hw_->await_suspend(handle);
+}
+
+template <typename Traits>
+RoutedResult OffloadRouter<Traits>::RouteAwaiter::await_resume() {
+    RoutedResult result{this->submit_error_, 0, this->target_, 0.0};
+    if (this->target_ == RouteTarget::HW) {
+        auto hw_result = this->hw_->await_resume();
+        result.status = hw_result.status;
+        result.size = hw_result.size;
+        result.crc = hw_result.crc;
+        result.second = hw_result.second;
+    } else if (this->submit_error_ == DOCA_SUCCESS) {
+        result.status = this->cpu_.failed ? DOCA_ERROR_INVALID_VALUE : DOCA_SUCCESS;
+        result.size = this->cpu_.dst_len;
+        result.crc = this->cpu_.crc_cs;
+        result.second = this->cpu_.second_cs;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(now - this->submitted_).count();
+    this->router_->finished(this, result.status == DOCA_SUCCESS);
+    return result;
+}
+
+template <typename Traits>
+void OffloadRouter<Traits>::finished(RouteAwaiter *awaiter, bool ok) {
+    auto now = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(now - awaiter->submitted_).count();
+    double bytes = static_cast<double>(std::max<size_t>(awaiter->bytes_, 1));
+
+    if (awaiter->target_ == RouteTarget::HW) {
+        --this->hw_depth_;
+        this->hw_queued_bytes_ -= awaiter->bytes_;
+        if (ok) {
+            ewma(this->hw_latency_, seconds / bytes);
+            // the gap between completions is the device rate only while it had work queued
+            if (this->hw_backlogged_) {
+                ewma(this->hw_interval_, std::chrono::duration<double>(now - this->hw_last_completion_).count() / bytes);
+            }
+            this->hw_last_completion_ = now;
+        }
+        this->hw_backlogged_ = this->hw_depth_ > 0;
+    } else {
+        --this->cpu_depth_;
+        this->cpu_queued_bytes_ -= awaiter->bytes_;
+        if (ok && awaiter->cpu_idle_) {
+            ewma(this->cpu_service_, seconds / bytes);
+        }
+    }
+
+    if (!ok) {
+        ++this->failed_;
+    }
+    this->latencies_.push_back(seconds);
+}
+
+template <typename Traits>
+void OffloadRouter<Traits>::cpuCompleted(SwTask *task, void *ctx_user_data) {
+    (void)ctx_user_data;
+    reinterpret_cast<RouteAwaiter*>(task->user_data)->handle_.resume();
+}
+
+template <typename Traits>
+void OffloadRouter<Traits>::cpuFailed(SwTask *task, void *ctx_user_data) {
+    // task->failed is set, await_resume reports it
+    cpuCompleted(task, ctx_user_data);
+}
+
+template <typename Traits>
+void OffloadRouter<Traits>::run() {
+    while (this->hw_.pending()) {
+        if (this->hw_depth_ == 0 && this->cpu_depth_ == 0) {
+            throw std::runtime_error("OffloadRouter: coroutines suspended on something else than a routed chunk");
+        }
+        if (this->hw_ready_) {
+            (void)this->hw_.progress();
+        }
+        (void)this->cpu_.progress();
+    }
+    // reap the frames, rethrow what a coroutine let escape
+    this->hw_.run();
+}
+
+template <typename Traits>
+void OffloadRouter<Traits>::cleanup() {
+    // host chunks still queued finish before the buffers go away
+    this->cpu_.stop();
+    this->hw_.cleanup();
+    this->hw_ready_ = false;
+    this->cpu_only_ = false;
+}
+
+template <typename Traits>
+double OffloadRouter<Traits>::latencyQuantile(double q) const {
+    if (this->latencies_.empty()) {
+        return 0.0;
+    }
+    std::vector<double> sorted(this->latencies_);
+    size_t rank = static_cast<size_t>(std::clamp(q, 0.0, 1.0) * (sorted.size() - 1) + 0.5);
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+template class OffloadRouter<CompressDeflateTraits>;
+template class OffloadRouter<DecompressDeflateTraits>;
+template class OffloadRouter<DecompressLz4Traits>;
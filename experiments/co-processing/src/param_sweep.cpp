@@ -0,0 +1,118 @@
+#include "param_sweep.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <nlohmann/json.hpp>
+
+template <typename T>
+static std::vector<T> parseList(const std::string &list) {
+    std::vector<T> values;
+    std::stringstream stream(list);
+    std::string token;
+    while (std::getline(stream, token, ',')) {
+        if (!token.empty()) {
+            values.push_back(static_cast<T>(std::stoull(token)));
+        }
+    }
+    return values;
+}
+
+bool SweepOptions::parseFlag(int argc, char **argv, int &idx) {
+    std::string flag = argv[idx];
+    if (flag == "--sweep-split" && idx + 1 < argc) {
+        splits = parseList<int>(argv[++idx]);
+    } else if (flag == "--sweep-buffer-size" && idx + 1 < argc) {
+        buffer_sizes = parseList<uint64_t>(argv[++idx]);
+    } else if (flag == "--sweep-buffers" && idx + 1 < argc) {
+        buffer_counts = parseList<uint64_t>(argv[++idx]);
+    } else if (flag == "--sweep-out" && idx + 1 < argc) {
+        output = argv[++idx];
+    } else {
+        return false;
+    }
+    enabled = true;
+    return true;
+}
+
+std::vector<SweepPoint> SweepOptions::points() const {
+    std::vector<int> split_list = splits;
+    if (split_list.empty()) {
+        for (int split = 0; split <= 100; split += 10) {
+            split_list.push_back(split);
+        }
+    }
+    std::vector<uint64_t> size_list = buffer_sizes.empty() ? std::vector<uint64_t>{0} : buffer_sizes;
+    std::vector<uint64_t> count_list = buffer_counts.empty() ? std::vector<uint64_t>{0} : buffer_counts;
+
+    std::vector<SweepPoint> result;
+    for (uint64_t buffer_size : size_list) {
+        for (uint64_t buffer_count : count_list) {
+            for (int split : split_list) {
+                result.push_back({split, buffer_size, buffer_count});
+            }
+        }
+    }
+    return result;
+}
+
+size_t shareBytes(size_t file_size, int percent) {
+    return file_size * static_cast<size_t>(percent) / 100;
+}
+
+void SweepTable::set(size_t row, const std::string &column, const std::string &value) {
+    auto &values = columns_[column];
+    values.resize(rows_);
+    if (row < rows_) {
+        values[row] = value;
+    }
+}
+
+void SweepTable::set(size_t row, const std::string &prefix, const std::vector<std::string> &keys,
+                     const std::vector<std::string> &values) {
+    for (size_t idx = 0; idx < std::min(keys.size(), values.size()); ++idx) {
+        set(row, prefix + keys[idx], values[idx]);
+    }
+}
+
+void SweepTable::merge(const SweepTable &other) {
+    for (const auto &[column, values] : other.columns_) {
+        columns_[column] = values;
+        columns_[column].resize(rows_);
+    }
+}
+
+bool SweepTable::write(const std::string &filename) const {
+    nlohmann::json columns = nlohmann::json::object();
+    for (const auto &[column, values] : columns_) {
+        nlohmann::json cells = nlohmann::json::array();
+        for (const auto &value : values) {
+            char *end = nullptr;
+            char *int_end = nullptr;
+            double number = std::strtod(value.c_str(), &end);
+            long long integer = std::strtoll(value.c_str(), &int_end, 10);
+            if (value.empty()) {
+                cells.push_back(nullptr);
+            } else if (*int_end == '\0') {
+                cells.push_back(integer);
+            } else if (*end == '\0') {
+                cells.push_back(number);
+            } else {
+                cells.push_back(value);
+            }
+        }
+        columns[column] = cells;
+    }
+    nlohmann::json j = {{"rows", rows_}, {"columns", columns}};
+
+    std::ofstream outFile(filename);
+    if (!outFile) {
+        std::cerr << "Error: cannot write " << filename << std::endl;
+        return false;
+    }
+    outFile << j.dump(4);
+    return true;
+}
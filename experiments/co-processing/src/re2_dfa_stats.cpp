@@ -0,0 +1,46 @@
+#include "re2_dfa_stats.hpp"
+
+#include <re2/re2.h>
+
+// Shared libre2 builds only export the RE2 API proper, the hook setters are
+// resolved weakly so the binary still links and runs without them.
+namespace re2 {
+namespace hooks {
+__attribute__((weak)) void SetDFASearchFailureHook(DFASearchFailureCallback* cb);
+__attribute__((weak)) void SetDFAStateCacheResetHook(DFAStateCacheResetCallback* cb);
+}  // namespace hooks
+}  // namespace re2
+
+// Hooks run on the matching thread, so per-thread counters need no locking
+static thread_local Re2DfaCounters thread_counters;
+
+static void onDfaSearchFailure(const re2::hooks::DFASearchFailure&) {
+    ++thread_counters.search_failures;
+}
+
+static void onDfaStateCacheReset(const re2::hooks::DFAStateCacheReset&) {
+    ++thread_counters.cache_resets;
+}
+
+static bool hooksAvailable() {
+    return &re2::hooks::SetDFASearchFailureHook != nullptr && &re2::hooks::SetDFAStateCacheResetHook != nullptr;
+}
+
+bool installRe2DfaHooks() {
+    static const bool installed = [] {
+        if (!hooksAvailable()) {
+            return false;
+        }
+        re2::hooks::SetDFASearchFailureHook(onDfaSearchFailure);
+        re2::hooks::SetDFAStateCacheResetHook(onDfaStateCacheReset);
+        return true;
+    }();
+    return installed;
+}
+
+Re2DfaCounters threadRe2DfaCounters() {
+    if (!hooksAvailable()) {
+        return {-1, -1};
+    }
+    return thread_counters;
+}
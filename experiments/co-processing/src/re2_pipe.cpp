@@ -1,84 +1,190 @@
 #include "re2_pipe.hpp"
 #include <re2/re2.h>
-#include <algorithm>
 #include <chrono>
-#include <fstream>
 #include <iostream>
-#include <sstream>
+
+#include "re2_dfa_stats.hpp"
 
 // Constructor: initialize members.
-Re2Pipe::Re2Pipe(const std::string& input_location)
-    : input_location_(input_location), iters_(3), total_size_bytes_(0) {
+Re2Pipe::Re2Pipe(const std::string& input_location, RegexScanOptions options)
+    : input_location_(input_location), iters_(3), options_(options) {
 }
 
-// init: Precompile regex patterns and load file data.
-void Re2Pipe::init() {
-    // Precompile regex patterns.
-    patterns_ = {"At (.+)Exit (.+)",
-                 "(.+) on (.+) at Exit (.+)",
-                 "on (.+) at (.+)",
-                 "Ramp to (.+)"};
-    for (const auto &pattern : patterns_) {
-        auto re_ptr = std::make_unique<RE2>(pattern);
+std::shared_ptr<const std::vector<std::unique_ptr<RE2>>> Re2Pipe::compile(const std::vector<std::string>& patterns,
+                                                                          const RegexScanOptions& options) {
+    RE2::Options re2_options;
+    if (options.re2_max_mem > 0) {
+        // DFA caches get about 2/3 of it, too little makes RE2 fall back to the NFA
+        re2_options.set_max_mem(options.re2_max_mem);
+    }
+    auto regexes = std::make_shared<std::vector<std::unique_ptr<RE2>>>();
+    for (const auto &pattern : patterns) {
+        auto re_ptr = std::make_unique<RE2>(pattern, re2_options);
         if (!re_ptr->ok()) {
             throw std::runtime_error("Failed to compile pattern: " + pattern);
         }
-        regexes_.push_back(std::move(re_ptr));
+        regexes->push_back(std::move(re_ptr));
     }
+    return regexes;
+}
 
-    // Load and prepare file data.
-    std::ifstream data_file(input_location_);
-    if (!data_file.is_open()) {
-        throw std::runtime_error("Could not open data file");
+// init: Precompile regex patterns and load file data.
+void Re2Pipe::init() {
+    // Precompile regex patterns (unless shared between workers).
+    queries_ = options_.query_file.empty() ? defaultRegexQueries() : loadRegexQueries(options_.query_file);
+    for (const auto &query : queries_) {
+        patterns_.push_back(query.pattern);
+    }
+    regexes_ = options_.shared_re2 ? options_.shared_re2 : compile(patterns_, options_);
+    if (regexes_->size() != patterns_.size()) {
+        throw std::runtime_error("Shared regexes do not match the queries");
+    }
+    if (!installRe2DfaHooks()) {
+        std::cerr << "RE2 DFA hooks not available, DFA fallbacks are not counted" << std::endl;
     }
-    std::string current_line;
-    while (std::getline(data_file, current_line)) {
-        // Remove carriage return characters.
-        current_line.erase(std::remove(current_line.begin(), current_line.end(), '\r'), current_line.end());
-        std::stringstream data_stream(current_line);
-        std::string token;
-        int comma_idx = 0;
-        while (std::getline(data_stream, token, ',')) {
-            if (comma_idx++ == 9) { // Extract the description column.
-                total_size_bytes_ += token.size();
-                lines_.push_back(token);
-                break;
+    if (options_.prefilter) {
+        prefilter_ = std::make_unique<LiteralPrefilter>(patterns_);
+    }
+
+    // Load and prepare file data (the columns of the queries).
+    columns_ = loadQueryColumns(input_location_, queries_, options_.dictionary_encode, query_columns_,
+                                options_.rows, options_.shared_columns.get());
+}
+
+size_t Re2Pipe::scanPattern(size_t pattern_idx, bool use_prefilter, size_t& passed) {
+    std::string dummy;
+    const auto &query = queries_[pattern_idx];
+    const auto &regex = *(*regexes_)[pattern_idx];
+    const auto &column = columns_[query_columns_[pattern_idx]];
+    // With the dictionary, evaluate once per distinct value and expand to rows.
+    const auto &rows = column.scanned();
+    const size_t num_groups = regex.NumberOfCapturingGroups();
+    const auto anchor = query.full_match ? RE2::ANCHOR_BOTH : RE2::UNANCHORED;
+
+    if (options_.extract) {
+        if (captures_.numGroups() != num_groups) {
+            captures_ = CaptureColumns(num_groups);
+        }
+        captures_.clear();
+        submatches_.resize(num_groups + 1);
+        groups_.resize(num_groups);
+        if (column.encoded) {
+            value_groups_.resize(rows.size() * num_groups);
+        }
+    }
+
+    value_hits_.resize(rows.size());
+    size_t matches = 0;
+    passed = 0;
+    for (size_t idx = 0; idx < rows.size(); ++idx) {
+        bool hit = false;
+        if (!use_prefilter || prefilter_->mayMatch(pattern_idx, rows[idx])) {
+            ++passed;
+            if (options_.extract) {
+                // Views into the line, copied into the columns batch-wise
+                hit = regex.Match(rows[idx], 0, rows[idx].size(), anchor, submatches_.data(),
+                                  static_cast<int>(submatches_.size()));
+                if (hit) {
+                    auto *groups = column.encoded ? &value_groups_[idx * num_groups] : groups_.data();
+                    for (size_t group = 0; group < num_groups; ++group) {
+                        groups[group] = std::string_view(submatches_[group + 1].data(), submatches_[group + 1].size());
+                    }
+                    if (!column.encoded) {
+                        captures_.append(groups);
+                    }
+                }
+            } else if (num_groups == 0) {
+                hit = query.full_match ? RE2::FullMatch(rows[idx], regex) : RE2::PartialMatch(rows[idx], regex);
+            } else {
+                hit = query.full_match ? RE2::FullMatch(rows[idx], regex, &dummy)
+                                       : RE2::PartialMatch(rows[idx], regex, &dummy);
+            }
+        }
+        value_hits_[idx] = hit;
+        matches += hit;
+    }
+    if (column.encoded) {
+        column.dict.expand(value_hits_, row_hits_);
+        matches = 0;
+        for (size_t row = 0; row < row_hits_.size(); ++row) {
+            matches += row_hits_[row];
+            // Every matching row gets the groups of its distinct value
+            if (options_.extract && row_hits_[row]) {
+                captures_.append(&value_groups_[column.dict.codes()[row] * num_groups]);
             }
         }
     }
-    data_file.close();
-    // Remove header line if present.
-    if (!lines_.empty()) {
-        lines_.erase(lines_.begin());
+    if (options_.extract) {
+        captures_.flush();
     }
+    return matches;
 }
 
 // execute: Benchmark regexes using full and partial match methods.
 void Re2Pipe::execute() {
-    std::string dummy;
     // Benchmark full match durations.
     std::cerr << "CPU regex starting iters..." << std::endl;
-    for (const auto &regex : regexes_) {
+    for (size_t pattern_idx = 0; pattern_idx < regexes_->size(); ++pattern_idx) {
         double avg_duration = 0.0;
+        size_t matches = 0;
+        size_t passed = 0;
+        Re2DfaCounters dfa_before = threadRe2DfaCounters();
         for (int iter = 0; iter < iters_; ++iter) {
             auto start = std::chrono::high_resolution_clock::now();
-            for (const auto &line : lines_) {
-                RE2::FullMatch(line, *regex, &dummy);
-            }
+            matches = this->scanPattern(pattern_idx, options_.prefilter, passed);
             auto end = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> duration = end - start;
             avg_duration += duration.count();
         }
         full_match_durations_.push_back(avg_duration / iters_);
+        match_counts_.push_back(matches);
+        prefilter_passed_.push_back(passed);
+        captured_bytes_.push_back(options_.extract ? captures_.bytes() : 0);
+
+        // DFA events of this query, summed over the iterations
+        Re2DfaCounters dfa_after = threadRe2DfaCounters();
+        bool counted = dfa_after.search_failures >= 0;
+        dfa_fallbacks_.push_back(counted ? dfa_after.search_failures - dfa_before.search_failures : -1);
+        dfa_resets_.push_back(counted ? dfa_after.cache_resets - dfa_before.cache_resets : -1);
     }
 }
 
 // cleanup: Output the benchmark results.
 void Re2Pipe::cleanup() {
-    std::cout << "query_id (string),device (str),full (mib/s)" << std::endl;
+    results_.clear();
     for (size_t idx = 0; idx < full_match_durations_.size(); ++idx) {
-        double full_tput = total_size_bytes_ / full_match_durations_[idx] / 1048576.0;
-        std::cout << "q" << (idx + 1) << "," << "cpu_re2" << ","
-                  << full_tput << std::endl;
+        const auto &column = columns_[query_columns_[idx]];
+        RegexQueryResult result{queries_[idx].id, column.size_bytes, column.dedupRatio(),
+                                full_match_durations_[idx], match_counts_[idx], 1.0, 0.0, captured_bytes_[idx],
+                                dfa_fallbacks_[idx], dfa_resets_[idx]};
+        size_t scanned = column.scanned().size();
+        if (scanned) {
+            result.prefilter_pass = static_cast<double>(prefilter_passed_[idx]) / scanned;
+        }
+
+        // Time saved by the prefilter: rerun the query once without it (outside
+        // the measured execution) and check that the matches are unchanged.
+        if (options_.prefilter) {
+            size_t passed = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t matches = this->scanPattern(idx, false, passed);
+            auto end = std::chrono::high_resolution_clock::now();
+            result.saved_seconds = std::chrono::duration<double>(end - start).count() - result.seconds;
+            if (matches != result.matches) {
+                std::cerr << "Prefilter changed the matches of q" << queries_[idx].id << ": "
+                          << result.matches << " vs " << matches << std::endl;
+            }
+        }
+        if (result.dfa_fallbacks > 0) {
+            std::cerr << "q" << queries_[idx].id << ": RE2 ran out of DFA memory " << result.dfa_fallbacks
+                      << " times and fell back to the NFA, raise --re2-max-mem" << std::endl;
+        }
+        results_.push_back(result);
     }
+
+    std::string device = options_.device + "_re2";
+    device += options_.dictionary_encode ? "_dict" : "";
+    device += options_.prefilter ? "_prefilter" : "";
+    device += options_.extract ? "_extract" : "";
+    printRegexReport(device, results_);
 }
@@ -0,0 +1,250 @@
+#include "regex_common.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+void printRegexReport(const std::string& device, const std::vector<RegexQueryResult>& results) {
+    // Workers report concurrently, keep each report in one piece
+    static std::mutex report_mutex;
+    std::lock_guard<std::mutex> lock(report_mutex);
+    std::cout << "query_id (string),device (str),full (mib/s),matches (rows),dedup_ratio (x),"
+              << "prefilter_pass (frac),prefilter_saved (s),captured (bytes),"
+              << "dfa_fallbacks (count),dfa_resets (count)" << std::endl;
+    for (const auto& result : results) {
+        double full_tput = result.bytes / result.seconds / 1048576.0;
+        std::cout << "q" << result.query_id << "," << device << ","
+                  << full_tput << "," << result.matches << "," << result.dedup_ratio << ","
+                  << result.prefilter_pass << "," << result.saved_seconds << ","
+                  << result.captured_bytes << "," << result.dfa_fallbacks << "," << result.dfa_resets << std::endl;
+    }
+}
+
+std::vector<RegexQueryResult> mergeRegexResults(const std::vector<std::vector<RegexQueryResult>>& per_worker) {
+    std::vector<RegexQueryResult> merged;
+    for (const auto& results : per_worker) {
+        if (merged.empty()) {
+            merged = results;
+            continue;
+        }
+        if (results.size() != merged.size()) {
+            throw std::runtime_error("Workers ran different queries");
+        }
+        for (size_t idx = 0; idx < results.size(); ++idx) {
+            auto& total = merged[idx];
+            const auto& part = results[idx];
+            // ratios are weighted by the bytes each worker scanned
+            size_t bytes = total.bytes + part.bytes;
+            if (bytes) {
+                total.dedup_ratio = (total.dedup_ratio * total.bytes + part.dedup_ratio * part.bytes) / bytes;
+                total.prefilter_pass = (total.prefilter_pass * total.bytes + part.prefilter_pass * part.bytes) / bytes;
+            }
+            total.bytes = bytes;
+            total.seconds = std::max(total.seconds, part.seconds);
+            total.saved_seconds = std::max(total.saved_seconds, part.saved_seconds);
+            total.matches += part.matches;
+            total.captured_bytes += part.captured_bytes;
+            // -1 (unknown) on any worker stays unknown
+            total.dfa_fallbacks = total.dfa_fallbacks < 0 || part.dfa_fallbacks < 0 ? -1 : total.dfa_fallbacks + part.dfa_fallbacks;
+            total.dfa_resets = total.dfa_resets < 0 || part.dfa_resets < 0 ? -1 : total.dfa_resets + part.dfa_resets;
+        }
+    }
+    return merged;
+}
+
+std::vector<RegexQuery> defaultRegexQueries() {
+    return {{"1", "At (.+)Exit (.+)"},
+            {"2", "(.+) on (.+) at Exit (.+)"},
+            {"3", "on (.+) at (.+)"},
+            {"4", "Ramp to (.+)"}};
+}
+
+static std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t\r");
+    return value.substr(begin, end - begin + 1);
+}
+
+std::vector<RegexQuery> loadRegexQueries(const std::string& query_file) {
+    std::ifstream in(query_file);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open query file: " + query_file);
+    }
+    std::vector<RegexQuery> queries;
+    std::string line;
+    while (std::getline(in, line)) {
+        line.erase(std::remove(line.begin(), line.end(), '\r'), line.end());
+        if (trim(line).empty() || trim(line)[0] == '#') {
+            continue;
+        }
+        size_t sep = line.find(", ");
+        if (sep == std::string::npos) {
+            throw std::runtime_error("Malformed query line: " + line);
+        }
+        RegexQuery query;
+        query.id = trim(line.substr(0, sep));
+        query.pattern = line.substr(sep + 2);
+
+        // Optional trailing ", <column>, full|partial"
+        size_t mode_sep = query.pattern.rfind(", ");
+        if (mode_sep != std::string::npos) {
+            std::string mode = trim(query.pattern.substr(mode_sep + 2));
+            size_t column_sep = query.pattern.rfind(", ", mode_sep == 0 ? 0 : mode_sep - 1);
+            if ((mode == "full" || mode == "partial") && column_sep != std::string::npos && column_sep < mode_sep) {
+                std::string column = trim(query.pattern.substr(column_sep + 2, mode_sep - column_sep - 2));
+                if (!column.empty() && std::all_of(column.begin(), column.end(), ::isdigit)) {
+                    query.column_idx = std::stoi(column);
+                    query.full_match = mode == "full";
+                    query.pattern.resize(column_sep);
+                }
+            }
+        }
+        queries.push_back(std::move(query));
+    }
+    if (queries.empty()) {
+        throw std::runtime_error("No queries in " + query_file);
+    }
+    return queries;
+}
+
+size_t loadCsvColumn(const std::string& file_location, int column_idx, std::vector<std::string>& lines) {
+    std::ifstream data_file(file_location);
+    if (!data_file.is_open()) {
+        throw std::runtime_error("Could not open data file");
+    }
+    size_t total_size_bytes = 0;
+    std::string current_line;
+    while (std::getline(data_file, current_line)) {
+        // Remove carriage return characters.
+        current_line.erase(std::remove(current_line.begin(), current_line.end(), '\r'), current_line.end());
+        std::stringstream data_stream(current_line);
+        std::string token;
+        int comma_idx = 0;
+        while (std::getline(data_stream, token, ',')) {
+            if (comma_idx++ == column_idx) {
+                total_size_bytes += token.size();
+                lines.push_back(token);
+                break;
+            }
+        }
+    }
+    data_file.close();
+    // Remove header line if present.
+    if (!lines.empty()) {
+        total_size_bytes -= lines.front().size();
+        lines.erase(lines.begin());
+    }
+    return total_size_bytes;
+}
+
+std::vector<CsvColumn> loadCsvColumns(const std::string& file_location, const std::vector<RegexQuery>& queries) {
+    std::vector<CsvColumn> columns;
+    int last_idx = -1;
+    for (const auto& query : queries) {
+        if (std::none_of(columns.begin(), columns.end(),
+                         [&](const CsvColumn& column) { return column.column_idx == query.column_idx; })) {
+            columns.push_back(CsvColumn{query.column_idx, 0, {}});
+            last_idx = std::max(last_idx, query.column_idx);
+        }
+    }
+
+    std::ifstream data_file(file_location);
+    if (!data_file.is_open()) {
+        throw std::runtime_error("Could not open data file");
+    }
+    std::vector<std::string> tokens;
+    std::string current_line;
+    while (std::getline(data_file, current_line)) {
+        // Remove carriage return characters.
+        current_line.erase(std::remove(current_line.begin(), current_line.end(), '\r'), current_line.end());
+        std::stringstream data_stream(current_line);
+        std::string token;
+        tokens.clear();
+        while (static_cast<int>(tokens.size()) <= last_idx && std::getline(data_stream, token, ',')) {
+            tokens.push_back(std::move(token));
+        }
+        // a row without the column is skipped for that column only, as in loadCsvColumn
+        for (auto& column : columns) {
+            if (column.column_idx < static_cast<int>(tokens.size())) {
+                column.size_bytes += tokens[column.column_idx].size();
+                column.lines.push_back(tokens[column.column_idx]);
+            }
+        }
+    }
+    data_file.close();
+    // Remove header line if present.
+    for (auto& column : columns) {
+        if (!column.lines.empty()) {
+            column.size_bytes -= column.lines.front().size();
+            column.lines.erase(column.lines.begin());
+        }
+    }
+    return columns;
+}
+
+std::vector<RegexColumn> loadQueryColumns(const std::string& file_location, const std::vector<RegexQuery>& queries,
+                                          bool dictionary_encode, std::vector<size_t>& query_columns,
+                                          RowShare share, const std::vector<CsvColumn>* parsed) {
+    std::vector<RegexColumn> columns;
+    query_columns.clear();
+    for (const auto& query : queries) {
+        auto it = std::find_if(columns.begin(), columns.end(),
+                               [&](const RegexColumn& column) { return column.column_idx == query.column_idx; });
+        if (it != columns.end()) {
+            query_columns.push_back(it - columns.begin());
+            continue;
+        }
+        RegexColumn column;
+        column.column_idx = query.column_idx;
+        const CsvColumn* source = nullptr;
+        if (parsed) {
+            auto found = std::find_if(parsed->begin(), parsed->end(),
+                                      [&](const CsvColumn& csv) { return csv.column_idx == query.column_idx; });
+            source = found != parsed->end() ? &*found : nullptr;
+        }
+        const bool whole = share.begin <= 0.0 && share.end >= 1.0;
+        if (!source) {
+            column.size_bytes = loadCsvColumn(file_location, query.column_idx, column.lines);
+        } else if (whole) {
+            column.lines = source->lines;
+            column.size_bytes = source->size_bytes;
+        }
+
+        // Keep only this worker's rows
+        if (!whole) {
+            const std::vector<std::string>& all = source ? source->lines : column.lines;
+            const size_t num_lines = all.size();
+            size_t begin = std::min(num_lines, static_cast<size_t>(share.begin * num_lines));
+            size_t end = share.end >= 1.0 ? num_lines : std::min(num_lines, static_cast<size_t>(share.end * num_lines));
+            end = std::max(begin, end);
+            if (source) {
+                column.lines.assign(all.begin() + begin, all.begin() + end);
+            } else {
+                column.lines.erase(column.lines.begin() + end, column.lines.end());
+                column.lines.erase(column.lines.begin(), column.lines.begin() + begin);
+            }
+            column.size_bytes = 0;
+            for (const auto& line : column.lines) {
+                column.size_bytes += line.size();
+            }
+        }
+
+        // Replace the lines by a distinct-value table plus per-row codes.
+        if (dictionary_encode) {
+            column.dict = DictColumn::encode(column.lines);
+            column.encoded = true;
+            std::cerr << "CPU regex dictionary (column " << column.column_idx << "): " << column.dict.numRows()
+                      << " rows, " << column.dict.numValues() << " distinct (" << column.dict.dedupRatio() << "x)"
+                      << std::endl;
+        }
+        query_columns.push_back(columns.size());
+        columns.push_back(std::move(column));
+    }
+    return columns;
+}
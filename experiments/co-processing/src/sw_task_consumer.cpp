@@ -0,0 +1,275 @@
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "engine.hpp"
+#include "sw_task_consumer.hpp"
+
+template <typename Task>
+SwTaskConsumer<Task>::SwTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, bool init,
+                                     SwExecutorConfig config)
+    requires (Task::split_input)
+    : Buffers(dev_type, asked_buffer_size), config_(config) {
+    if (init) {
+        this->initDocaContext();
+    }
+}
+
+template <typename Task>
+SwTaskConsumer<Task>::SwTaskConsumer(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, uint64_t asked_num_buffers,
+                                     size_t original_file_size, bool init, SwExecutorConfig config)
+    requires (!Task::split_input)
+    : Buffers(dev_type, asked_buffer_size, asked_num_buffers, original_file_size), config_(config) {
+    if (init && this->valid_size) {
+        this->initDocaContext();
+    }
+}
+
+template <typename Task>
+SwTaskConsumer<Task>::~SwTaskConsumer() {
+    this->releaseResources();
+}
+
+template <typename Task>
+std::string SwTaskConsumer<Task>::getName() {
+    return Task::sw_name;
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::initDocaContext() {
+    this->initialized = true;
+    this->init_timings_.start();
+
+    // 1. read file and file size
+    if (!this->readFile()) {
+        std::cerr << "SW 1. error" << std::endl;
+        return;
+    }
+    this->init_timings_.mark(InitStage::READ_FILE);
+
+    // 2. determine final buffer size and prepare regions
+    if (!this->prepareBuffersAndRegions()) {
+        std::cerr << "SW 2. error" << std::endl;
+        return;
+    }
+    this->init_timings_.mark(InitStage::BUFFERS);
+
+    // 3. one task per buffer, laid out as the DOCA tasks
+    this->layoutTasks();
+    this->init_timings_.mark(InitStage::TASKS);
+
+    // 4. start the pool
+    this->executor_ = std::make_unique<SwTaskExecutor>(this->config_.threads, this->config_.model);
+    this->executor_->setConf(completedCallback, errorCallback, this->num_buffers, this);
+    this->executor_->start();
+    this->init_timings_.mark(InitStage::CONTEXT);
+    std::cout << "SW executor: " << this->num_buffers << " tasks on " << this->config_.threads << " threads" << std::endl;
+
+    this->ready_ = true;
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::layoutTasks() {
+    this->tasks_.clear();
+    for (uint32_t task_id = 0; task_id < this->num_buffers; ++task_id) {
+        SwTask task{Task::codec,
+                    this->indata + this->input_buff_size * task_id, this->input_buff_size,
+                    this->outdata + this->output_buffer_size * task_id, this->output_buffer_size};
+        task.user_data = task_id;
+        this->tasks_.push_back(task);
+    }
+}
+
+template <typename Task>
+bool SwTaskConsumer<Task>::reshape(size_t bytes, uint64_t buffer_size, uint64_t max_buffers)
+    requires (Task::split_input) {
+    if (!this->ready_ || !this->layoutPrefix(bytes, buffer_size, max_buffers)) {
+        return false;
+    }
+    this->layoutTasks();
+    this->executor_->setConf(completedCallback, errorCallback, this->num_buffers, this);
+    return true;
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::executeDocaTask() {
+    if (!this->ready_) {
+        std::cout << "SW executor not ready, nothing to do" << std::endl;
+        return;
+    }
+    this->init_timings_.running();
+    this->completed_ = 0;
+
+    // blocks redone on the host land in the regions like the others
+    this->retrier_.reset(this->num_buffers);
+    this->checksums_.reset(this->num_buffers, checksumKind(Task::codec));
+    this->retrier_.setDoneHandler([this](size_t task_id, const uint8_t *data, size_t len) {
+        if (this->checksums_.enabled()) {
+            if (Task::codec == TaskCodec::DEFLATE) {
+                this->checksums_.record(task_id, this->tasks_[task_id].src, this->tasks_[task_id].src_len);
+            } else {
+                this->checksums_.record(task_id, data, len);
+            }
+        }
+        this->region_buffer[task_id].base = const_cast<uint8_t*>(data);
+        this->region_buffer[task_id].size = static_cast<uint32_t>(len);
+        if (this->block_handler_) {
+            this->block_handler_(task_id, data, len);
+        }
+        this->last_callback = std::chrono::steady_clock::now();
+    });
+
+    // submit array of tasks
+    this->submit_start = std::chrono::steady_clock::now();
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    this->thread_time_start = ts.tv_sec + ts.tv_nsec * 1e-9;
+
+    size_t submitted = 0;
+    size_t task_id = 0;
+    std::vector<size_t> stored;
+    for (; task_id < this->tasks_.size(); ++task_id) {
+        SwTask &task = this->tasks_[task_id];
+        task.checksums = this->checksums_.enabled();
+        // chunks not worth compressing stay off the executor, as in DocaTaskConsumer
+        if (Task::codec == TaskCodec::DEFLATE && this->estimator_.incompressible(task.src, task.src_len)) {
+            stored.push_back(task_id);
+            continue;
+        }
+        if (!this->executor_->submit(&task)) {
+            std::cout << "SW task submission with errors" << std::endl;
+            break;
+        }
+        this->init_timings_.submitted();
+        ++submitted;
+    }
+    for (; task_id < this->tasks_.size(); ++task_id) {
+        const SwTask &task = this->tasks_[task_id];
+        this->retrier_.retry(task_id, task.src, task.src_len, task.dst_cap, false);
+    }
+    for (size_t stored_id : stored) {
+        this->retrier_.store(stored_id, this->tasks_[stored_id].src, this->tasks_[stored_id].src_len);
+    }
+
+    this->submit_end = std::chrono::steady_clock::now();
+
+    // tick and wait for completion, and for the retries
+    while (this->completed_ < submitted || !this->retrier_.idle()) {
+        (void)this->executor_->progress();
+        this->retrier_.progress();
+    }
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    this->thread_time_end = ts.tv_sec + ts.tv_nsec * 1e-9;
+    this->busy_wait_end = std::chrono::steady_clock::now();
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::completedCallback(SwTask *task, void *ctx_user_data) {
+    auto *consumer = static_cast<SwTaskConsumer*>(ctx_user_data);
+    size_t task_id = task->user_data;
+
+    consumer->retrier_.offloaded(task_id);
+    if (consumer->checksums_.enabled()) {
+        const uint8_t *plain = Task::codec == TaskCodec::DEFLATE ? task->src : task->dst;
+        size_t plain_len = Task::codec == TaskCodec::DEFLATE ? task->src_len : task->dst_len;
+        if (!consumer->checksums_.verify(task_id, {task->crc_cs, task->second_cs}, plain, plain_len)) {
+            std::cerr << "Checksum mismatch in block " << task_id << std::endl;
+        }
+    }
+    consumer->region_buffer[task_id].base = task->dst;
+    consumer->region_buffer[task_id].size = static_cast<uint32_t>(task->dst_len);
+    if (consumer->block_handler_) {
+        consumer->block_handler_(task_id, task->dst, task->dst_len);
+    }
+
+    ++consumer->completed_;
+    consumer->last_callback = std::chrono::steady_clock::now();
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::errorCallback(SwTask *task, void *ctx_user_data) {
+    /* A task is completed even if it is completed with error, as in DocaTaskConsumer */
+    auto *consumer = static_cast<SwTaskConsumer*>(ctx_user_data);
+    ++consumer->completed_;
+
+    // requeue it with a buffer the output fits in
+    consumer->retrier_.retry(task->user_data, task->src, task->src_len, task->dst_cap, false);
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::releaseResources() {
+    if (this->released) {
+        return;
+    }
+    this->released = true;
+
+    // host retries write to the regions, finish them first
+    this->retrier_.stop();
+
+    this->ctx_stop_start = std::chrono::steady_clock::now();
+    if (this->executor_) {
+        this->executor_->stop();
+    }
+    this->ctx_stop_end = std::chrono::steady_clock::now();
+
+    this->releaseBuffers();
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::setBlockHandler(sw_block_handler handler) {
+    this->block_handler_ = std::move(handler);
+}
+
+template <typename Task>
+double SwTaskConsumer<Task>::workerCpuSeconds() const {
+    return (this->executor_ ? this->executor_->workerCpuSeconds() : 0.0) + this->retrier_.workerCpuSeconds();
+}
+
+template <typename Task>
+std::vector<std::string> SwTaskConsumer<Task>::getDocaResults() {
+    // stop the pool, unless another run follows
+    if (!this->keep_alive_) {
+        this->releaseResources();
+    }
+
+    auto ctx_stop_elapsed = this->calculateSeconds(this->ctx_stop_end, this->ctx_stop_start);
+    auto overall_submission_elapsed = this->calculateSeconds(this->busy_wait_end, this->submit_start);
+    auto task_submission_elapsed = this->calculateSeconds(this->submit_end, this->submit_start);
+    auto busy_wait_elapsed = this->calculateSeconds(this->busy_wait_end, this->submit_end);
+    auto cb_elapsed = this->calculateSeconds(this->last_callback, this->submit_start);
+    auto cb_end_elapsed = this->calculateSeconds(this->busy_wait_end, this->last_callback);
+
+    // cpu+sys time of the polling thread, as for the DPU
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8) << this->thread_time_end - this->thread_time_start;
+
+    return std::vector<std::string>{overall_submission_elapsed, task_submission_elapsed,
+        busy_wait_elapsed, cb_elapsed, cb_end_elapsed, ctx_stop_elapsed, oss.str()};
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::init() {
+    if (!this->initialized) {
+        this->initDocaContext();
+    }
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::execute() {
+    this->executeDocaTask();
+}
+
+template <typename Task>
+void SwTaskConsumer<Task>::cleanup() {
+    this->releaseResources();
+}
+
+template class SwTaskConsumer<CompressDeflateTask>;
+template class SwTaskConsumer<DecompressDeflateTask>;
+template class SwTaskConsumer<DecompressLz4Task>;
+
+static_assert(NamedEngine<SwCompressConsumer>);
+static_assert(NamedEngine<SwDecompressDeflateConsumer>);
+static_assert(NamedEngine<SwDecompressLz4Consumer>);
@@ -0,0 +1,197 @@
+#include "sw_task_executor.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <limits>
+
+#include "checksum.hpp"
+#include "lz4.h"
+#include "zlib.h"
+
+// zlib level closest to the hardware deflate, see local-compress/compressor-sw.py
+static const int SW_DEFLATE_LEVEL = 3;
+
+double SwLatencyModel::serviceSeconds(size_t plaintext_bytes) const {
+    double seconds = task_latency_us * 1e-6;
+    if (mib_per_s > 0.0) {
+        seconds += plaintext_bytes / (mib_per_s * 1048576.0);
+    }
+    return seconds;
+}
+
+static uint64_t threadCpuNanos() {
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+SwTaskExecutor::SwTaskExecutor(size_t num_threads, SwLatencyModel model)
+    : num_threads_(num_threads == 0 ? 1 : num_threads), model_(model) {}
+
+SwTaskExecutor::~SwTaskExecutor() {
+    this->stop();
+}
+
+void SwTaskExecutor::setConf(sw_task_callback completed, sw_task_callback failed, uint32_t num_tasks,
+                             void *ctx_user_data) {
+    this->completed_cb_ = completed;
+    this->failed_cb_ = failed;
+    this->max_tasks_ = num_tasks;
+    this->ctx_user_data_ = ctx_user_data;
+}
+
+void SwTaskExecutor::start() {
+    if (this->running_) {
+        return;
+    }
+    this->stopping_ = false;
+    this->running_ = true;
+    for (size_t idx = 0; idx < this->num_threads_; ++idx) {
+        this->workers_.emplace_back(&SwTaskExecutor::workerLoop, this);
+    }
+}
+
+bool SwTaskExecutor::submit(SwTask *task) {
+    if (!this->running_ || this->inflight_ >= this->max_tasks_) {
+        return false;
+    }
+    ++this->inflight_;
+    {
+        std::lock_guard<std::mutex> lock(this->submit_mutex_);
+        this->submitted_.push_back(task);
+    }
+    this->submit_cond_.notify_one();
+    return true;
+}
+
+uint8_t SwTaskExecutor::progress() {
+    SwTask *task = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(this->done_mutex_);
+        if (this->done_.empty()) {
+            return 0;
+        }
+        task = this->done_.front();
+        this->done_.pop_front();
+    }
+    --this->inflight_;
+
+    sw_task_callback callback = task->failed ? this->failed_cb_ : this->completed_cb_;
+    if (callback) {
+        callback(task, this->ctx_user_data_);
+    }
+    return 1;
+}
+
+void SwTaskExecutor::stop() {
+    if (!this->running_) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->submit_mutex_);
+        this->stopping_ = true;
+    }
+    this->submit_cond_.notify_all();
+    // workers finish every submitted task before they exit
+    for (auto &worker : this->workers_) {
+        worker.join();
+    }
+    this->workers_.clear();
+    this->running_ = false;
+
+    // flush the callbacks of the tasks still in flight
+    while (this->progress()) {
+    }
+}
+
+double SwTaskExecutor::workerCpuSeconds() const {
+    return this->worker_cpu_ns_.load() * 1e-9;
+}
+
+void SwTaskExecutor::workerLoop() {
+    uint64_t cpu_start = threadCpuNanos();
+    while (true) {
+        SwTask *task = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(this->submit_mutex_);
+            this->submit_cond_.wait(lock, [this] { return this->stopping_ || !this->submitted_.empty(); });
+            if (this->submitted_.empty()) {
+                break;
+            }
+            task = this->submitted_.front();
+            this->submitted_.pop_front();
+        }
+
+        // the engine is busy for at least the modeled service time
+        auto start = std::chrono::steady_clock::now();
+        task->failed = !runCodec(*task);
+        if (task->checksums && !task->failed) {
+            const uint8_t *plain = task->codec == TaskCodec::DEFLATE ? task->src : task->dst;
+            ChunkChecksum sums = chunkChecksum(checksumKind(task->codec), plain,
+                                               task->codec == TaskCodec::DEFLATE ? task->src_len : task->dst_len);
+            task->crc_cs = sums.crc;
+            task->second_cs = sums.second;
+        }
+        size_t plaintext = task->codec == TaskCodec::DEFLATE ? task->src_len : task->dst_len;
+        auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(this->model_.serviceSeconds(plaintext)));
+        std::this_thread::sleep_until(due);
+
+        std::lock_guard<std::mutex> lock(this->done_mutex_);
+        this->done_.push_back(task);
+    }
+    this->worker_cpu_ns_ += threadCpuNanos() - cpu_start;
+}
+
+bool SwTaskExecutor::runCodec(SwTask &task) {
+    task.dst_len = 0;
+    switch (task.codec) {
+        case TaskCodec::DEFLATE:
+        case TaskCodec::INFLATE: {
+            if (task.src_len > std::numeric_limits<uInt>::max() || task.dst_cap > std::numeric_limits<uInt>::max()) {
+                return false;
+            }
+            // raw deflate streams without zlib header, as the hardware reads and writes them
+            z_stream stream{};
+            const bool deflating = task.codec == TaskCodec::DEFLATE;
+            int ret = deflating
+                ? deflateInit2(&stream, SW_DEFLATE_LEVEL, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY)
+                : inflateInit2(&stream, -MAX_WBITS);
+            if (ret != Z_OK) {
+                return false;
+            }
+            stream.next_in = const_cast<Bytef*>(task.src);
+            stream.avail_in = static_cast<uInt>(task.src_len);
+            stream.next_out = task.dst;
+            stream.avail_out = static_cast<uInt>(task.dst_cap);
+            ret = deflating ? deflate(&stream, Z_FINISH) : inflate(&stream, Z_FINISH);
+            task.dst_len = task.dst_cap - stream.avail_out;
+            deflating ? deflateEnd(&stream) : inflateEnd(&stream);
+            // inflate may leave a trailing checksum of the input unread
+            return ret == Z_STREAM_END;
+        }
+        case TaskCodec::LZ4_BLOCK_DECOMPRESS: {
+            if (task.src_len > static_cast<size_t>(LZ4_MAX_INPUT_SIZE) ||
+                task.dst_cap > static_cast<size_t>(std::numeric_limits<int>::max())) {
+                return false;
+            }
+            int size = LZ4_decompress_safe(reinterpret_cast<const char*>(task.src), reinterpret_cast<char*>(task.dst),
+                                           static_cast<int>(task.src_len), static_cast<int>(task.dst_cap));
+            if (size < 0) {
+                return false;
+            }
+            task.dst_len = static_cast<size_t>(size);
+            return true;
+        }
+    }
+    return false;
+}
+
+size_t SwTaskExecutor::outputBound(TaskCodec codec, size_t src_len, size_t dst_cap) {
+    if (codec == TaskCodec::DEFLATE) {
+        // zlib bound covers the raw stream, its header and trailer are not written
+        return std::max<size_t>(dst_cap, compressBound(static_cast<uLong>(src_len)));
+    }
+    return dst_cap;
+}
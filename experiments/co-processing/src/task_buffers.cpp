@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include "task_buffers.hpp"
+
+PrefixLayout prefixLayout(size_t bytes, uint64_t buffer_size, uint64_t max_buffers, uint64_t max_buf_size) {
+    PrefixLayout layout;
+    if (bytes == 0) {
+        return layout;
+    }
+    layout.buffer_size = (buffer_size == 0 || buffer_size > max_buf_size) ? max_buf_size : buffer_size;
+    if (bytes <= layout.buffer_size) {
+        layout.tasks = 1;
+        layout.buffer_size = bytes;
+    } else {
+        layout.tasks = static_cast<uint32_t>(bytes / layout.buffer_size);
+    }
+    if (max_buffers > 0) {
+        layout.tasks = static_cast<uint32_t>(std::min<uint64_t>(layout.tasks, max_buffers));
+    }
+    return layout;
+}
+
+template <typename Task>
+TaskBuffers<Task>::TaskBuffers(DEVICE_TYPE dev_type) {
+    this->setDeviceLimits(dev_type);
+}
+
+template <typename Task>
+TaskBuffers<Task>::TaskBuffers(DEVICE_TYPE dev_type, uint64_t asked_buffer_size)
+    requires (Task::split_input) {
+    this->setDeviceLimits(dev_type);
+
+    // output buffers mirror the input buffers
+    this->input_buff_size = this->max_buf_size;
+    if (asked_buffer_size < this->max_buf_size && asked_buffer_size > 0) {
+        this->input_buff_size = asked_buffer_size;
+    }
+    this->output_buffer_size = this->input_buff_size;
+}
+
+template <typename Task>
+TaskBuffers<Task>::TaskBuffers(DEVICE_TYPE dev_type, uint64_t asked_buffer_size, uint64_t asked_num_buffers,
+                               size_t original_file_size)
+    requires (!Task::split_input) {
+    this->setDeviceLimits(dev_type);
+    this->output_buffer_size = this->max_buf_size;
+
+    this->input_buff_size = asked_buffer_size;
+    if (this->input_buff_size > this->max_buf_size) {
+        std::cerr << "BUFFER_SIZE too large, system max: " << this->max_buf_size << std::endl;
+        this->valid_size = false;
+        return;
+    }
+
+    this->num_buffers = asked_num_buffers;
+
+    this->original_file_size = original_file_size;
+    if (this->original_file_size <= this->max_buf_size) {
+        this->output_buffer_size = this->original_file_size;
+        this->num_buffers = 1;
+    }
+}
+
+template <typename Task>
+void TaskBuffers<Task>::setDeviceLimits(DEVICE_TYPE dev_type) {
+    strcpy(this->input_file_path, Task::input_path);
+    strcpy(this->output_file_path, Task::output_path);
+
+    switch (dev_type) {
+        case DEVICE_TYPE::BF3:
+            this->max_buf_size = BUFFER_SIZE_BF3;
+            break;
+        default:
+            this->max_buf_size = BUFFER_SIZE_BF2;
+            break;
+    }
+}
+
+template <typename Task>
+bool TaskBuffers<Task>::readFile() {
+    this->ifp = fopen(this->input_file_path, "r");
+    if (this->ifp == nullptr)
+        return false;
+
+    if (fseek(this->ifp, 0, SEEK_END) != 0) {
+        fclose(this->ifp);
+        return false;
+    }
+
+    long nb_file_bytes = ftell(this->ifp);
+
+    if (nb_file_bytes == -1 || nb_file_bytes == 0) {
+        fclose(this->ifp);
+        return false;
+    }
+
+    if (fseek(this->ifp, 0, SEEK_SET) != 0) {
+        fclose(this->ifp);
+        return false;
+    }
+
+    this->input_file_size = nb_file_bytes;
+
+    // whole input and output fit in their respective buffer sizes
+    if (!Task::split_input && this->num_buffers == 1) {
+        this->input_buff_size = this->input_file_size;
+    }
+
+    return true;
+}
+
+template <typename Task>
+void TaskBuffers<Task>::reserveInput(size_t capacity) {
+    this->input_file_size = capacity;
+
+    // as readFile, a single buffer takes the whole input
+    if (!Task::split_input && this->num_buffers == 1) {
+        this->input_buff_size = this->input_file_size;
+    }
+}
+
+template <typename Task>
+bool TaskBuffers<Task>::prepareBuffersAndRegions() {
+    if constexpr (Task::split_input) {
+        if (this->input_file_size <= this->max_buf_size) {
+            this->num_buffers = 1;
+            this->input_buff_size = this->input_file_size;
+        } else {
+            this->num_buffers = static_cast<std::uint32_t>(this->input_file_size / this->input_buff_size);
+            if (this->input_file_size % this->input_buff_size != 0) {
+                this->num_buffers++;  // If there's a remainder, add one extra batch to cover it.
+            }
+        }
+        this->output_buffer_size = this->input_buff_size;
+    }
+
+    std::cout << "prepareBuffersAndRegions: " << this->num_buffers << " buffers" << std::endl;
+
+    int ret = posix_memalign((void **)&this->indata, 64, this->num_buffers * this->input_buff_size);
+    if (ret != 0) {
+        this->indata = nullptr;
+        return false;
+    }
+    ret = posix_memalign((void **)&this->outdata, 64, this->num_buffers * this->output_buffer_size);
+    if (ret != 0) {
+        this->outdata = nullptr;
+        this->releaseBuffers();
+        return false;
+    }
+
+    this->region_buffer = static_cast<region*>(std::calloc(std::max(this->num_buffers, this->task_slots),
+                                                           sizeof(struct region)));
+    if (!this->region_buffer) {
+        this->releaseBuffers();
+        return false;
+    }
+
+    // reserveInput: nothing to read, loadInput fills the buffers
+    size_t read_count = this->num_buffers;
+    if (this->ifp != nullptr) {
+        read_count = fread(this->indata, this->input_buff_size, this->num_buffers, this->ifp);
+        fclose(this->ifp);
+        this->ifp = nullptr;
+    }
+    if (read_count != this->num_buffers) {
+        // a split file ends with a partial buffer, it is not offloaded
+        if (Task::split_input && this->num_buffers - read_count == 1) {
+            this->num_buffers = read_count;
+        } else {
+            this->releaseBuffers();
+            return false;
+        }
+    }
+    this->task_slots = std::max(this->task_slots, this->num_buffers);
+    this->buffer_capacity = this->num_buffers * this->input_buff_size;
+    this->prepared_buffer_size = this->input_buff_size;
+
+    return true;
+}
+
+template <typename Task>
+bool TaskBuffers<Task>::layoutPrefix(size_t bytes, uint64_t buffer_size, uint64_t max_buffers) {
+    PrefixLayout layout = prefixLayout(std::min(bytes, this->buffer_capacity), buffer_size, max_buffers,
+                                       this->max_buf_size);
+    if (layout.tasks == 0) {
+        return false;
+    }
+    if (layout.tasks > this->task_slots) {
+        std::cerr << "layoutPrefix: " << layout.tasks << " tasks, sized for " << this->task_slots << std::endl;
+        return false;
+    }
+    this->num_buffers = layout.tasks;
+    this->input_buff_size = layout.buffer_size;
+    if constexpr (Task::split_input) {
+        this->output_buffer_size = layout.buffer_size;
+    }
+    return true;
+}
+
+template <typename Task>
+bool TaskBuffers<Task>::loadInput(const uint8_t *data, size_t bytes) {
+    if (bytes == 0 || bytes > this->buffer_capacity) {
+        std::cerr << "loadInput: " << bytes << " bytes, sized for " << this->buffer_capacity << std::endl;
+        return false;
+    }
+    std::memcpy(this->indata, data, bytes);
+    this->input_file_size = bytes;
+    return this->layoutPrefix(bytes, this->prepared_buffer_size, 0);
+}
+
+template <typename Task>
+void TaskBuffers<Task>::releaseBuffers() {
+    free(this->region_buffer);
+    free(this->indata);
+    free(this->outdata);
+    this->region_buffer = nullptr;
+    this->indata = nullptr;
+    this->outdata = nullptr;
+}
+
+template <typename Task>
+std::string TaskBuffers<Task>::calculateSeconds(const std::chrono::steady_clock::time_point end,
+                                                const std::chrono::steady_clock::time_point start) {
+    auto elapsed = end - start;
+    auto seconds = std::chrono::duration<double>(elapsed).count();
+    // Convert the float to a string with fixed formatting and desired precision
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(8) << seconds;
+    std::string formattedValue = oss.str();
+    return formattedValue;
+}
+
+template class TaskBuffers<CompressDeflateTask>;
+template class TaskBuffers<DecompressDeflateTask>;
+template class TaskBuffers<DecompressLz4Task>;
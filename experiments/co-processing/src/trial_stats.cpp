@@ -0,0 +1,125 @@
+#include "trial_stats.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+
+#include <nlohmann/json.hpp>
+
+bool TrialOptions::parseFlag(int argc, char **argv, int &idx) {
+    std::string flag = argv[idx];
+    if (flag == "--warmup" && idx + 1 < argc) {
+        warmup = std::stoul(argv[++idx]);
+    } else if (flag == "--repeat" && idx + 1 < argc) {
+        repeat = std::max<size_t>(std::stoul(argv[++idx]), 1);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+double sortedQuantile(const std::vector<double> &sorted, double q) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    double rank = q * (sorted.size() - 1);
+    size_t lower = static_cast<size_t>(rank);
+    size_t upper = std::min(lower + 1, sorted.size() - 1);
+    return sorted[lower] + (rank - lower) * (sorted[upper] - sorted[lower]);
+}
+
+TrialSummary summarizeTrials(std::vector<double> samples, size_t resamples, double confidence, uint64_t seed) {
+    TrialSummary summary;
+    summary.n = samples.size();
+    if (samples.empty()) {
+        return summary;
+    }
+    std::sort(samples.begin(), samples.end());
+
+    double sum = 0;
+    for (double sample : samples) {
+        sum += sample;
+    }
+    summary.mean = sum / samples.size();
+    double squares = 0;
+    for (double sample : samples) {
+        squares += (sample - summary.mean) * (sample - summary.mean);
+    }
+    summary.stddev = samples.size() > 1 ? std::sqrt(squares / (samples.size() - 1)) : 0;
+    summary.median = sortedQuantile(samples, 0.5);
+    summary.p5 = sortedQuantile(samples, 0.05);
+    summary.p95 = sortedQuantile(samples, 0.95);
+
+    // medians of resamples drawn with replacement, fixed seed so reruns of the
+    // analysis give the same interval
+    summary.ci_low = summary.ci_high = summary.median;
+    if (samples.size() > 1 && resamples > 0) {
+        std::mt19937_64 rng(seed);
+        std::uniform_int_distribution<size_t> pick(0, samples.size() - 1);
+        std::vector<double> resample(samples.size());
+        std::vector<double> medians(resamples);
+        for (auto &median : medians) {
+            for (auto &value : resample) {
+                value = samples[pick(rng)];
+            }
+            std::sort(resample.begin(), resample.end());
+            median = sortedQuantile(resample, 0.5);
+        }
+        std::sort(medians.begin(), medians.end());
+        double tail = (1.0 - confidence) / 2;
+        summary.ci_low = sortedQuantile(medians, tail);
+        summary.ci_high = sortedQuantile(medians, 1.0 - tail);
+    }
+    return summary;
+}
+
+// the summarized results, keys ending in "elapsed"
+static bool isTiming(const std::string &key) {
+    return key.size() >= 7 && key.compare(key.size() - 7, 7, "elapsed") == 0;
+}
+
+void TrialRecorder::add(const std::vector<std::string> &values) {
+    if (samples_.size() < values.size()) {
+        samples_.resize(values.size());
+    }
+    for (size_t idx = 0; idx < values.size(); ++idx) {
+        char *end = nullptr;
+        double value = std::strtod(values[idx].c_str(), &end);
+        if (end != values[idx].c_str()) {
+            samples_[idx].push_back(value);
+        }
+    }
+    ++runs_;
+}
+
+std::vector<std::pair<std::string, TrialSummary>> TrialRecorder::summaries(const std::vector<std::string> &keys) const {
+    std::vector<std::pair<std::string, TrialSummary>> result;
+    for (size_t idx = 0; idx < std::min(keys.size(), samples_.size()); ++idx) {
+        const std::string &key = keys[idx];
+        if (samples_[idx].empty() || !isTiming(key)) {
+            continue;
+        }
+        result.emplace_back(key, summarizeTrials(samples_[idx], options_.resamples, options_.confidence, idx + 1));
+    }
+    return result;
+}
+
+nlohmann::json TrialRecorder::toJson(const std::vector<std::string> &keys) const {
+    if (!options_.repeated()) {
+        return nullptr;
+    }
+    nlohmann::json metrics;
+    for (size_t idx = 0; idx < std::min(keys.size(), samples_.size()); ++idx) {
+        const std::string &key = keys[idx];
+        if (samples_[idx].empty() || !isTiming(key)) {
+            continue;
+        }
+        TrialSummary summary = summarizeTrials(samples_[idx], options_.resamples, options_.confidence, idx + 1);
+        metrics[key] = {{"n", summary.n},           {"mean", summary.mean},     {"median", summary.median},
+                        {"p5", summary.p5},         {"p95", summary.p95},       {"stddev", summary.stddev},
+                        {"ci_low", summary.ci_low}, {"ci_high", summary.ci_high}, {"samples", samples_[idx]}};
+    }
+    return {{"warmup", options_.warmup}, {"repeat", options_.repeat}, {"confidence", options_.confidence},
+            {"metrics", metrics}};
+}
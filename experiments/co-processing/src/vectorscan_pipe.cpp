@@ -0,0 +1,232 @@
+#include "vectorscan_pipe.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+
+// Lines handed to a single hs_scan_vector call
+static const size_t VECTOR_BATCH_LINES = 1024;
+
+// Separator between lines in vectored mode, patterns are newline-anchored
+static const char LINE_SEPARATOR[] = "\n";
+
+// Maps the end offsets of a vectored scan back to the scanned rows.
+struct BatchMatchContext {
+    const std::vector<unsigned long long>* starts; // start offset of each line in the batch
+    const std::vector<size_t>* rows;               // row index of each line in the batch
+    uint8_t* hits;
+};
+
+static int onLineMatch(unsigned int id, unsigned long long from, unsigned long long to,
+                       unsigned int flags, void* context) {
+    *static_cast<uint8_t*>(context) = 1;
+    // Stop scanning the line after the first match
+    return 1;
+}
+
+static int onBatchMatch(unsigned int id, unsigned long long from, unsigned long long to,
+                        unsigned int flags, void* context) {
+    auto* batch = static_cast<BatchMatchContext*>(context);
+    // The last matched byte is at to - 1, find the line that holds it
+    auto it = std::upper_bound(batch->starts->begin(), batch->starts->end(), to - 1);
+    size_t line_idx = static_cast<size_t>(it - batch->starts->begin()) - 1;
+    batch->hits[(*batch->rows)[line_idx]] = 1;
+    // Keep scanning: one scan holds a batch of lines, stopping (or
+    // HS_FLAG_SINGLEMATCH) would drop the later lines of the batch
+    return 0;
+}
+
+// Constructor: initialize members.
+VectorscanPipe::VectorscanPipe(const std::string& input_location, RegexScanOptions options)
+    : input_location_(input_location), iters_(3), options_(options) {
+}
+
+VectorscanPipe::~VectorscanPipe() {
+    if (scratch_ != nullptr) {
+        hs_free_scratch(scratch_);
+    }
+    for (auto* database : databases_) {
+        hs_free_database(database);
+    }
+}
+
+// init: Compile one database per query and load file data.
+void VectorscanPipe::init() {
+    queries_ = options_.query_file.empty() ? defaultRegexQueries() : loadRegexQueries(options_.query_file);
+
+    // Anchor full matches like RE2::FullMatch. In vectored mode the lines are
+    // newline-separated, so the anchors have to match at line bounds. A line
+    // scan only needs its first match, the others are not even raised.
+    unsigned int flags = options_.vectored ? HS_FLAG_MULTILINE : HS_FLAG_SINGLEMATCH;
+    unsigned int mode = options_.vectored ? HS_MODE_VECTORED : HS_MODE_BLOCK;
+    for (const auto &query : queries_) {
+        const auto &pattern = query.pattern;
+        patterns_.push_back(pattern);
+        std::string anchored = query.full_match ? "^" + pattern + "$" : pattern;
+        const char* expression = anchored.c_str();
+        unsigned int id = 0;
+        hs_database_t* database = nullptr;
+        hs_compile_error_t* compile_err = nullptr;
+        if (hs_compile_multi(&expression, &flags, &id, 1, mode, nullptr, &database, &compile_err) != HS_SUCCESS) {
+            std::string message = compile_err ? compile_err->message : "unknown error";
+            hs_free_compile_error(compile_err);
+            throw std::runtime_error("Failed to compile pattern: " + pattern + " (" + message + ")");
+        }
+        databases_.push_back(database);
+
+        // One scratch large enough for every database
+        if (hs_alloc_scratch(database, &scratch_) != HS_SUCCESS) {
+            throw std::runtime_error("Unable to allocate scratch space");
+        }
+    }
+    if (options_.prefilter) {
+        prefilter_ = std::make_unique<LiteralPrefilter>(patterns_);
+    }
+
+    // Load and prepare file data (the columns of the queries).
+    columns_ = loadQueryColumns(input_location_, queries_, options_.dictionary_encode, query_columns_,
+                                options_.rows, options_.shared_columns.get());
+}
+
+void VectorscanPipe::scanLines(const std::vector<std::string>& rows, hs_database_t* database, bool use_prefilter,
+                               size_t pattern_idx, size_t& passed, hs_scratch_t* scratch) {
+    for (size_t idx = 0; idx < rows.size(); ++idx) {
+        value_hits_[idx] = 0;
+        if (use_prefilter && !prefilter_->mayMatch(pattern_idx, rows[idx])) {
+            continue;
+        }
+        ++passed;
+        hs_scan(database, rows[idx].data(), rows[idx].size(), 0, scratch, onLineMatch, &value_hits_[idx]);
+    }
+}
+
+void VectorscanPipe::scanBatches(const std::vector<std::string>& rows, hs_database_t* database, bool use_prefilter,
+                                 size_t pattern_idx, size_t& passed, hs_scratch_t* scratch) {
+    std::vector<const char*> data;
+    std::vector<unsigned int> lengths;
+    std::vector<unsigned long long> starts;
+    std::vector<size_t> batch_rows;
+    data.reserve(2 * VECTOR_BATCH_LINES);
+    lengths.reserve(2 * VECTOR_BATCH_LINES);
+    starts.reserve(VECTOR_BATCH_LINES);
+    batch_rows.reserve(VECTOR_BATCH_LINES);
+    BatchMatchContext context{&starts, &batch_rows, value_hits_.data()};
+
+    std::fill(value_hits_.begin(), value_hits_.end(), 0);
+    for (size_t begin = 0; begin < rows.size(); begin += VECTOR_BATCH_LINES) {
+        size_t end = std::min(rows.size(), begin + VECTOR_BATCH_LINES);
+        data.clear();
+        lengths.clear();
+        starts.clear();
+        batch_rows.clear();
+
+        // Point at the lines in place, interleaved with separators (no copies)
+        unsigned long long offset = 0;
+        for (size_t idx = begin; idx < end; ++idx) {
+            if (use_prefilter && !prefilter_->mayMatch(pattern_idx, rows[idx])) {
+                continue;
+            }
+            starts.push_back(offset);
+            batch_rows.push_back(idx);
+            data.push_back(rows[idx].data());
+            lengths.push_back(static_cast<unsigned int>(rows[idx].size()));
+            data.push_back(LINE_SEPARATOR);
+            lengths.push_back(1);
+            offset += rows[idx].size() + 1;
+        }
+        passed += batch_rows.size();
+        if (batch_rows.empty()) {
+            continue;
+        }
+        hs_scan_vector(database, data.data(), lengths.data(), static_cast<unsigned int>(data.size()),
+                       0, scratch, onBatchMatch, &context);
+    }
+}
+
+size_t VectorscanPipe::scanPattern(size_t pattern_idx, bool use_prefilter, size_t& passed, hs_scratch_t* scratch) {
+    // With the dictionary, evaluate once per distinct value and expand to rows.
+    const auto &column = columns_[query_columns_[pattern_idx]];
+    const auto &rows = column.scanned();
+    value_hits_.resize(rows.size());
+    passed = 0;
+    if (options_.vectored) {
+        this->scanBatches(rows, databases_[pattern_idx], use_prefilter, pattern_idx, passed, scratch);
+    } else {
+        this->scanLines(rows, databases_[pattern_idx], use_prefilter, pattern_idx, passed, scratch);
+    }
+
+    size_t matches = 0;
+    if (column.encoded) {
+        column.dict.expand(value_hits_, row_hits_);
+        for (auto hit : row_hits_) {
+            matches += hit;
+        }
+    } else {
+        for (auto hit : value_hits_) {
+            matches += hit;
+        }
+    }
+    return matches;
+}
+
+// execute: Benchmark the per-query databases.
+void VectorscanPipe::execute() {
+    // Scratch is not thread-safe, the executing thread gets its own clone
+    hs_scratch_t* scratch = nullptr;
+    if (hs_clone_scratch(scratch_, &scratch) != HS_SUCCESS) {
+        throw std::runtime_error("Unable to clone scratch space");
+    }
+
+    std::cerr << "CPU regex starting iters..." << std::endl;
+    for (size_t pattern_idx = 0; pattern_idx < databases_.size(); ++pattern_idx) {
+        double avg_duration = 0.0;
+        size_t matches = 0;
+        size_t passed = 0;
+        for (int iter = 0; iter < iters_; ++iter) {
+            auto start = std::chrono::high_resolution_clock::now();
+            matches = this->scanPattern(pattern_idx, options_.prefilter, passed, scratch);
+            auto end = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> duration = end - start;
+            avg_duration += duration.count();
+        }
+        full_match_durations_.push_back(avg_duration / iters_);
+        match_counts_.push_back(matches);
+        prefilter_passed_.push_back(passed);
+    }
+    hs_free_scratch(scratch);
+}
+
+// cleanup: Output the benchmark results.
+void VectorscanPipe::cleanup() {
+    results_.clear();
+    for (size_t idx = 0; idx < full_match_durations_.size(); ++idx) {
+        const auto &column = columns_[query_columns_[idx]];
+        RegexQueryResult result{queries_[idx].id, column.size_bytes, column.dedupRatio(),
+                                full_match_durations_[idx], match_counts_[idx], 1.0, 0.0, 0, 0, 0};
+        size_t scanned = column.scanned().size();
+        if (scanned) {
+            result.prefilter_pass = static_cast<double>(prefilter_passed_[idx]) / scanned;
+        }
+
+        // Time saved by the prefilter, measured outside the timed execution
+        if (options_.prefilter) {
+            size_t passed = 0;
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t matches = this->scanPattern(idx, false, passed, scratch_);
+            auto end = std::chrono::high_resolution_clock::now();
+            result.saved_seconds = std::chrono::duration<double>(end - start).count() - result.seconds;
+            if (matches != result.matches) {
+                std::cerr << "Prefilter changed the matches of q" << queries_[idx].id << ": "
+                          << result.matches << " vs " << matches << std::endl;
+            }
+        }
+        results_.push_back(result);
+    }
+
+    std::string device = options_.device + "_vectorscan";
+    device += options_.vectored ? "_vectored" : "";
+    device += options_.dictionary_encode ? "_dict" : "";
+    device += options_.prefilter ? "_prefilter" : "";
+    printRegexReport(device, results_);
+}
@@ -1,10 +1,17 @@
+#include <algorithm>
+
 #include "zpipe.hpp"
+#include "compressibility.hpp"
 
 Zpipe::Zpipe() : m_inFile(nullptr), m_outFile(nullptr), m_deflateLevel(Z_DEFAULT_COMPRESSION) {
     // Zero out the z_stream
     std::memset(&stream, 0, sizeof(stream));
 }
 
+Zpipe::Zpipe(bool incompressible_bypass) : Zpipe() {
+    m_bypassIncompressible = incompressible_bypass;
+}
+
 int Zpipe::readFileInChunks() {
     while (true) {
         std::vector<unsigned char> buffer(CHUNK);
@@ -197,11 +204,19 @@ int Zpipe::deflate_execute_single_buffer() {
         return Z_ERRNO;
     }
 
-    // 2) Clear any old compressed data
+    // 2) Clear any old compressed data, a finished stream starts over (repeated runs)
     m_fullOutput.clear();
+    deflateReset(&this->stream);
+
+    size_t inputSize = m_inputLimit > 0 ? std::min(m_inputLimit, m_fullInput.size()) : m_fullInput.size();
+
+    // 2.b) Random input would only grow, store it (before any input, the level can still change;
+    //      the reset keeps the level of the previous run, so it is set either way)
+    bool stored = m_bypassIncompressible && CompressibilityEstimator{}.incompressible(m_fullInput.data(), inputSize);
+    deflateParams(&this->stream, stored ? 0 : m_deflateLevel, Z_DEFAULT_STRATEGY);
 
     // 3) Tell zlib we have the entire file in memory
-    this->stream.avail_in = static_cast<uInt>(m_fullInput.size());
+    this->stream.avail_in = static_cast<uInt>(inputSize);
     this->stream.next_in  = reinterpret_cast<Bytef*>(m_fullInput.data());
 
     // 4) We'll call deflate with Z_FINISH in a loop until it returns Z_STREAM_END
@@ -247,8 +262,9 @@ int Zpipe::inflate_execute_single_buffer() {
         return Z_ERRNO;
     }
 
-    // 2) Clear any old decompressed data
+    // 2) Clear any old decompressed data, a finished stream starts over (repeated runs)
     m_fullOutput.clear();
+    inflateReset(&this->stream);
 
     // 3) Provide the entire compressed buffer to zlib
     this->stream.avail_in = static_cast<uInt>(m_fullInput.size());
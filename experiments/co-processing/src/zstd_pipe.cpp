@@ -0,0 +1,181 @@
+#include "zstd_pipe.hpp"
+
+#include <cstring>
+#include <iostream>
+
+static const size_t READ_CHUNK = 16384;
+
+static bool zstdFailed(size_t ret, const char *what) {
+    if (ZSTD_isError(ret)) {
+        std::cerr << "zstd " << what << ": " << ZSTD_getErrorName(ret) << "\n";
+        return true;
+    }
+    return false;
+}
+
+ZstdPipe::ZstdPipe(ZstdOptions options) : m_options(options) {}
+
+ZstdPipe::~ZstdPipe() {
+    reset();
+}
+
+int ZstdPipe::readInputFile(const std::string &filename) {
+    m_originalData.clear();
+
+    FILE *fp = std::fopen(filename.c_str(), "rb");
+    if (!fp) {
+        std::cerr << "Could not open " << filename << "\n";
+        return -1;
+    }
+
+    char temp[READ_CHUNK];
+    size_t bytesRead;
+    while ((bytesRead = std::fread(temp, 1, READ_CHUNK, fp)) > 0) {
+        m_originalData.insert(m_originalData.end(), temp, temp + bytesRead);
+    }
+    bool failed = std::ferror(fp);
+    std::fclose(fp);
+
+    if (failed || m_originalData.empty()) {
+        std::cerr << "No data to compress.\n";
+        return -1;
+    }
+    return 0;
+}
+
+int ZstdPipe::openOutputFile(const std::string &filename) {
+    m_outFile = std::fopen(filename.c_str(), "wb");
+    if (!m_outFile) {
+        std::cerr << "Failed to open output file: " << filename << "\n";
+        m_originalData.clear();
+        return -1;
+    }
+    return 0;
+}
+
+int ZstdPipe::configure() {
+    if (!m_cctx) {
+        m_cctx = ZSTD_createCCtx();
+    }
+    if (!m_cctx) {
+        return -1;
+    }
+    ZSTD_CCtx_reset(m_cctx, ZSTD_reset_session_and_parameters);
+
+    if (zstdFailed(ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_compressionLevel, m_options.level), "level")) {
+        return -1;
+    }
+    if (m_options.long_distance &&
+        zstdFailed(ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_enableLongDistanceMatching, 1), "long distance matching")) {
+        return -1;
+    }
+    if (m_options.window_log > 0 &&
+        zstdFailed(ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_windowLog, m_options.window_log), "window log")) {
+        return -1;
+    }
+    // libzstd built without ZSTD_MULTITHREAD rejects workers, compress on this thread then
+    if (m_options.workers > 0 &&
+        zstdFailed(ZSTD_CCtx_setParameter(m_cctx, ZSTD_c_nbWorkers, m_options.workers), "workers")) {
+        std::cerr << "zstd: compressing single-threaded\n";
+        m_options.workers = 0;
+    }
+    return 0;
+}
+
+void ZstdPipe::writeOutput(const std::vector<char> &data, size_t size) {
+    if (m_outFile) {
+        if (size > 0) {
+            size_t written = std::fwrite(data.data(), 1, size, m_outFile);
+            if (written != size || std::ferror(m_outFile)) {
+                std::cerr << "Error writing zstd output.\n";
+            }
+        }
+        std::fclose(m_outFile);
+        m_outFile = nullptr;
+    }
+}
+
+void ZstdPipe::reset() {
+    if (m_outFile) {
+        std::fclose(m_outFile);
+        m_outFile = nullptr;
+    }
+    ZSTD_freeCCtx(m_cctx);
+    m_cctx = nullptr;
+    ZSTD_freeDCtx(m_dctx);
+    m_dctx = nullptr;
+
+    m_originalData.clear();
+    m_compressedData.clear();
+    m_decompressedData.clear();
+    m_compressedSize = 0;
+}
+
+int ZstdPipe::compress_init(const std::string &inputFile, const std::string &outputFile) {
+    if (readInputFile(inputFile) != 0 || openOutputFile(outputFile) != 0 || configure() != 0) {
+        return -1;
+    }
+    m_compressedData.resize(ZSTD_compressBound(m_originalData.size()));
+    return 0;
+}
+
+int ZstdPipe::compress_execute() {
+    // blocking, zstd's workers (if any) split the frame into jobs
+    m_compressedSize = ZSTD_compress2(m_cctx, m_compressedData.data(), m_compressedData.size(),
+                                      m_originalData.data(), m_originalData.size());
+    if (zstdFailed(m_compressedSize, "compression failed")) {
+        m_compressedSize = 0;
+        return -1;
+    }
+    return 0;
+}
+
+void ZstdPipe::compress_cleanup() {
+    writeOutput(m_compressedData, m_compressedSize);
+    reset();
+}
+
+int ZstdPipe::decompress_init(const std::string &inputFile, const std::string &outputFile) {
+    if (readInputFile(inputFile) != 0 || configure() != 0) {
+        return -1;
+    }
+
+    // compress in memory so there is a frame to decompress
+    m_compressedData.resize(ZSTD_compressBound(m_originalData.size()));
+    if (compress_execute() != 0) {
+        std::cerr << "Failed to compress data in memory.\n";
+        return -1;
+    }
+    m_compressedData.resize(m_compressedSize);
+
+    if (openOutputFile(outputFile) != 0) {
+        return -1;
+    }
+
+    // long-distance frames may use windows past the decoder's default limit
+    m_dctx = ZSTD_createDCtx();
+    int window_log_max = ZSTD_dParam_getBounds(ZSTD_d_windowLogMax).upperBound;
+    if (!m_dctx || zstdFailed(ZSTD_DCtx_setParameter(m_dctx, ZSTD_d_windowLogMax, window_log_max), "window limit")) {
+        return -1;
+    }
+    m_decompressedData.resize(m_originalData.size());
+    return 0;
+}
+
+int ZstdPipe::decompress_execute() {
+    size_t decompressedBytes = ZSTD_decompressDCtx(m_dctx, m_decompressedData.data(), m_decompressedData.size(),
+                                                   m_compressedData.data(), m_compressedSize);
+    if (zstdFailed(decompressedBytes, "decompression failed")) {
+        return -1;
+    }
+    if (decompressedBytes != m_decompressedData.size()) {
+        std::cerr << "Warning: Decompressed size mismatch. Got "
+                  << decompressedBytes << " vs expected " << m_decompressedData.size() << "\n";
+    }
+    return 0;
+}
+
+void ZstdPipe::decompress_cleanup() {
+    writeOutput(m_decompressedData, m_decompressedData.size());
+    reset();
+}
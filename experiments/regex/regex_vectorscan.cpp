@@ -7,6 +7,13 @@
 #include <string>
 #include <vector>
 #include <algorithm>  // for std::remove
+#include <cstring>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+
+#include "dict_column.hpp"        // shared with co-processing
+#include "literal_prefilter.hpp"  // shared with co-processing
 
 /*****************************************************************************
  * 1. Load CSV into memory, extracting "Description" column
@@ -43,8 +50,10 @@ std::pair<std::vector<std::string>, size_t> prepareAccidentDescrInMemory() {
     }
     data_file.close();
 
-    // Remove header row (the first line in many CSV files), if present
+    // Remove header row (the first line in many CSV files), if present,
+    // and its bytes from the throughput basis as loadCsvColumn does
     if (!data_lines.empty()) {
+        total_size_bytes -= data_lines.front().size();
         data_lines.erase(data_lines.begin());
     }
 
@@ -64,7 +73,9 @@ std::string makeAnchored(const std::string &pat) {
  * 3. Compile a set of patterns into a single Hyperscan/vectorscan database.
  *    - Each pattern gets an ID = its index in the vector.
  *****************************************************************************/
-hs_database_t* compileDatabase(const std::vector<std::string> &patterns) {
+hs_database_t* compileDatabase(const std::vector<std::string> &patterns,
+                               unsigned int patternFlags = 0,
+                               unsigned int mode = HS_MODE_BLOCK) {
     // Patterns, flags, IDs
     std::vector<const char*> cstr_patterns;
     std::vector<unsigned int> flags;
@@ -77,7 +88,7 @@ hs_database_t* compileDatabase(const std::vector<std::string> &patterns) {
     for (unsigned i = 0; i < patterns.size(); ++i) {
         cstr_patterns.push_back(patterns[i].c_str());
         // HS_FLAG_SOM_LEFTMOST or HS_FLAG_DOTALL or HS_FLAG_CASELESS if needed, etc.
-        flags.push_back(0); 
+        flags.push_back(patternFlags);
         ids.push_back(i);
     }
 
@@ -90,7 +101,7 @@ hs_database_t* compileDatabase(const std::vector<std::string> &patterns) {
         flags.data(),
         ids.data(),
         (unsigned int)patterns.size(),
-        HS_MODE_BLOCK,
+        mode,
         nullptr, // No platform tuning
         &database,
         &compileErr
@@ -108,6 +119,87 @@ hs_database_t* compileDatabase(const std::vector<std::string> &patterns) {
     return database;
 }
 
+/*****************************************************************************
+ * 3b. Compiled database cache.
+ *     Compiling large rule sets takes seconds, loading a serialized database
+ *     takes milliseconds. Databases are stored as <dir>/<key>.hsdb, the key
+ *     hashes the library version, mode, flags and the patterns.
+ *****************************************************************************/
+struct DatabaseCache {
+    std::string dir;        // empty disables the cache
+    size_t loaded = 0;      // databases deserialized from disk
+    size_t compiled = 0;    // databases compiled (and stored)
+};
+
+std::string databaseCacheKey(const std::vector<std::string> &patterns,
+                             unsigned int patternFlags, unsigned int mode) {
+    // FNV-1a, patterns separated by NUL so ["ab","c"] != ["a","bc"]
+    uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void *data, size_t len) {
+        const auto *bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < len; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    std::string version = hs_version();
+    mix(version.data(), version.size() + 1);
+    mix(&mode, sizeof(mode));
+    mix(&patternFlags, sizeof(patternFlags));
+    for (const auto &p : patterns) {
+        mix(p.data(), p.size() + 1);
+    }
+    std::ostringstream key;
+    key << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return key.str();
+}
+
+hs_database_t* loadOrCompileDatabase(const std::vector<std::string> &patterns,
+                                     unsigned int patternFlags,
+                                     unsigned int mode,
+                                     DatabaseCache &cache) {
+    if (cache.dir.empty()) {
+        cache.compiled++;
+        return compileDatabase(patterns, patternFlags, mode);
+    }
+    std::string path = cache.dir + "/" + databaseCacheKey(patterns, patternFlags, mode) + ".hsdb";
+
+    // Try the serialized database first
+    std::ifstream in(path, std::ios::binary);
+    if (in) {
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        hs_database_t *database = nullptr;
+        if (hs_deserialize_database(bytes.data(), bytes.size(), &database) == HS_SUCCESS) {
+            cache.loaded++;
+            return database;
+        }
+        // Stale or truncated file, recompile and overwrite it
+        std::cerr << "WARN: ignoring unreadable database " << path << std::endl;
+    }
+
+    hs_database_t *database = compileDatabase(patterns, patternFlags, mode);
+    if (!database) {
+        return nullptr;
+    }
+    cache.compiled++;
+
+    char *bytes = nullptr;
+    size_t length = 0;
+    if (hs_serialize_database(database, &bytes, &length) != HS_SUCCESS) {
+        std::cerr << "WARN: unable to serialize database for " << path << std::endl;
+        return database;
+    }
+    std::error_code ec;
+    std::filesystem::create_directories(cache.dir, ec);
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(bytes, (std::streamsize)length);
+    if (!out) {
+        std::cerr << "WARN: unable to write " << path << std::endl;
+    }
+    // hs allocates the serialized bytes with the misc allocator (malloc)
+    std::free(bytes);
+    return database;
+}
+
 /*****************************************************************************
  * 4. Utility: Allocates scratch for the given database.
  *****************************************************************************/
@@ -138,17 +230,187 @@ static int onMatch(unsigned int id,
     return 1; 
 }
 
+/*****************************************************************************
+ * 5b. Whole-buffer scanning.
+ *     One hs_scan per line is dominated by call overhead for short lines.
+ *     Instead the lines are laid out once in a contiguous buffer, each line
+ *     followed by '\n', and scanned either as batches of lines with
+ *     hs_scan_vector (Vectored) or as large blocks with hs_scan (Block).
+ *     Patterns are compiled with HS_FLAG_MULTILINE so ^/$ anchor at line
+ *     boundaries, and '.' does not match '\n', so matches stay within a line.
+ *     Match end offsets are mapped back to rows by a binary search over the
+ *     line start offsets.
+ *****************************************************************************/
+enum class ScanMode { Line, Vectored, Block };
+
+// Lines handed to one hs_scan_vector call
+static const size_t VECTOR_BATCH_LINES = 1024;
+// Upper bound of one hs_scan call in block mode (length is an unsigned int)
+static const size_t MAX_BLOCK_BYTES = 1ull << 30;
+
+struct ColumnBuffer {
+    std::string bytes;                         // lines, each followed by '\n'
+    std::vector<unsigned long long> starts;    // offset of each line in bytes
+};
+
+ColumnBuffer buildColumnBuffer(const std::vector<std::string> &lines) {
+    ColumnBuffer buffer;
+    size_t total = 0;
+    for (const auto &line : lines) {
+        total += line.size() + 1;
+    }
+    buffer.bytes.reserve(total);
+    buffer.starts.reserve(lines.size());
+    for (const auto &line : lines) {
+        buffer.starts.push_back(buffer.bytes.size());
+        buffer.bytes.append(line).push_back('\n');
+    }
+    return buffer;
+}
+
+struct OffsetMatchContext {
+    const unsigned long long *starts;  // ascending line start offsets
+    size_t count;                      // number of lines in starts
+    unsigned long long base;           // offset of the scanned data in starts' frame
+    const size_t *rows;                // line -> row, nullptr maps line i to row i
+    uint8_t *hits;
+};
+
+static int onOffsetMatch(unsigned int id,
+                         unsigned long long from,
+                         unsigned long long to,
+                         unsigned int flags,
+                         void *context)
+{
+    auto *ctx = (OffsetMatchContext*)context;
+    // The last matched byte is at to - 1, find the line holding it
+    unsigned long long last = ctx->base + to - 1;
+    size_t line = (size_t)(std::upper_bound(ctx->starts, ctx->starts + ctx->count, last) - ctx->starts) - 1;
+    ctx->hits[ctx->rows ? ctx->rows[line] : line] = 1;
+    // Keep scanning, later lines of the same block may match too
+    return 0;
+}
+
 /*****************************************************************************
  * 6. Benchmark scanning a set of patterns on all lines, repeated "iters" times.
  *    We'll treat "dbPartial" as the unanchored patterns, 
  *    and "dbFull" as the anchored patterns. 
  *****************************************************************************/
+struct ScanSetup {
+    ScanMode mode = ScanMode::Line;
+    const ColumnBuffer *buffer = nullptr;          // Vectored and Block modes
+    const DictColumn *dict = nullptr;              // distinct values only, see 1b
+    const LiteralPrefilter *prefilter = nullptr;   // not used in Block mode
+    int prefilterQuery = -1;                       // < 0: any query
+};
+
+// One pass over all lines with one database, fills the per-line hits.
+void scanOnce(hs_database_t *db, hs_scratch_t *scratch, const std::vector<std::string> &lines,
+              const ScanSetup &setup, std::vector<uint8_t> &valueHits)
+{
+    // The prefilter checks one query's literals, or any query's for a
+    // multi-pattern database (prefilterQuery < 0).
+    auto mayMatch = [&](const std::string &line) {
+        return setup.prefilterQuery < 0 ? setup.prefilter->mayMatchAny(line)
+                                        : setup.prefilter->mayMatch((size_t)setup.prefilterQuery, line);
+    };
+
+    if (setup.mode == ScanMode::Line) {
+        // Scan each line
+        for (size_t idx = 0; idx < lines.size(); ++idx) {
+            const auto &line = lines[idx];
+            bool matched = false;
+            // Lines without any required literal can not match.
+            if (setup.prefilter && !mayMatch(line)) {
+                valueHits[idx] = false;
+                continue;
+            }
+            hs_scan(db,
+                    line.data(),
+                    line.size(),
+                    0, // flags
+                    scratch,
+                    onMatch,
+                    &matched);
+            // We don’t store "sm" like in RE2 code,
+            // because Hyperscan doesn't provide captures by default.
+            valueHits[idx] = matched;
+        }
+        return;
+    }
+
+    const ColumnBuffer &buffer = *setup.buffer;
+    std::fill(valueHits.begin(), valueHits.end(), 0);
+
+    if (setup.mode == ScanMode::Block) {
+        // As few hs_scan calls as the length limit allows, split at line starts
+        size_t begin = 0;
+        while (begin < lines.size()) {
+            unsigned long long first = buffer.starts[begin];
+            size_t end = lines.size();
+            if (buffer.bytes.size() - first > MAX_BLOCK_BYTES) {
+                // last line start within the limit ends the block
+                auto it = std::upper_bound(buffer.starts.begin() + begin + 1, buffer.starts.end(), first + MAX_BLOCK_BYTES);
+                end = std::max(begin + 1, (size_t)(it - buffer.starts.begin()) - 1);
+            }
+            unsigned long long stop = end < lines.size() ? buffer.starts[end] : buffer.bytes.size();
+            OffsetMatchContext ctx{buffer.starts.data(), lines.size(), first, nullptr, valueHits.data()};
+            hs_scan(db, buffer.bytes.data() + first, (unsigned int)(stop - first), 0, scratch, onOffsetMatch, &ctx);
+            begin = end;
+        }
+        return;
+    }
+
+    // Vectored: point into the buffer (line plus its '\n'), skipping
+    // prefilter rejects, no copies
+    std::vector<const char*> data;
+    std::vector<unsigned int> lengths;
+    std::vector<unsigned long long> starts;
+    std::vector<size_t> rows;
+    data.reserve(VECTOR_BATCH_LINES);
+    lengths.reserve(VECTOR_BATCH_LINES);
+    starts.reserve(VECTOR_BATCH_LINES);
+    rows.reserve(VECTOR_BATCH_LINES);
+    for (size_t begin = 0; begin < lines.size(); begin += VECTOR_BATCH_LINES) {
+        size_t end = std::min(lines.size(), begin + VECTOR_BATCH_LINES);
+        data.clear();
+        lengths.clear();
+        starts.clear();
+        rows.clear();
+        unsigned long long offset = 0;
+        for (size_t idx = begin; idx < end; ++idx) {
+            if (setup.prefilter && !mayMatch(lines[idx])) {
+                continue;
+            }
+            starts.push_back(offset);
+            rows.push_back(idx);
+            data.push_back(buffer.bytes.data() + buffer.starts[idx]);
+            lengths.push_back((unsigned int)lines[idx].size() + 1);
+            offset += lines[idx].size() + 1;
+        }
+        if (rows.empty()) {
+            continue;
+        }
+        OffsetMatchContext ctx{starts.data(), starts.size(), 0, rows.data(), valueHits.data()};
+        hs_scan_vector(db, data.data(), lengths.data(), (unsigned int)data.size(), 0, scratch, onOffsetMatch, &ctx);
+    }
+}
+
 std::pair<std::vector<double>, std::vector<double>> 
 benchmarkRegexes(hs_database_t* dbPartial,
                  hs_database_t* dbFull,
                  std::vector<std::string>& lines,
-                 int iters)
+                 int iters,
+                 const ScanSetup &setup,
+                 size_t *fullMatches = nullptr,
+                 size_t *partialMatches = nullptr)
 {
+    // With a dictionary, "lines" holds the distinct values: scan each once
+    // and expand the per-value result to rows through the codes.
+    const DictColumn *dict = setup.dict;
+    std::vector<uint8_t> valueHits(lines.size());
+    std::vector<uint8_t> rowHits(dict ? dict->numRows() : 0);
+
     // 6a. Allocate scratch for partial DB
     hs_scratch_t* scratchPartial = allocScratch(dbPartial);
     if(!scratchPartial) {
@@ -165,44 +427,39 @@ benchmarkRegexes(hs_database_t* dbPartial,
     double partialTotalSec = 0.0;
     for (int i = 0; i < iters; ++i) {
         auto start = std::chrono::high_resolution_clock::now();
-        // Scan each line
-        for (const auto &line : lines) {
-            bool matched = false;
-            hs_scan(dbPartial,
-                    line.data(),
-                    line.size(),
-                    0, // flags
-                    scratchPartial,
-                    onMatch,
-                    &matched);
-            // We don’t store "sm" like in RE2 code,
-            // because Hyperscan doesn't provide captures by default.
+        scanOnce(dbPartial, scratchPartial, lines, setup, valueHits);
+        if (dict) {
+            dict->expand(valueHits, rowHits);
         }
         auto end = std::chrono::high_resolution_clock::now();
         partialTotalSec += std::chrono::duration<double>(end - start).count();
     }
     double partialAvgSec = partialTotalSec / iters;
 
+    // Matching rows of the last partial pass
+    const auto &hits = dict ? rowHits : valueHits;
+    if (partialMatches) {
+        *partialMatches = std::count(hits.begin(), hits.end(), 1);
+    }
+
     // Next measure time for anchored (full) patterns:
     double fullTotalSec = 0.0;
     for (int i = 0; i < iters; ++i) {
         auto start = std::chrono::high_resolution_clock::now();
-        // Scan each line
-        for (const auto &line : lines) {
-            bool matched = false;
-            hs_scan(dbFull,
-                    line.data(),
-                    line.size(),
-                    0,
-                    scratchFull,
-                    onMatch,
-                    &matched);
+        scanOnce(dbFull, scratchFull, lines, setup, valueHits);
+        if (dict) {
+            dict->expand(valueHits, rowHits);
         }
         auto end = std::chrono::high_resolution_clock::now();
         fullTotalSec += std::chrono::duration<double>(end - start).count();
     }
     double fullAvgSec = fullTotalSec / iters;
 
+    // Matching rows of the last full pass
+    if (fullMatches) {
+        *fullMatches = std::count(hits.begin(), hits.end(), 1);
+    }
+
     // Clean up scratch
     hs_free_scratch(scratchPartial);
     hs_free_scratch(scratchFull);
@@ -222,7 +479,44 @@ benchmarkRegexes(hs_database_t* dbPartial,
  *****************************************************************************/
 int main(int argc, char** argv) {
     if(argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " DEVICE" << std::endl; 
+        std::cerr << "Usage: " << argv[0]
+                  << " DEVICE [--mode line|vectored|block] [--dict] [--prefilter]"
+                  << " [--cache-dir DIR | --no-cache]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    bool useDict = false;
+    bool usePrefilter = false;
+    DatabaseCache cache{"hs-cache"};
+    ScanMode mode = ScanMode::Line;
+    for (int argIdx = 2; argIdx < argc; ++argIdx) {
+        if (std::strcmp(argv[argIdx], "--mode") == 0 && argIdx + 1 < argc) {
+            std::string name = argv[++argIdx];
+            if (name == "line") {
+                mode = ScanMode::Line;
+            } else if (name == "vectored") {
+                mode = ScanMode::Vectored;
+            } else if (name == "block") {
+                mode = ScanMode::Block;
+            } else {
+                std::cerr << "Unknown mode: " << name << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (std::strcmp(argv[argIdx], "--cache-dir") == 0 && argIdx + 1 < argc) {
+            cache.dir = argv[++argIdx];
+        } else if (std::strcmp(argv[argIdx], "--no-cache") == 0) {
+            cache.dir.clear();
+        } else if (std::strcmp(argv[argIdx], "--dict") == 0) {
+            useDict = true;
+        } else if (std::strcmp(argv[argIdx], "--prefilter") == 0) {
+            usePrefilter = true;
+        } else {
+            std::cerr << "Unknown option: " << argv[argIdx] << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    if (usePrefilter && mode == ScanMode::Block) {
+        // a block covers all lines, there is nothing to skip
+        std::cerr << "--prefilter needs --mode line or vectored" << std::endl;
         return EXIT_FAILURE;
     }
 
@@ -233,6 +527,22 @@ int main(int argc, char** argv) {
         return EXIT_FAILURE;
     }
 
+    // 1b) Optionally scan distinct values only: the description column
+    //     repeats heavily, so most of the regex work is skipped
+    DictColumn dict;
+    double dedupRatio = 1.0;
+    if (useDict) {
+        dict = DictColumn::encode(lines);
+        lines = dict.values();
+        dedupRatio = dict.dedupRatio();
+    }
+
+    // 1c) Contiguous newline-separated copy for the whole-buffer modes
+    ColumnBuffer buffer;
+    if (mode != ScanMode::Line) {
+        buffer = buildColumnBuffer(lines);
+    }
+
     // 2) Prepare partial (unanchored) and full (anchored) patterns:
     std::vector<std::string> partialPatterns = {
         "At (.+)Exit (.+)",
@@ -240,53 +550,111 @@ int main(int argc, char** argv) {
         "on (.+) at (.+)",
         "Ramp to (.+)"
     };
+    std::vector<std::string> fullPatterns;
+    fullPatterns.reserve(partialPatterns.size());
+    for (const auto &p : partialPatterns) {
+        fullPatterns.push_back(makeAnchored(p));
+        // e.g. "At (.+)Exit (.+)" -> "^At (.+)Exit (.+)$"
+    }
 
-    // 3) prepare for output before per-regex results
-    std::string header = "query_id (string),device (str),full (mib/s),partial (mib/s)";
-    std::cout << header << std::endl;
-    std::string row;
-    double full_tput, part_tput;
-    int pattern_idx = 0;
-    for (auto pattern : partialPatterns) { // do 1-1 since hs processes one-db-at-a-time
-        std::vector<std::string> fullPatterns;
-        fullPatterns.reserve(partialPatterns.size());
-        for (const auto &p : partialPatterns) {
-            fullPatterns.push_back(makeAnchored(p)); 
-            // e.g. "At (.+)Exit (.+)" -> "^At (.+)Exit (.+)$"
-        }
+    // 2b) Literal prefilter
+    std::unique_ptr<LiteralPrefilter> prefilter;
+    if (usePrefilter) {
+        prefilter = std::make_unique<LiteralPrefilter>(partialPatterns);
+    }
 
-        // 3) Compile each set into a separate database
-        hs_database_t *dbPartial = compileDatabase(partialPatterns);
-        if(!dbPartial) {
+    // 3) Compile (or load) the databases once, outside the measurements:
+    //    one database per query plus one multi-pattern database with all of them.
+    //    The whole-buffer modes anchor at line boundaries (see 5b), a line
+    //    scan stops at its first match and does not raise the others.
+    unsigned int patternFlags = mode == ScanMode::Line ? HS_FLAG_SINGLEMATCH : HS_FLAG_MULTILINE;
+    unsigned int hsMode = mode == ScanMode::Vectored ? HS_MODE_VECTORED : HS_MODE_BLOCK;
+    auto setupStart = std::chrono::high_resolution_clock::now();
+    std::vector<hs_database_t*> dbsPartial;
+    std::vector<hs_database_t*> dbsFull;
+    auto freeDatabases = [&]() {
+        for (auto *db : dbsPartial) hs_free_database(db);
+        for (auto *db : dbsFull) hs_free_database(db);
+    };
+    for (size_t i = 0; i <= partialPatterns.size(); ++i) {
+        bool multi = i == partialPatterns.size();
+        std::vector<std::string> partialSet = multi ? partialPatterns : std::vector<std::string>{partialPatterns[i]};
+        std::vector<std::string> fullSet = multi ? fullPatterns : std::vector<std::string>{fullPatterns[i]};
+        hs_database_t *dbPartial = loadOrCompileDatabase(partialSet, patternFlags, hsMode, cache);
+        hs_database_t *dbFull = dbPartial ? loadOrCompileDatabase(fullSet, patternFlags, hsMode, cache) : nullptr;
+        if (!dbPartial || !dbFull) {
+            if (dbPartial) hs_free_database(dbPartial);
+            freeDatabases();
             return EXIT_FAILURE;
         }
-        hs_database_t *dbFull = compileDatabase(fullPatterns);
-        if(!dbFull) {
-            hs_free_database(dbPartial);
-            return EXIT_FAILURE;
+        dbsPartial.push_back(dbPartial);
+        dbsFull.push_back(dbFull);
+    }
+    auto setupEnd = std::chrono::high_resolution_clock::now();
+    std::cerr << "Database setup: "
+              << std::chrono::duration<double, std::milli>(setupEnd - setupStart).count() << " ms ("
+              << cache.loaded << " loaded, " << cache.compiled << " compiled)" << std::endl;
+
+    // 4) prepare for output before per-regex results
+    std::string header = "query_id (string),device (str),full (mib/s),partial (mib/s),dedup_ratio (x),"
+                         "prefilter_pass (frac),prefilter_saved (s),matches (rows),partial_matches (rows)";
+    std::cout << header << std::endl;
+    double full_tput, part_tput;
+    int iters = 3; // adapt as needed
+    for (size_t pattern_idx = 0; pattern_idx < dbsFull.size(); ++pattern_idx) {
+        // the last database holds all patterns, a line counts if any of them matches
+        bool multi = pattern_idx == partialPatterns.size();
+        ScanSetup setup;
+        setup.mode = mode;
+        setup.buffer = &buffer;
+        setup.dict = useDict ? &dict : nullptr;
+        setup.prefilter = prefilter.get();
+        setup.prefilterQuery = multi ? -1 : (int)pattern_idx;
+
+        // 4b) selectivity is the fraction of lines that still get scanned
+        double prefilterPass = 1.0;
+        if (prefilter) {
+            size_t passed = 0;
+            for (const auto &line : lines) {
+                passed += multi ? prefilter->mayMatchAny(line) : prefilter->mayMatch(pattern_idx, line);
+            }
+            prefilterPass = (double)passed / lines.size();
         }
 
-        // 4) Benchmark scanning times
-        int iters = 3; // adapt as needed
-        auto [full_match_durations, partial_match_durations] = benchmarkRegexes(dbPartial, dbFull, lines, iters);
+        // 5) Benchmark scanning times
+        size_t matches = 0;
+        size_t partialMatches = 0;
+        auto [full_match_durations, partial_match_durations] = benchmarkRegexes(dbsPartial[pattern_idx],
+                                                                                 dbsFull[pattern_idx], lines, iters,
+                                                                                 setup, &matches, &partialMatches);
+
+        // 5b) with the prefilter, also time the unfiltered scan for the savings
+        double prefilterSaved = 0.0;
+        if (prefilter) {
+            ScanSetup unfiltered = setup;
+            unfiltered.prefilter = nullptr;
+            auto [full_base, partial_base] = benchmarkRegexes(dbsPartial[pattern_idx], dbsFull[pattern_idx],
+                                                              lines, iters, unfiltered);
+            prefilterSaved = full_base[0] - full_match_durations[0];
+        }
 
-        // 5) calculate throughput (size / duration)
-        std::string row = "q";
-        row.append(std::to_string(pattern_idx + 1)).append(",").append(argv[1]).append(",");
+        // 6) calculate throughput (size / duration)
+        std::string row = multi ? "all" : "q" + std::to_string(pattern_idx + 1);
+        row.append(",").append(argv[1]).append(",");
         full_tput = size / full_match_durations[0] / 1048576.0;
         part_tput = size / partial_match_durations[0] / 1048576.0;
         row.append(std::to_string(full_tput)).append(",");
-        row.append(std::to_string(part_tput));
+        row.append(std::to_string(part_tput)).append(",");
+        row.append(std::to_string(dedupRatio)).append(",");
+        row.append(std::to_string(prefilterPass)).append(",");
+        row.append(std::to_string(prefilterSaved)).append(",");
+        row.append(std::to_string(matches)).append(",");
+        row.append(std::to_string(partialMatches));
         std::cout << row << std::endl;
-
-        pattern_idx++;
-
-        // 6) Cleanup
-        hs_free_database(dbPartial);
-        hs_free_database(dbFull);
     }
 
-    
+    // 7) Cleanup
+    freeDatabases();
 
     return EXIT_SUCCESS;
 }